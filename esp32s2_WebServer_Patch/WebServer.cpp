@@ -1,6 +1,6 @@
 /*
   WebServer.cpp - Dead simple web-server.
-  Supports only one simultaneous client, knows how to handle GET and POST.
+  Supports up to HTTP_MAX_CLIENTS simultaneous clients, knows how to handle GET and POST.
 
   Copyright (c) 2014 Ivan Grokhotkov. All rights reserved.
 
@@ -37,6 +37,7 @@ static const char AUTHORIZATION_HEADER[] = "Authorization";
 static const char qop_auth[] = "qop=\"auth\"";
 static const char WWW_Authenticate[] = "WWW-Authenticate";
 static const char Content_Length[] = "Content-Length";
+static const char Connection_Header[] = "Connection";
 
 
 WebServer::WebServer(IPAddress addr, int port)
@@ -44,9 +45,9 @@ WebServer::WebServer(IPAddress addr, int port)
   , _server(addr, port)
   , _currentMethod(HTTP_ANY)
   , _currentVersion(0)
-  , _currentStatus(HC_NONE)
-  , _statusChange(0)
   , _nullDelay(true)
+  , _keepAlive(false)
+  , _keepAliveCount(0)
   , _currentHandler(nullptr)
   , _firstHandler(nullptr)
   , _lastHandler(nullptr)
@@ -57,6 +58,8 @@ WebServer::WebServer(IPAddress addr, int port)
   , _headerKeysCount(0)
   , _currentHeaders(nullptr)
   , _contentLength(0)
+  , _headerSet(nullptr)
+  , _txLen(0)
   , _chunked(false)
 {
 }
@@ -66,9 +69,9 @@ WebServer::WebServer(int port)
   , _server(port)
   , _currentMethod(HTTP_ANY)
   , _currentVersion(0)
-  , _currentStatus(HC_NONE)
-  , _statusChange(0)
   , _nullDelay(true)
+  , _keepAlive(false)
+  , _keepAliveCount(0)
   , _currentHandler(nullptr)
   , _firstHandler(nullptr)
   , _lastHandler(nullptr)
@@ -79,6 +82,8 @@ WebServer::WebServer(int port)
   , _headerKeysCount(0)
   , _currentHeaders(nullptr)
   , _contentLength(0)
+  , _headerSet(nullptr)
+  , _txLen(0)
   , _chunked(false)
 {
 }
@@ -365,99 +370,274 @@ void WebServer::serveStatic(const char* uri, FS& fs, const char* path, const cha
 
 void WebServer::handleClient()
 {
-  if (_currentStatus == HC_NONE)
+  _acceptClients();
+
+  bool active   = false;
+  bool callYield = false;
+
+  // Each slot gets at most one request per call, so a slow or stalled client can't hold up the others
+  for (int i = 0; i < HTTP_MAX_CLIENTS; i++)
+  {
+    ClientSlot& slot = _slots[i];
+
+    if (slot.status == HC_NONE)
+      continue;
+
+    active = true;
+
+    if (!_handleSlot(slot))
+    {
+      callYield = true;
+    }
+  }
+
+  if (!active)
   {
+    if (_nullDelay)
+    {
+      delay(1);
+    }
+
+    return;
+  }
+
+  if (callYield)
+  {
+    yield();
+  }
+}
+
+// Move waiting connections into free slots
+void WebServer::_acceptClients()
+{
+  while (_server.hasClient())
+  {
+    ClientSlot* slot = _freeSlot();
+
+    if (!slot)
+    {
+      // Stays in the backlog until a slot frees up
+      return;
+    }
+
     WiFiClient client = _server.available();
 
     if (!client)
     {
-      if (_nullDelay)
+      return;
+    }
+
+    log_v("New client");
+
+    slot->client          = client;
+    slot->status          = HC_WAIT_READ;
+    slot->statusChange    = millis();
+    slot->keepAliveCount  = 0;
+  }
+}
+
+// With all slots busy, the connection that has sent nothing for the longest time gives way to a new client:
+// a persistent one waiting for its next request, or a new one that has not started its request
+WebServer::ClientSlot* WebServer::_freeSlot()
+{
+  ClientSlot* idle = nullptr;
+
+  for (int i = 0; i < HTTP_MAX_CLIENTS; i++)
+  {
+    ClientSlot& slot = _slots[i];
+
+    if (slot.status == HC_NONE)
+      return &slot;
+
+    if ( !slot.headerLen && !slot.client.available() &&
+         ( !idle || (millis() - slot.statusChange > millis() - idle->statusChange) ) )
+    {
+      idle = &slot;
+    }
+  }
+
+  if (idle)
+  {
+    _releaseSlot(*idle);
+  }
+
+  return idle;
+}
+
+// Adds what has arrived of the request line and headers to the slot's header, without waiting.
+// True once the empty line ending them is in. The body, if any, is left on the connection
+bool WebServer::_readHeader(ClientSlot& slot)
+{
+  while ( (slot.headerLen < HTTP_MAX_HEADER_SIZE) && slot.client.available() )
+  {
+    if (!slot.header)
+    {
+      slot.header.reset(new (std::nothrow) char[HTTP_MAX_HEADER_SIZE]);
+
+      if (!slot.header)
       {
-        delay(1);
+        return false;
       }
+    }
 
-      return;
+    int c = slot.client.read();
+
+    if (c < 0)
+    {
+      return false;
     }
 
-    log_v("New client");
+    slot.header[slot.headerLen++] = (char) c;
 
-    _currentClient = client;
-    _currentStatus = HC_WAIT_READ;
-    _statusChange = millis();
+    if ( (c == '\n') && (slot.headerLen >= 4) && !memcmp(&slot.header[slot.headerLen - 4], "\r\n\r\n", 4) )
+    {
+      return true;
+    }
   }
 
-  bool keepCurrentClient = false;
-  bool callYield = false;
+  return false;
+}
 
-  if (_currentClient.connected())
+// Serves one request once the slot has its whole header, else checks its deadline. Returns false if still waiting
+bool WebServer::_handleSlot(ClientSlot& slot)
+{
+  if (!slot.client.connected())
   {
-    switch (_currentStatus)
+    _releaseSlot(slot);
+
+    return true;
+  }
+
+  if (!_readHeader(slot))
+  {
+    if (slot.headerLen >= HTTP_MAX_HEADER_SIZE)
     {
-      case HC_NONE:
-        // No-op to avoid C++ compiler warning
-        break;
-
-      case HC_WAIT_READ:
-
-        // Wait for data from client to become available
-        if (_currentClient.available())
-        {
-          if (_parseRequest(_currentClient))
-          {
-            // because HTTP_MAX_SEND_WAIT is expressed in milliseconds,
-            // it must be divided by 1000
-            _currentClient.setTimeout(HTTP_MAX_SEND_WAIT / 1000);
-            _contentLength = CONTENT_LENGTH_NOT_SET;
-            _handleRequest();
-
-            // Fix for issue with Chrome based browsers: https://github.com/espressif/arduino-esp32/issues/3652
-            //           if (_currentClient.connected()) {
-            //             _currentStatus = HC_WAIT_CLOSE;
-            //             _statusChange = millis();
-            //             keepCurrentClient = true;
-            //           }
-          }
-        }
-        else     // !_currentClient.available()
-        {
-          if (millis() - _statusChange <= HTTP_MAX_DATA_WAIT)
-          {
-            keepCurrentClient = true;
-          }
-
-          callYield = true;
-        }
-
-        break;
-
-      case HC_WAIT_CLOSE:
-
-        // Wait for client to close the connection
-        if (millis() - _statusChange <= HTTP_MAX_CLOSE_WAIT)
-        {
-          keepCurrentClient = true;
-          callYield = true;
-        }
+      log_e("Request header over %d bytes", HTTP_MAX_HEADER_SIZE);
+      _releaseSlot(slot);
+
+      return true;
+    }
+
+    // Waiting for the first request, or for the next one on a persistent connection. A client sending
+    // its header byte by byte gets no more time than one sending nothing
+    unsigned long timeout = (slot.keepAliveCount && !slot.headerLen) ? HTTP_KEEPALIVE_TIMEOUT : HTTP_MAX_DATA_WAIT;
+
+    if (millis() - slot.statusChange > timeout)
+    {
+      _releaseSlot(slot);
+
+      return true;
     }
+
+    return false;
   }
 
-  if (!keepCurrentClient)
+  _currentClient  = slot.client;
+  _keepAliveCount = slot.keepAliveCount + 1;
+
+  bool keepClient = false;
+
+  SlotReader reader(slot.client, slot.header.get(), slot.headerLen);
+
+  bool parsed = _parseRequest(reader);
+
+  slot.header.reset();
+  slot.headerLen = 0;
+
+  if (parsed)
   {
-    _currentClient = WiFiClient();
-    _currentStatus = HC_NONE;
-    _currentUpload.reset();
+    // because HTTP_MAX_SEND_WAIT is expressed in milliseconds,
+    // it must be divided by 1000
+    _currentClient.setTimeout(HTTP_MAX_SEND_WAIT / 1000);
+    _contentLength = CONTENT_LENGTH_NOT_SET;
+    _keepAlive = false;
+    _handleRequest();
+
+    // Fix for issue with Chrome based browsers: https://github.com/espressif/arduino-esp32/issues/3652
+    // Don't wait for the client to close. Either close now or, if the response was sent as
+    // persistent by _prepareHeader(), wait for the next request on the same connection
+    keepClient = _keepAlive && _currentClient.connected();
   }
 
-  if (callYield)
+  _currentClient = WiFiClient();
+
+  if (keepClient)
   {
-    yield();
+    slot.statusChange   = millis();
+    slot.keepAliveCount = _keepAliveCount;
+  }
+  else
+  {
+    _releaseSlot(slot);
+  }
+
+  return true;
+}
+
+void WebServer::_releaseSlot(ClientSlot& slot)
+{
+  slot.client = WiFiClient();
+  slot.status = HC_NONE;
+  slot.header.reset();
+  slot.headerLen = 0;
+  _currentUpload.reset();
+}
+
+int WebServer::SlotReader::available()
+{
+  return (_len - _pos) + WiFiClient::available();
+}
+
+int WebServer::SlotReader::read()
+{
+  if (_pos < _len)
+  {
+    return (uint8_t) _header[_pos++];
+  }
+
+  return WiFiClient::read();
+}
+
+int WebServer::SlotReader::read(uint8_t* buf, size_t size)
+{
+  size_t count = std::min(size, _len - _pos);
+
+  memcpy(buf, _header + _pos, count);
+  _pos += count;
+
+  if (count == size)
+  {
+    return count;
+  }
+
+  int more = WiFiClient::read(buf + count, size - count);
+
+  return (more > 0) ? count + more : count;
+}
+
+int WebServer::SlotReader::peek()
+{
+  if (_pos < _len)
+  {
+    return (uint8_t) _header[_pos];
   }
+
+  return WiFiClient::peek();
+}
+
+uint8_t WebServer::SlotReader::connected()
+{
+  return (_pos < _len) || WiFiClient::connected();
 }
 
 void WebServer::close()
 {
   _server.close();
-  _currentStatus = HC_NONE;
+
+  for (int i = 0; i < HTTP_MAX_CLIENTS; i++)
+  {
+    _releaseSlot(_slots[i]);
+  }
 
   if (!_headerKeysCount)
     collectHeaders(0, 0);
@@ -470,21 +650,33 @@ void WebServer::stop()
 
 void WebServer::sendHeader(const String& name, const String& value, bool first)
 {
-  String headerLine = name;
-  headerLine += F(": ");
-  headerLine += value;
-  headerLine += "\r\n";
-
   if (first)
   {
+    String headerLine = name;
+    headerLine += F(": ");
+    headerLine += value;
+    headerLine += "\r\n";
+
     _responseHeaders = headerLine + _responseHeaders;
   }
   else
   {
-    _responseHeaders += headerLine;
+    // Appended in place, without a temporary line
+    _responseHeaders.reserve(_responseHeaders.length() + name.length() + value.length() + 4);
+    _responseHeaders += name;
+    _responseHeaders += F(": ");
+    _responseHeaders += value;
+    _responseHeaders += "\r\n";
   }
 }
 
+// headers is a PROGMEM block of complete "Name: value\r\n" lines, copied as is into the next response header.
+// Only one set per response, the last one wins
+void WebServer::sendHeaders_P(PGM_P headers)
+{
+  _headerSet = headers;
+}
+
 void WebServer::setContentLength(const size_t contentLength)
 {
   _contentLength = contentLength;
@@ -505,60 +697,180 @@ void WebServer::enableCrossOrigin(boolean value)
   enableCORS(value);
 }
 
-void WebServer::_prepareHeader(String& response, int code, const char* content_type, size_t contentLength)
+// Status line and headers go straight into the send buffer, no String is built
+void WebServer::_prepareHeader(int code, const char* content_type, size_t contentLength)
 {
-  response = String(F("HTTP/1.")) + String(_currentVersion) + ' ';
-  response += String(code);
-  response += ' ';
-  response += _responseCodeToString(code);
-  response += "\r\n";
+  char line[64];
+  int  len;
+
+  len = snprintf(line, sizeof(line), "HTTP/1.%d %d ", _currentVersion, code);
+  _txWrite(line, len);
+  _txWrite_P(_responseCodeToString(code));
+  _txWrite("\r\n", 2);
 
   using namespace mime;
 
   if (!content_type)
     content_type = mimeTable[html].mimeType;
 
-  sendHeader(String(F("Content-Type")), String(FPSTR(content_type)), true);
+  _txWrite_P(PSTR("Content-Type: "));
+  _txWrite_P(content_type);
+  _txWrite("\r\n", 2);
+
+  if (_responseHeaders.length())
+  {
+    _txWrite(_responseHeaders.c_str(), _responseHeaders.length());
+    _responseHeaders = "";
+  }
+
+  if (_headerSet)
+  {
+    _txWrite_P(_headerSet);
+    _headerSet = nullptr;
+  }
 
   if (_contentLength == CONTENT_LENGTH_NOT_SET)
   {
-    sendHeader(String(FPSTR(Content_Length)), String(contentLength));
+    len = snprintf(line, sizeof(line), "%s: %u\r\n", Content_Length, (unsigned) contentLength);
+    _txWrite(line, len);
   }
   else if (_contentLength != CONTENT_LENGTH_UNKNOWN)
   {
-    sendHeader(String(FPSTR(Content_Length)), String(_contentLength));
+    len = snprintf(line, sizeof(line), "%s: %u\r\n", Content_Length, (unsigned) _contentLength);
+    _txWrite(line, len);
   }
   else if (_contentLength == CONTENT_LENGTH_UNKNOWN && _currentVersion)   //HTTP/1.1 or above client
   {
     //let's do chunked
     _chunked = true;
-    sendHeader(String(F("Accept-Ranges")), String(F("none")));
-    sendHeader(String(F("Transfer-Encoding")), String(F("chunked")));
+    _txWrite_P(PSTR("Accept-Ranges: none\r\nTransfer-Encoding: chunked\r\n"));
   }
 
   if (_corsEnabled)
   {
-    sendHeader(String(FPSTR("Access-Control-Allow-Origin")), String("*"));
+    _txWrite_P(PSTR("Access-Control-Allow-Origin: *\r\n"));
+  }
+
+  // A persistent connection needs the end of the body to be known from Content-Length or chunked encoding
+  bool bodyDelimited = _chunked || (_contentLength != CONTENT_LENGTH_UNKNOWN);
+
+  _keepAlive = bodyDelimited && (_keepAliveCount < HTTP_KEEPALIVE_MAX) && _clientWantsKeepAlive();
+
+  if (_keepAlive)
+  {
+    len = snprintf(line, sizeof(line), "%s: keep-alive\r\nKeep-Alive: timeout=%d, max=%d\r\n", Connection_Header,
+                   HTTP_KEEPALIVE_TIMEOUT / 1000, HTTP_KEEPALIVE_MAX - _keepAliveCount);
+    _txWrite(line, len);
+  }
+  else
+  {
+    len = snprintf(line, sizeof(line), "%s: close\r\n", Connection_Header);
+    _txWrite(line, len);
+  }
+
+  _txWrite("\r\n", 2);
+}
+
+// All response bytes pass through _txBuf, so that status line, headers and a small body leave in one write.
+// Payloads at least a buffer long go out directly once the buffer is empty
+void WebServer::_txWrite(const char* data, size_t len)
+{
+  while (len)
+  {
+    if ( (_txLen == 0) && (len >= sizeof(_txBuf)) )
+    {
+      _currentClientWrite(data, len);
+
+      return;
+    }
+
+    size_t room = sizeof(_txBuf) - _txLen;
+    size_t n    = (len < room) ? len : room;
+
+    memcpy(&_txBuf[_txLen], data, n);
+    _txLen += n;
+    data   += n;
+    len    -= n;
+
+    if (_txLen == sizeof(_txBuf))
+    {
+      _txFlush();
+    }
+  }
+}
+
+void WebServer::_txWrite_P(PGM_P data, size_t len)
+{
+  while (len)
+  {
+    if ( (_txLen == 0) && (len >= sizeof(_txBuf)) )
+    {
+      _currentClientWrite_P(data, len);
+
+      return;
+    }
+
+    size_t room = sizeof(_txBuf) - _txLen;
+    size_t n    = (len < room) ? len : room;
+
+    memcpy_P(&_txBuf[_txLen], data, n);
+    _txLen += n;
+    data   += n;
+    len    -= n;
+
+    if (_txLen == sizeof(_txBuf))
+    {
+      _txFlush();
+    }
   }
+}
 
-  sendHeader(String(F("Connection")), String(F("close")));
+void WebServer::_txWrite_P(PGM_P data)
+{
+  _txWrite_P(data, strlen_P(data));
+}
 
-  response += _responseHeaders;
-  response += "\r\n";
-  _responseHeaders = "";
+void WebServer::_txFlush()
+{
+  if (_txLen)
+  {
+    _currentClientWrite(_txBuf, _txLen);
+    _txLen = 0;
+  }
+}
+
+// HTTP/1.1 connections are persistent unless the client asks to close, HTTP/1.0 ones only on request
+bool WebServer::_clientWantsKeepAlive()
+{
+  String connection = header(FPSTR(Connection_Header));
+
+  connection.toLowerCase();
+
+  if (_currentVersion)
+  {
+    return (connection.indexOf(F("close")) < 0);
+  }
+
+  return (connection.indexOf(F("keep-alive")) >= 0);
 }
 
 void WebServer::send(int code, const char* content_type, const String& content)
 {
-  String header;
   // Can we assume the following?
   //if(code == 200 && content.length() == 0 && _contentLength == CONTENT_LENGTH_NOT_SET)
   //  _contentLength = CONTENT_LENGTH_UNKNOWN;
-  _prepareHeader(header, code, content_type, content.length());
-  _currentClientWrite(header.c_str(), header.length());
+  _prepareHeader(code, content_type, content.length());
 
   if (content.length())
+  {
     sendContent(content);
+  }
+
+  // A chunked body continues with sendContent(), the rest is sent by _finalizeResponse()
+  if (!_chunked)
+  {
+    _txFlush();
+  }
 }
 
 void WebServer::send_P(int code, PGM_P content_type, PGM_P content)
@@ -570,22 +882,25 @@ void WebServer::send_P(int code, PGM_P content_type, PGM_P content)
     contentLength = strlen_P(content);
   }
 
-  String header;
-  char type[64];
-  memccpy_P((void*)type, (PGM_VOID_P)content_type, 0, sizeof(type));
-  _prepareHeader(header, code, (const char* )type, contentLength);
-  _currentClientWrite(header.c_str(), header.length());
-  sendContent_P(content);
+  send_P(code, content_type, content, contentLength);
 }
 
 void WebServer::send_P(int code, PGM_P content_type, PGM_P content, size_t contentLength)
 {
-  String header;
   char type[64];
   memccpy_P((void*)type, (PGM_VOID_P)content_type, 0, sizeof(type));
-  _prepareHeader(header, code, (const char* )type, contentLength);
-  sendContent(header);
-  sendContent_P(content, contentLength);
+  _prepareHeader(code, (const char* )type, contentLength);
+
+  if (contentLength)
+  {
+    sendContent_P(content, contentLength);
+  }
+
+  // A chunked body continues with sendContent(), the rest is sent by _finalizeResponse()
+  if (!_chunked)
+  {
+    _txFlush();
+  }
 }
 
 void WebServer::send(int code, char* content_type, const String& content)
@@ -603,27 +918,22 @@ void WebServer::sendContent(const String& content)
   sendContent(content.c_str(), content.length());
 }
 
+// Size line, payload and trailer of consecutive chunks are packed into the send buffer, which goes out
+// when full and at the end of the response in _finalizeResponse()
 void WebServer::sendContent(const char* content, size_t contentLength)
 {
-  const char * footer = "\r\n";
-
   if (_chunked)
   {
-    char * chunkSize = (char *)malloc(11);
+    char chunkSize[12];
 
-    if (chunkSize)
-    {
-      sprintf(chunkSize, "%x%s", contentLength, footer);
-      _currentClientWrite(chunkSize, strlen(chunkSize));
-      free(chunkSize);
-    }
+    _txWrite(chunkSize, snprintf(chunkSize, sizeof(chunkSize), "%x\r\n", (unsigned) contentLength));
   }
 
-  _currentClientWrite(content, contentLength);
+  _txWrite(content, contentLength);
 
   if (_chunked)
   {
-    _currentClient.write(footer, 2);
+    _txWrite("\r\n", 2);
 
     if (contentLength == 0)
     {
@@ -639,25 +949,18 @@ void WebServer::sendContent_P(PGM_P content)
 
 void WebServer::sendContent_P(PGM_P content, size_t size)
 {
-  const char * footer = "\r\n";
-
   if (_chunked)
   {
-    char * chunkSize = (char *)malloc(11);
+    char chunkSize[12];
 
-    if (chunkSize)
-    {
-      sprintf(chunkSize, "%x%s", size, footer);
-      _currentClientWrite(chunkSize, strlen(chunkSize));
-      free(chunkSize);
-    }
+    _txWrite(chunkSize, snprintf(chunkSize, sizeof(chunkSize), "%x\r\n", (unsigned) size));
   }
 
-  _currentClientWrite_P(content, size);
+  _txWrite_P(content, size);
 
   if (_chunked)
   {
-    _currentClient.write(footer, 2);
+    _txWrite("\r\n", 2);
 
     if (size == 0)
     {
@@ -707,20 +1010,23 @@ String WebServer::arg(String name)
   return "";
 }
 
-String WebServer::arg(int i)
+// KH, by reference as ESP8266WebServer does, not to copy each arg
+static const String emptyArg;
+
+const String& WebServer::arg(int i)
 {
   if (i < _currentArgCount)
     return _currentArgs[i].value;
 
-  return "";
+  return emptyArg;
 }
 
-String WebServer::argName(int i)
+const String& WebServer::argName(int i)
 {
   if (i < _currentArgCount)
     return _currentArgs[i].key;
 
-  return "";
+  return emptyArg;
 }
 
 int WebServer::args()
@@ -759,17 +1065,19 @@ String WebServer::header(String name)
 
 void WebServer::collectHeaders(const char* headerKeys[], const size_t headerKeysCount)
 {
-  _headerKeysCount = headerKeysCount + 1;
+  // Authorization and Connection are always collected
+  _headerKeysCount = headerKeysCount + 2;
 
   if (_currentHeaders)
     delete[]_currentHeaders;
 
   _currentHeaders = new RequestArgument[_headerKeysCount];
   _currentHeaders[0].key = FPSTR(AUTHORIZATION_HEADER);
+  _currentHeaders[1].key = FPSTR(Connection_Header);
 
-  for (int i = 1; i < _headerKeysCount; i++)
+  for (int i = 2; i < _headerKeysCount; i++)
   {
-    _currentHeaders[i].key = headerKeys[i - 1];
+    _currentHeaders[i].key = headerKeys[i - 2];
   }
 }
 
@@ -866,133 +1174,135 @@ void WebServer::_finalizeResponse()
   {
     sendContent("");
   }
+
+  _txFlush();
 }
 
-String WebServer::_responseCodeToString(int code)
+const char* WebServer::_responseCodeToString(int code)
 {
   switch (code)
   {
     case 100:
-      return F("Continue");
+      return "Continue";
 
     case 101:
-      return F("Switching Protocols");
+      return "Switching Protocols";
 
     case 200:
-      return F("OK");
+      return "OK";
 
     case 201:
-      return F("Created");
+      return "Created";
 
     case 202:
-      return F("Accepted");
+      return "Accepted";
 
     case 203:
-      return F("Non-Authoritative Information");
+      return "Non-Authoritative Information";
 
     case 204:
-      return F("No Content");
+      return "No Content";
 
     case 205:
-      return F("Reset Content");
+      return "Reset Content";
 
     case 206:
-      return F("Partial Content");
+      return "Partial Content";
 
     case 300:
-      return F("Multiple Choices");
+      return "Multiple Choices";
 
     case 301:
-      return F("Moved Permanently");
+      return "Moved Permanently";
 
     case 302:
-      return F("Found");
+      return "Found";
 
     case 303:
-      return F("See Other");
+      return "See Other";
 
     case 304:
-      return F("Not Modified");
+      return "Not Modified";
 
     case 305:
-      return F("Use Proxy");
+      return "Use Proxy";
 
     case 307:
-      return F("Temporary Redirect");
+      return "Temporary Redirect";
 
     case 400:
-      return F("Bad Request");
+      return "Bad Request";
 
     case 401:
-      return F("Unauthorized");
+      return "Unauthorized";
 
     case 402:
-      return F("Payment Required");
+      return "Payment Required";
 
     case 403:
-      return F("Forbidden");
+      return "Forbidden";
 
     case 404:
-      return F("Not Found");
+      return "Not Found";
 
     case 405:
-      return F("Method Not Allowed");
+      return "Method Not Allowed";
 
     case 406:
-      return F("Not Acceptable");
+      return "Not Acceptable";
 
     case 407:
-      return F("Proxy Authentication Required");
+      return "Proxy Authentication Required";
 
     case 408:
-      return F("Request Time-out");
+      return "Request Time-out";
 
     case 409:
-      return F("Conflict");
+      return "Conflict";
 
     case 410:
-      return F("Gone");
+      return "Gone";
 
     case 411:
-      return F("Length Required");
+      return "Length Required";
 
     case 412:
-      return F("Precondition Failed");
+      return "Precondition Failed";
 
     case 413:
-      return F("Request Entity Too Large");
+      return "Request Entity Too Large";
 
     case 414:
-      return F("Request-URI Too Large");
+      return "Request-URI Too Large";
 
     case 415:
-      return F("Unsupported Media Type");
+      return "Unsupported Media Type";
 
     case 416:
-      return F("Requested range not satisfiable");
+      return "Requested range not satisfiable";
 
     case 417:
-      return F("Expectation Failed");
+      return "Expectation Failed";
 
     case 500:
-      return F("Internal Server Error");
+      return "Internal Server Error";
 
     case 501:
-      return F("Not Implemented");
+      return "Not Implemented";
 
     case 502:
-      return F("Bad Gateway");
+      return "Bad Gateway";
 
     case 503:
-      return F("Service Unavailable");
+      return "Service Unavailable";
 
     case 504:
-      return F("Gateway Time-out");
+      return "Gateway Time-out";
 
     case 505:
-      return F("HTTP Version not supported");
+      return "HTTP Version not supported";
 
     default:
-      return F("");
+      return "";
   }
 }
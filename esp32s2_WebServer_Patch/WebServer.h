@@ -1,6 +1,6 @@
 /*
   WebServer.h - Dead simple web-server.
-  Supports only one simultaneous client, knows how to handle GET and POST.
+  Supports up to HTTP_MAX_CLIENTS simultaneous clients, knows how to handle GET and POST.
 
   Copyright (c) 2014 Ivan Grokhotkov. All rights reserved.
 
@@ -47,6 +47,31 @@ enum HTTPAuthMethod { BASIC_AUTH, DIGEST_AUTH };
 #define HTTP_MAX_SEND_WAIT 5000 //ms to wait for data chunk to be ACKed
 #define HTTP_MAX_CLOSE_WAIT 2000 //ms to wait for the client to close the connection
 
+// KH, HTTP persistent connections
+#ifndef HTTP_KEEPALIVE_TIMEOUT
+  #define HTTP_KEEPALIVE_TIMEOUT 2000 //ms an idle persistent connection is kept open for the next request
+#endif
+
+#ifndef HTTP_MAX_CLIENTS
+  #define HTTP_MAX_CLIENTS 4 //connections served concurrently, each in its own slot
+#endif
+
+#ifndef HTTP_KEEPALIVE_MAX
+  #define HTTP_KEEPALIVE_MAX 32 //max requests served on one persistent connection
+#endif
+
+#ifndef HTTP_MAX_HEADER_SIZE
+  #define HTTP_MAX_HEADER_SIZE 1536 //max bytes of request line and headers, buffered by the slot until complete
+#endif
+
+// KH, response bytes are coalesced in a buffer of one TCP MSS
+#ifndef HTTP_TX_BUF_SIZE
+  #define HTTP_TX_BUF_SIZE HTTP_DOWNLOAD_UNIT_SIZE
+#endif
+
+// sendHeaders_P() is available
+#define WEBSERVER_HAS_HEADER_SETS     true
+
 #define CONTENT_LENGTH_UNKNOWN ((size_t) -1)
 #define CONTENT_LENGTH_NOT_SET ((size_t) -2)
 
@@ -107,6 +132,8 @@ class WebServer
     }
     virtual WiFiClient client()
     {
+      // Whatever the caller writes directly must come after what is already buffered
+      _txFlush();
       return _currentClient;
     }
     HTTPUpload& upload()
@@ -116,8 +143,8 @@ class WebServer
 
     String pathArg(unsigned int i); // get request path argument by number
     String arg(String name);        // get request argument value by name
-    String arg(int i);              // get request argument value by number
-    String argName(int i);          // get request argument name by number
+    const String& arg(int i);       // get request argument value by number
+    const String& argName(int i);   // get request argument name by number
     int args();                     // get arguments count
     bool hasArg(String name);       // check if argument exists
     void collectHeaders(const char* headerKeys[], const size_t headerKeysCount); // set the request headers to collect
@@ -145,6 +172,7 @@ class WebServer
 
     void setContentLength(const size_t contentLength);
     void sendHeader(const String& name, const String& value, bool first = false);
+    void sendHeaders_P(PGM_P headers);
     void sendContent(const String& content);
     void sendContent(const char* content, size_t contentLength);
     void sendContent_P(PGM_P content);
@@ -173,13 +201,55 @@ class WebServer
     void _finalizeResponse();
     bool _parseRequest(WiFiClient& client);
     void _parseArguments(String data);
-    static String _responseCodeToString(int code);
+    static const char* _responseCodeToString(int code);
     bool _parseForm(WiFiClient& client, String boundary, uint32_t len);
     bool _parseFormUploadAborted();
     void _uploadWriteByte(uint8_t b);
     int _uploadReadByte(WiFiClient& client);
-    void _prepareHeader(String& response, int code, const char* content_type, size_t contentLength);
+    void _prepareHeader(int code, const char* content_type, size_t contentLength);
+    void _txWrite(const char* data, size_t len);
+    void _txWrite_P(PGM_P data, size_t len);
+    void _txWrite_P(PGM_P data);
+    void _txFlush();
     bool _collectHeader(const char* headerName, const char* headerValue);
+    bool _clientWantsKeepAlive();
+
+    // One per connection, with its own state and deadline. The request line and headers are read into header
+    // as they arrive, the request is parsed only once they are complete
+    struct ClientSlot
+    {
+      WiFiClient              client;
+      HTTPClientStatus        status          = HC_NONE;
+      unsigned long           statusChange    = 0;
+      uint16_t                keepAliveCount  = 0;
+      std::unique_ptr<char[]> header;
+      uint16_t                headerLen       = 0;
+    };
+
+    // Gives _parseRequest() the header buffered by the slot, then what follows on the connection
+    class SlotReader : public WiFiClient
+    {
+      public:
+        SlotReader(const WiFiClient& client, const char* header, const size_t len)
+          : WiFiClient(client), _header(header), _len(len), _pos(0) {}
+
+        int     available() override;
+        int     read() override;
+        int     read(uint8_t* buf, size_t size) override;
+        int     peek() override;
+        uint8_t connected() override;
+
+      private:
+        const char* _header;
+        size_t      _len;
+        size_t      _pos;
+    };
+
+    void _acceptClients();
+    ClientSlot* _freeSlot();
+    bool _readHeader(ClientSlot& slot);
+    bool _handleSlot(ClientSlot& slot);
+    void _releaseSlot(ClientSlot& slot);
 
     void _streamFileCore(const size_t fileSize, const String & fileName, const String & contentType);
 
@@ -197,12 +267,13 @@ class WebServer
     WiFiServer        _server;
 
     WiFiClient        _currentClient;
+    ClientSlot        _slots[HTTP_MAX_CLIENTS];
     HTTPMethod        _currentMethod;
     String            _currentUri;
     uint8_t           _currentVersion;
-    HTTPClientStatus  _currentStatus;
-    unsigned long     _statusChange;
     bool              _nullDelay;
+    bool              _keepAlive;
+    uint16_t          _keepAliveCount;
 
     RequestHandler*  _currentHandler;
     RequestHandler*  _firstHandler;
@@ -221,6 +292,9 @@ class WebServer
     RequestArgument* _currentHeaders;
     size_t           _contentLength;
     String           _responseHeaders;
+    PGM_P            _headerSet;
+    char             _txBuf[HTTP_TX_BUF_SIZE];
+    size_t           _txLen;
 
     String           _hostHeader;
     bool             _chunked;
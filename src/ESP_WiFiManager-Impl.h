@@ -162,6 +162,174 @@ const char* ESP_WMParameter::getCustomHTML()
   return _customHTML;
 }
 
+//////////////////////////////////////////
+
+// One pass over the server's arguments. Only the first of duplicate names is kept, as WebServer::arg(name) does
+template<typename TServer>
+void ESP_WMArgStore::load(TServer& server)
+{
+  _used   = 0;
+  _count  = 0;
+  memset(_slots, 0, sizeof(_slots));
+
+  int numArgs = server.args();
+
+  for (int i = 0; i < numArgs; i++)
+  {
+    // References to the server's own Strings with ESP8266WebServer and the patched ESP32 WebServer, a temporary
+    // copy each with the ESP32 core's
+    const String& name  = server.argName(i);
+    const String& value = server.arg(i);
+
+    if (!add(name.c_str(), name.length(), value.c_str(), value.length()))
+    {
+      LOGWARN1(F("ArgStore full, left to the server"), name);
+    }
+  }
+
+  LOGDEBUG3(F("ArgStore: args ="), _count, F(", bytes ="), _used);
+}
+
+//////////////////////////////////////////
+
+bool ESP_WMArgStore::add(const char* name, const size_t& nameLen, const char* value, const size_t& valueLen)
+{
+  if (find(name) >= 0)
+  {
+    return true;
+  }
+
+  size_t needed = _used + nameLen + valueLen + 2;
+
+  // Limits first, not to grow the buffer for an arg left out anyway
+  if ( (_count >= WM_ARG_STORE_MAX_ARGS) || (needed > UINT16_MAX) )
+  {
+    return false;
+  }
+
+  if ( (needed > _size) && !reserve(std::max(needed, std::max(2 * _size, (size_t) WM_ARG_STORE_SIZE))) )
+  {
+    return false;
+  }
+
+  ArgEntry& entry = _entries[_count];
+
+  entry.name      = _used;
+  memcpy(&_buf[_used], name, nameLen + 1);
+  _used          += nameLen + 1;
+
+  entry.value     = _used;
+  entry.valueLen  = valueLen;
+  memcpy(&_buf[_used], value, valueLen + 1);
+  _used          += valueLen + 1;
+
+  uint32_t slot = wmFnv1a(name, nameLen) & (WM_ARG_STORE_SLOTS - 1);
+
+  while (_slots[slot])
+  {
+    slot = (slot + 1) & (WM_ARG_STORE_SLOTS - 1);
+  }
+
+  _slots[slot] = ++_count;
+
+  return true;
+}
+
+//////////////////////////////////////////
+
+// Grows the buffer, keeping what it holds. Offsets are 16-bit
+bool ESP_WMArgStore::reserve(const size_t& size)
+{
+  size_t capped = std::min(size, (size_t) UINT16_MAX);
+
+  if (capped <= _size)
+  {
+    return false;
+  }
+
+  char* buf = new (std::nothrow) char[capped];
+
+  if (!buf)
+  {
+    return false;
+  }
+
+  if (_used)
+  {
+    memcpy(buf, _buf.get(), _used);
+  }
+
+  _buf.reset(buf);
+  _size = capped;
+
+  return true;
+}
+
+//////////////////////////////////////////
+
+int ESP_WMArgStore::find(const char* name) const
+{
+  uint32_t slot = wmFnv1a(name, strlen(name)) & (WM_ARG_STORE_SLOTS - 1);
+
+  while (_slots[slot])
+  {
+    const ArgEntry& entry = _entries[_slots[slot] - 1];
+
+    if (strcmp(&_buf[entry.name], name) == 0)
+    {
+      return _slots[slot] - 1;
+    }
+
+    slot = (slot + 1) & (WM_ARG_STORE_SLOTS - 1);
+  }
+
+  return -1;
+}
+
+//////////////////////////////////////////
+
+const char* ESP_WMArgStore::value(const char* name, size_t* len) const
+{
+  int index = find(name);
+
+  if (len)
+  {
+    *len = (index < 0) ? 0 : _entries[index].valueLen;
+  }
+
+  return (index < 0) ? "" : &_buf[_entries[index].value];
+}
+
+//////////////////////////////////////////
+
+bool ESP_WMArgStore::has(const char* name) const
+{
+  return (find(name) >= 0);
+}
+
+//////////////////////////////////////////
+
+size_t ESP_WMArgStore::copy(const char* name, char* dst, const size_t& size) const
+{
+  if (size == 0)
+  {
+    return 0;
+  }
+
+  size_t      len;
+  const char* src = value(name, &len);
+
+  if (len > size - 1)
+  {
+    len = size - 1;
+  }
+
+  memcpy(dst, src, len);
+  dst[len] = 0;
+
+  return len;
+}
+
 //////////////////////////////////////////
 //////////////////////////////////////////
 
@@ -221,7 +389,8 @@ ESP_WiFiManager::ESP_WiFiManager(const char *iHostname)
 #endif
 
   //WiFi not yet started here, must call WiFi.mode(WIFI_STA) and modify function WiFiGenericClass::mode(wifi_mode_t m) !!!
-  WiFi.mode(WIFI_STA);
+  // Kept if a previous instance left it in STA
+  setWiFiMode(WIFI_STA);
 
   if (iHostname[0] == 0)
   {
@@ -246,7 +415,7 @@ ESP_WiFiManager::ESP_WiFiManager(const char *iHostname)
 
   setHostname();
 
-  networkIndices = NULL;
+  beginConnectEvents();
 }
 
 //////////////////////////////////////////
@@ -264,10 +433,26 @@ ESP_WiFiManager::~ESP_WiFiManager()
 
 #endif
 
-  if (networkIndices)
-  {
-    free(networkIndices); //indices array no longer required so free memory
-  }
+#ifdef ESP32
+  WiFi.removeEvent(_connectEventId);
+
+  if (_connectEventSem)
+    vSemaphoreDelete(_connectEventSem);
+#endif
+
+#if USE_WM_LINK_PING
+  #ifdef ESP8266
+
+  if (_linkPcb)
+    raw_remove(_linkPcb);
+
+  #else
+
+  if (_linkPing)
+    esp_ping_delete_session(_linkPing);
+
+  #endif
+#endif
 }
 
 //////////////////////////////////////////
@@ -304,6 +489,8 @@ ESP_WiFiManager::~ESP_WiFiManager()
   _params[_paramsCount] = p;
   _paramsCount++;
 
+  bumpContentVersion();
+
   LOGINFO1(F("Adding parameter"), p->getID());
 
   return true;
@@ -316,6 +503,8 @@ ESP_WiFiManager::~ESP_WiFiManager()
     _params[_paramsCount] = p;
     _paramsCount++;
 
+    bumpContentVersion();
+
     LOGINFO1(F("Adding parameter"), p->getID());
   }
   else
@@ -330,7 +519,10 @@ ESP_WiFiManager::~ESP_WiFiManager()
 
 void ESP_WiFiManager::setupConfigPortal()
 {
-  stopConfigPortal = false; //Signal not to close config portal
+  _stopConfigPortalFlag = false; //Signal not to close config portal
+
+  // First scan in the background, so it's ready by the time someone opens the page
+  _scanWanted = true;
 
   /*This library assumes autoconnect is set to 1. It usually is
     but just in case check the setting and turn on autoconnect if it is off.
@@ -346,6 +538,10 @@ void ESP_WiFiManager::setupConfigPortal()
   server.reset(new WebServer(HTTP_PORT_TO_USE));
 #endif
 
+  _args.reset(new ESP_WMArgStore());
+  _pageBuf.reset(new char[WM_PAGE_CHUNK_SIZE + 1]);
+  _scanArena.reset(new WM_ScanArena());
+
   // optional soft ip config
   // Must be put here before dns server start to take care of the non-default ConfigPortal AP IP.
   // Check (https://github.com/khoih-prog/ESP_WiFiManager/issues/58)
@@ -409,6 +605,23 @@ void ESP_WiFiManager::setupConfigPortal()
 
   LOGWARN1(F("AP IP address ="), WiFi.softAPIP());
 
+  // Random start, so that ETags cached by a client before a reboot can't match
+#ifdef ESP8266
+  _contentVersion = RANDOM_REG32;
+#else
+  _contentVersion = esp_random();
+#endif
+
+  // No scan yet. Versions of a previous portal, or boot, are out of the delta window
+  _scanVersion      = _contentVersion;
+  _scanFloorVersion = _contentVersion;
+  _scanRemovedCount = 0;
+  _scanRemovedNext  = 0;
+
+  // Needed to answer page and asset revalidation with 304
+  const char* headerKeys[] = { "If-None-Match" };
+  server->collectHeaders(headerKeys, sizeof(headerKeys) / sizeof(headerKeys[0]));
+
   /* Setup web pages: root, wifi config pages, SO captive portal detectors and not found. */
   server->on("/", std::bind(&ESP_WiFiManager::handleRoot, this));
   server->on("/wifi", std::bind(&ESP_WiFiManager::handleWifi, this));
@@ -417,7 +630,12 @@ void ESP_WiFiManager::setupConfigPortal()
   server->on("/i", std::bind(&ESP_WiFiManager::handleInfo, this));
   server->on("/r", std::bind(&ESP_WiFiManager::handleReset, this));
   server->on("/state", std::bind(&ESP_WiFiManager::handleState, this));
+  server->on("/status", std::bind(&ESP_WiFiManager::handleStatus, this));
   server->on("/scan", std::bind(&ESP_WiFiManager::handleScan, this));
+  server->on("/metrics", std::bind(&ESP_WiFiManager::handleMetrics, this));
+  server->on("/link", std::bind(&ESP_WiFiManager::handleLink, this));
+  server->on("/wm.css", std::bind(&ESP_WiFiManager::handleStyle, this));
+  server->on("/wm.js", std::bind(&ESP_WiFiManager::handleScript, this));
   //Microsoft captive portal. Maybe not needed. Might be handled by notFound handler.
   server->on("/fwlink", std::bind(&ESP_WiFiManager::handleRoot, this));
   server->onNotFound(std::bind(&ESP_WiFiManager::handleNotFound, this));
@@ -458,32 +676,24 @@ bool ESP_WiFiManager::autoConnect()
 
 bool ESP_WiFiManager::autoConnect(char const *apName, char const *apPassword)
 {
+  int connRes;
+
 #if AUTOCONNECT_NO_INVALIDATE
   LOGINFO(F("\nAutoConnect using previously saved SSID/PW, but keep previous settings"));
   // Connect to previously saved SSID/PW, but keep previous settings
-  connectWifi();
+  connRes = connectWifi();
 #else
   LOGINFO(F("\nAutoConnect using previously saved SSID/PW, but invalidate previous settings"));
   // Connect to previously saved SSID/PW, but invalidate previous settings
-  connectWifi(WiFi_SSID(), WiFi_Pass());
+  connRes = connectWifi(WiFi_SSID(), WiFi_Pass());
 #endif
 
-  unsigned long startedAt = millis();
-
-  while (millis() - startedAt < 10000)
-  {
-    delay(200);
-
-    if (WiFi.status() == WL_CONNECTED)
-    {
-      float waited = (millis() - startedAt);
+  // Up to 10s more for an attempt still going on. Not for one that already failed
+  if ( (connRes != WL_CONNECTED) && (connRes != WL_NO_SSID_AVAIL) && (connRes != WL_CONNECT_FAILED) )
+    connRes = waitForConnectResult(10000);
 
-      LOGWARN1(F("Connected after waiting (s) :"), waited / 1000);
-      LOGWARN1(F("Local ip ="), WiFi.localIP());
-
-      return true;
-    }
-  }
+  if (connRes == WL_CONNECTED)
+    return true;
 
   return startConfigPortal(apName, apPassword);
 }
@@ -507,15 +717,64 @@ bool  ESP_WiFiManager::startConfigPortal()
 bool  ESP_WiFiManager::startConfigPortal(char const *apName, char const *apPassword)
 {
   //setup AP
-  int connRes = WiFi.waitForConnectResult();
+  WiFi.waitForConnectResult();
 
   LOGINFO("WiFi.waitForConnectResult Done");
 
-  if (connRes == WL_CONNECTED)
+  startConfigPortalAsync(apName, apPassword);
+
+  LOGINFO("startConfigPortal : Enter loop");
+
+  WM_PortalStatus portalStatus;
+
+  do
+  {
+    portalStatus = process();
+
+    yield();
+  } while (portalStatus < WM_PORTAL_CONNECTED);
+
+  if (portalStatus == WM_PORTAL_TIMED_OUT)
+  {
+    int connRes = waitForConnectResult();
+
+    LOGERROR1("Timed out connection result:", getStatus(connRes));
+  }
+
+  return  WiFi.status() == WL_CONNECTED;
+}
+
+//////////////////////////////////////////
+
+bool  ESP_WiFiManager::startConfigPortalAsync()
+{
+#ifdef ESP8266
+  String ssid = "ESP_" + String(ESP.getChipId());
+#else   //ESP32
+  String ssid = "ESP_" + String(ESP_getChipId());
+#endif
+  ssid.toUpperCase();
+
+  return startConfigPortalAsync(ssid.c_str(), NULL);
+}
+
+//////////////////////////////////////////
+
+bool  ESP_WiFiManager::startConfigPortalAsync(char const *apName, char const *apPassword)
+{
+  if ( (_portalStatus == WM_PORTAL_RUNNING) || (_portalStatus == WM_PORTAL_CONNECTING) )
+  {
+    LOGWARN(F("Config Portal already running"));
+
+    return false;
+  }
+
+  //setup AP
+  if (WiFi.status() == WL_CONNECTED)
   {
     LOGINFO("SET AP_STA");
 
-    WiFi.mode(WIFI_AP_STA); //Dual mode works fine if it is connected to WiFi
+    setWiFiMode(WIFI_AP_STA); //Dual mode works fine if it is connected to WiFi
   }
   else
   {
@@ -526,7 +785,7 @@ bool  ESP_WiFiManager::startConfigPortal(char const *apName, char const *apPassw
     // that means ESP8266 station is changing its channel to scan. This makes the channel of ESP8266 softAP keep changing too..
     // So the connection may break. From http://bbs.espressif.com/viewtopic.php?t=671#p2531
 
-    WiFi.mode(WIFI_AP);
+    setWiFiMode(WIFI_AP);
   }
 
   _apName = apName;
@@ -541,1336 +800,3739 @@ bool  ESP_WiFiManager::startConfigPortal(char const *apName, char const *apPassw
   }
 
   connect = false;
+  _portalConnectResult = WL_IDLE_STATUS;
 
   setupConfigPortal();
 
-  bool TimedOut = true;
+  _portalStatus = WM_PORTAL_RUNNING;
 
-  LOGINFO("startConfigPortal : Enter loop");
-
-  while (_configPortalTimeout == 0 || millis() < _configPortalStart + _configPortalTimeout)
-  {
-    //DNS
-    dnsServer->processNextRequest();
-    //HTTP
-    server->handleClient();
+  return true;
+}
 
-#if ( USING_ESP32_S2 || USING_ESP32_C3 )
-    // Fix ESP32-S2 issue with WebServer (https://github.com/espressif/arduino-esp32/issues/4348)
-    delay(1);
-#endif
+//////////////////////////////////////////
 
-    if (connect)
-    {
-      TimedOut = false;
-      delay(2000);
+// One DNS and one HTTP request at most per call. Never waits for the WiFi connection.
+WM_PortalStatus ESP_WiFiManager::process()
+{
+  if ( (_portalStatus != WM_PORTAL_RUNNING) && (_portalStatus != WM_PORTAL_CONNECTING) )
+    return _portalStatus;
 
-      LOGERROR(F("Connecting to new AP"));
+  //DNS
+  dnsServer->processNextRequest();
+  //HTTP
+  server->handleClient();
 
-      // using user-provided  _ssid, _pass in place of system-stored ssid and pass
-      if (connectWifi(_ssid, _pass) != WL_CONNECTED)
-      {
-        LOGERROR(F("Failed to connect"));
+#if ( USING_ESP32_S2 || USING_ESP32_C3 )
+  // Fix ESP32-S2 issue with WebServer (https://github.com/espressif/arduino-esp32/issues/4348)
+  delay(1);
+#endif
 
-        WiFi.mode(WIFI_AP); // Dual mode becomes flaky if not connected to a WiFi network.
-      }
-      else
-      {
-        //notify that configuration has changed and any optional parameters should be saved
-        if (_savecallback != NULL)
-        {
-          //todo: check if any custom parameters actually exist, and check if they really changed maybe
-          _savecallback();
-        }
+  processScan();
 
-        break;
-      }
+  if (_stopConfigPortalFlag)
+  {
+    LOGERROR("Stop ConfigPortal");    //KH
 
-      if (_shouldBreakAfterConfig)
-      {
-        //flag set to exit after config after trying to connect
-        //notify that configuration has changed and any optional parameters should be saved
-        if (_savecallback != NULL)
-        {
-          //todo: check if any custom parameters actually exist, and check if they really changed maybe
-          _savecallback();
-        }
+    endConfigPortal(WM_PORTAL_STOPPED);
+  }
+  else if (_portalStatus == WM_PORTAL_CONNECTING)
+  {
+    processPortalConnect();
+  }
+  else if (connect)
+  {
+    connect = false;
 
-        break;
-      }
-    }
+    _portalStatus         = WM_PORTAL_CONNECTING;
+    _portalConnectStart   = millis();
+    _portalConnectBegun   = false;
+    _portalConnectResult  = WL_IDLE_STATUS;
+    _portalLingering      = false;
+  }
+  else if ( (_configPortalTimeout != 0) && (millis() - _configPortalStart >= _configPortalTimeout) )
+  {
+    endConfigPortal(WM_PORTAL_TIMED_OUT);
+  }
 
-    if (stopConfigPortal)
-    {
-      //TimedOut = false;
+  return _portalStatus;
+}
 
-      LOGERROR("Stop ConfigPortal");    //KH
+//////////////////////////////////////////
 
-      stopConfigPortal = false;
-      break;
-    }
+void ESP_WiFiManager::processPortalConnect()
+{
+  if (_portalLingering)
+  {
+    if (millis() - _portalConnectStart >= WM_PORTAL_RESULT_LINGER)
+      endConfigPortal(_portalOutcome);
 
-    yield();
+    return;
   }
 
-  WiFi.mode(WIFI_STA);
-
-  if (TimedOut)
+  if (!_portalConnectBegun)
   {
-    setHostname();
+    // Let the "Credentials Saved" page get out first, and the radio finish any scan
+    if ( (millis() - _portalConnectStart < WM_PORTAL_CONNECT_DELAY) || _scanRunning )
+      return;
 
-    // To fix static IP when CP not entered or timed-out
-    setWifiStaticIP();
-
-    WiFi.begin();
-    int connRes = waitForConnectResult();
+    LOGERROR(F("Connecting to new AP"));
 
-    LOGERROR1("Timed out connection result:", getStatus(connRes));
-  }
+    _portalConnectBegun = true;
+    _portalConnectStart = millis();
+    _portalWPSTried     = false;
 
-  server->stop();
-  server.reset();
-  dnsServer->stop();
-  dnsServer.reset();
+    // using user-provided ssid and pass in place of system-stored ones, on the channel it was scanned on
+    if (beginConnectWifi(_credentials[0].ssid, _credentials[0].pass, _credentials[0].ap.channel,
+                         _credentials[0].ap.bssid))
+    {
+      if (_savecallback != NULL)
+        _savecallback();
 
-  return  WiFi.status() == WL_CONNECTED;
-}
+      lingerPortal(WL_CONNECTED, WM_PORTAL_CONNECTED);
+    }
 
-//////////////////////////////////////////
+    return;
+  }
 
-void ESP_WiFiManager::setWifiStaticIP()
-{
-#if USE_CONFIGURABLE_DNS
+  uint8_t connRes;
 
-  if (_WiFi_STA_IPconfig._sta_static_ip)
+  if (_portalWPS)
   {
-    LOGWARN(F("Custom STA IP/GW/Subnet"));
+    int8_t wpsStatus = wpsResult();
 
-    //***** Added section for DNS config option *****
-    if (_WiFi_STA_IPconfig._sta_static_dns1 && _WiFi_STA_IPconfig._sta_static_dns2)
+    if ( (wpsStatus == WM_WPS_PENDING) && (millis() - _portalConnectStart < WM_WPS_TIMEOUT) )
     {
-      LOGWARN(F("DNS1 and DNS2 set"));
-
-      WiFi.config(_WiFi_STA_IPconfig._sta_static_ip, _WiFi_STA_IPconfig._sta_static_gw, _WiFi_STA_IPconfig._sta_static_sn,
-                  _WiFi_STA_IPconfig._sta_static_dns1, _WiFi_STA_IPconfig._sta_static_dns2);
+      return;
     }
-    else if (_WiFi_STA_IPconfig._sta_static_dns1)
-    {
-      LOGWARN(F("Only DNS1 set"));
 
-      WiFi.config(_WiFi_STA_IPconfig._sta_static_ip, _WiFi_STA_IPconfig._sta_static_gw, _WiFi_STA_IPconfig._sta_static_sn,
-                  _WiFi_STA_IPconfig._sta_static_dns1);
-    }
-    else
+    LOGWARN1(F("WPS result:"), wpsStatus);
+
+    endWPS();
+
+    // Connecting with the WPS credentials, on the next calls
+    _portalConnectStart = millis();
+
+    if (wpsStatus == WM_WPS_SUCCESS)
     {
-      LOGWARN(F("No DNS server set"));
+      // Drops the disconnect of beginWPS(). An IP already got still shows in WiFi.status()
+      _connectEvents.clear();
 
-      WiFi.config(_WiFi_STA_IPconfig._sta_static_ip, _WiFi_STA_IPconfig._sta_static_gw, _WiFi_STA_IPconfig._sta_static_sn);
+      return;
     }
 
-    //***** End added section for DNS config option *****
-
-    LOGINFO1(F("setWifiStaticIP IP ="), WiFi.localIP());
+    connRes = WL_CONNECT_FAILED;
   }
   else
   {
-    LOGWARN(F("Can't use Custom STA IP/GW/Subnet"));
+    connRes = connectEventResult();
+    unsigned long timeout = (_connectTimeout == 0) ? WM_PORTAL_CONNECT_TIMEOUT : _connectTimeout;
+
+    if ( (connRes == WL_DISCONNECTED) && (millis() - _portalConnectStart < timeout) )
+    {
+      return;
+    }
+
+    LOGWARN1("Connection result: ", getStatus(connRes));
+
+    //not connected, WPS enabled, no pass - first attempt. WPS goes on over the next calls
+    if (_tryWPS && !_portalWPSTried && connRes != WL_CONNECTED && _credentials[0].pass == "")
+    {
+      _portalWPSTried = true;
+
+      if (beginWPS())
+      {
+        _portalWPS          = true;
+        _portalConnectStart = millis();
+
+        return;
+      }
+    }
   }
 
-#else
+  endConnectAttempt(connRes);
 
-  // check if we've got static_ip settings, if we do, use those.
-  if (_WiFi_STA_IPconfig._sta_static_ip)
+  if (connRes == WL_CONNECTED)
   {
-    WiFi.config(_WiFi_STA_IPconfig._sta_static_ip, _WiFi_STA_IPconfig._sta_static_gw, _WiFi_STA_IPconfig._sta_static_sn);
+    rememberConnectedAP(0);
 
-    LOGWARN1(F("Custom STA IP/GW/Subnet : "), WiFi.localIP());
+#if USE_WM_RTC_CACHE
+    saveRTCCache();
+#endif
+
+    //notify that configuration has changed and any optional parameters should be saved
+    if (_savecallback != NULL)
+    {
+      //todo: check if any custom parameters actually exist, and check if they really changed maybe
+      _savecallback();
+    }
+
+    lingerPortal(connRes, WM_PORTAL_CONNECTED);
+
+    return;
   }
 
-#endif
+  LOGERROR(F("Failed to connect"));
+
+  if (_credentials[0].failures < UINT16_MAX)
+    _credentials[0].failures++;
+
+  setWiFiMode(WIFI_AP); // Dual mode becomes flaky if not connected to a WiFi network.
+
+  if (_shouldBreakAfterConfig)
+  {
+    //flag set to exit after config after trying to connect
+    //notify that configuration has changed and any optional parameters should be saved
+    if (_savecallback != NULL)
+    {
+      //todo: check if any custom parameters actually exist, and check if they really changed maybe
+      _savecallback();
+    }
+
+    lingerPortal(connRes, WM_PORTAL_CONNECT_FAILED);
+
+    return;
+  }
+
+  // Back to serving the portal, the failure shown by /status
+  _portalConnectResult  = connRes;
+  _portalStatus         = WM_PORTAL_RUNNING;
 }
 
 //////////////////////////////////////////
 
-int ESP_WiFiManager::reconnectWifi()
+// Outcome known: the portal keeps serving /status for WM_PORTAL_RESULT_LINGER before it ends with portalStatus
+void ESP_WiFiManager::lingerPortal(const uint8_t& connRes, const WM_PortalStatus& portalStatus)
+{
+  _portalConnectResult  = connRes;
+  _portalOutcome        = portalStatus;
+  _portalLingering      = true;
+  _portalConnectStart   = millis();
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::stopConfigPortal()
+{
+  if ( (_portalStatus == WM_PORTAL_RUNNING) || (_portalStatus == WM_PORTAL_CONNECTING) )
+    _stopConfigPortalFlag = true;
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::endConfigPortal(const WM_PortalStatus& portalStatus)
 {
-  int connectResult;
+  if (_portalWPS)
+    endWPS();
 
-  // using user-provided _ssid, _pass instead of system-stored
-  if ( ( connectResult = connectWifi(_ssid, _pass) ) != WL_CONNECTED)
+  setWiFiMode(WIFI_STA);
+
+  if (portalStatus == WM_PORTAL_TIMED_OUT)
   {
-    LOGERROR1(F("Failed to connect to"), _ssid);
+    setHostname();
 
-    if ( ( connectResult = connectWifi(_ssid1, _pass1) ) != WL_CONNECTED)
-    {
-      LOGERROR1(F("Failed to connect to"), _ssid1);
+    // To fix static IP when CP not entered or timed-out
+    setWifiStaticIP();
 
-    }
-    else
-      LOGERROR1(F("Connected to"), _ssid1);
+    // Result is left to the caller, startConfigPortal() waits for it
+    _connectEvents.clear();
+    _connectSsidHash = 0;
+
+    WiFi.begin();
   }
-  else
-    LOGERROR1(F("Connected to"), _ssid);
 
-  return connectResult;
+  server->stop();
+  server.reset();
+  _args.reset();
+  _pageBuf.reset();
+  dnsServer->stop();
+  dnsServer.reset();
+
+  if (_scanRunning)
+    WiFi.scanDelete();
+
+  _scanArena.reset();
+  _scanResults  = NULL;
+  _scanCount    = 0;
+
+  _scanRemovedCount = 0;
+  _scanRemovedNext  = 0;
+
+  _scanRunning  = false;
+  _scanWanted   = false;
+  _scanDone     = false;
+
+  _stopConfigPortalFlag = false;
+  _portalLingering      = false;
+  _portalStatus         = portalStatus;
 }
 
 //////////////////////////////////////////
 
-int ESP_WiFiManager::connectWifi(const String& ssid, const String& pass)
+void ESP_WiFiManager::setWifiStaticIP()
 {
-  // Add option if didn't input/update SSID/PW => Use the previous saved Credentials.
-  // But update the Static/DHCP options if changed.
-  if ( (ssid != "") || ( (ssid == "") && (WiFi_SSID() != "") ) )
+#if USE_WM_RTC_CACHE
+
+  // Lease cached by the last connection, for a fast reconnect without DHCP. A static IP has precedence
+  if (_rtcLeaseWanted && !_WiFi_STA_IPconfig._sta_static_ip)
   {
-    //fix for auto connect racing issue, to avoid resetSettings()
-    if (WiFi.status() == WL_CONNECTED)
-    {
-      LOGWARN(F("Already connected. Bailing out."));
-      return WL_CONNECTED;
-    }
+    LOGWARN(F("Cached STA IP/GW/Subnet/DNS"));
 
-    if (ssid != "")
-      resetSettings();
+    WiFi.config(IPAddress(_rtcCache.ip), IPAddress(_rtcCache.gw), IPAddress(_rtcCache.sn),
+                IPAddress(_rtcCache.dns1), IPAddress(_rtcCache.dns2));
+
+    return;
+  }
 
-#ifdef ESP8266
-    setWifiStaticIP();
 #endif
 
-    WiFi.mode(WIFI_AP_STA); //It will start in station mode if it was previously in AP mode.
+#if USE_CONFIGURABLE_DNS
 
-    setHostname();
+  if (_WiFi_STA_IPconfig._sta_static_ip)
+  {
+    LOGWARN(F("Custom STA IP/GW/Subnet"));
 
-    // KH, Fix ESP32 staticIP after exiting CP
-#ifdef ESP32
-    setWifiStaticIP();
-#endif
+    //***** Added section for DNS config option *****
+    if (_WiFi_STA_IPconfig._sta_static_dns1 && _WiFi_STA_IPconfig._sta_static_dns2)
+    {
+      LOGWARN(F("DNS1 and DNS2 set"));
 
-    if (ssid != "")
+      WiFi.config(_WiFi_STA_IPconfig._sta_static_ip, _WiFi_STA_IPconfig._sta_static_gw, _WiFi_STA_IPconfig._sta_static_sn,
+                  _WiFi_STA_IPconfig._sta_static_dns1, _WiFi_STA_IPconfig._sta_static_dns2);
+    }
+    else if (_WiFi_STA_IPconfig._sta_static_dns1)
     {
-      // Start Wifi with new values.
-      LOGWARN(F("Connect to new WiFi using new IP parameters"));
+      LOGWARN(F("Only DNS1 set"));
 
-      WiFi.begin(ssid.c_str(), pass.c_str());
+      WiFi.config(_WiFi_STA_IPconfig._sta_static_ip, _WiFi_STA_IPconfig._sta_static_gw, _WiFi_STA_IPconfig._sta_static_sn,
+                  _WiFi_STA_IPconfig._sta_static_dns1);
     }
     else
     {
-      // Start Wifi with old values.
-      LOGWARN(F("Connect to previous WiFi using new IP parameters"));
+      LOGWARN(F("No DNS server set"));
 
-      WiFi.begin();
+      WiFi.config(_WiFi_STA_IPconfig._sta_static_ip, _WiFi_STA_IPconfig._sta_static_gw, _WiFi_STA_IPconfig._sta_static_sn);
     }
+
+    //***** End added section for DNS config option *****
+
+    LOGINFO1(F("setWifiStaticIP IP ="), WiFi.localIP());
   }
-  else if (WiFi_SSID() == "")
+  else
   {
-    LOGWARN(F("No saved credentials"));
+    LOGWARN(F("Can't use Custom STA IP/GW/Subnet"));
+
+    // DHCP, also in place of a cached lease applied before
+    WiFi.config(IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0));
   }
 
-  int connRes = waitForConnectResult();
+#else
 
-  LOGWARN1("Connection result: ", getStatus(connRes));
+  // check if we've got static_ip settings, if we do, use those.
+  if (_WiFi_STA_IPconfig._sta_static_ip)
+  {
+    WiFi.config(_WiFi_STA_IPconfig._sta_static_ip, _WiFi_STA_IPconfig._sta_static_gw, _WiFi_STA_IPconfig._sta_static_sn);
 
-  //not connected, WPS enabled, no pass - first attempt
-  if (_tryWPS && connRes != WL_CONNECTED && pass == "")
+    LOGWARN1(F("Custom STA IP/GW/Subnet : "), WiFi.localIP());
+  }
+  else
   {
-    startWPS();
-    //should be connected at the end of WPS
-    connRes = waitForConnectResult();
+    // DHCP, also in place of a cached lease applied before
+    WiFi.config(IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0));
   }
 
-  return connRes;
+#endif
 }
 
 //////////////////////////////////////////
 
-uint8_t ESP_WiFiManager::waitForConnectResult()
+int ESP_WiFiManager::reconnectWifi()
 {
-  if (_connectTimeout == 0)
-  {
-    unsigned long startedAt = millis();
+  int     connectResult = WL_NO_SSID_AVAIL;
+  uint8_t order[MAX_WIFI_CREDENTIALS];
 
-    // In ESP8266, WiFi.waitForConnectResult() @return wl_status_t (0-255) or -1 on timeout !!!
-    // In ESP32, WiFi.waitForConnectResult() @return wl_status_t (0-255)
-    // So, using int for connRes to be safe
-    //int connRes = WiFi.waitForConnectResult();
-    WiFi.waitForConnectResult();
+  scanKnownNetworks();
 
-    float waited = (millis() - startedAt);
+  _attemptScanTime = _connectStats.lastScanTime;
 
-    LOGWARN1(F("Connected after waiting (s) :"), waited / 1000);
-    LOGWARN1(F("Local ip ="), WiFi.localIP());
+  uint8_t count = rankCredentials(order);
 
-    // Fix bug, connRes is sometimes not correct.
-    //return connRes;
-    return WiFi.status();
-  }
-  else
+  for (uint8_t j = 0; j < count; j++)
   {
-    LOGERROR(F("Waiting WiFi connection with time out"));
+    uint8_t         index = order[j];
+    WM_Credential&  cred  = _credentials[index];
 
-    unsigned long start = millis();
-    bool keepConnecting = true;
-    uint8_t status;
+    // Seen by the scan: straight to its channel and BSSID. Otherwise still tried, in case it is hidden
+    if (cred.rssi)
+      connectResult = connectWifi(cred.ssid, cred.pass, cred.ap.channel, cred.ap.bssid);
+    else
+      connectResult = connectWifi(cred.ssid, cred.pass);
 
-    while (keepConnecting)
+    if (connectResult == WL_CONNECTED)
     {
-      status = WiFi.status();
+      LOGERROR1(F("Connected to"), cred.ssid);
 
-      if (millis() > start + _connectTimeout)
-      {
-        keepConnecting = false;
-        LOGERROR(F("Connection timed out"));
-      }
-
-      if (status == WL_CONNECTED || status == WL_CONNECT_FAILED)
-      {
-        keepConnecting = false;
-      }
+      rememberConnectedAP(index);
 
-      delay(100);
+      break;
     }
 
-    return status;
+    LOGERROR1(F("Failed to connect to"), cred.ssid);
+
+    if (cred.failures < UINT16_MAX)
+      cred.failures++;
   }
+
+  return connectResult;
 }
 
 //////////////////////////////////////////
 
-void ESP_WiFiManager::startWPS()
+bool ESP_WiFiManager::supervise()
 {
-#ifdef ESP8266
-  LOGINFO("START WPS");
-  WiFi.beginWPSConfig();
-  LOGINFO("END WPS");
-#else   //ESP32
-  // TODO
-  LOGINFO("ESP32 WPS TODO");
-#endif
-}
+  monitorLink();
 
-//////////////////////////////////////////
+  // The Config Portal has the radio
+  if ( (_portalStatus == WM_PORTAL_RUNNING) || (_portalStatus == WM_PORTAL_CONNECTING) )
+    return false;
 
-//Convenient for debugging but wasteful of program space.
-//Remove if short of space
-const char* ESP_WiFiManager::getStatus(const int& status)
-{
-  switch (status)
+  switch (_supState)
   {
-    case WL_IDLE_STATUS:
-      return "WL_IDLE_STATUS";
+    case WM_SUPERVISOR_CONNECTED:
 
-    case WL_NO_SSID_AVAIL:
-      return "WL_NO_SSID_AVAIL";
+      if (WiFi.status() == WL_CONNECTED)
+      {
+        if (_roamEnabled)
+          superviseRoaming();
 
-    case WL_CONNECTED:
-      return "WL_CONNECTED";
+        return true;
+      }
 
-    case WL_CONNECT_FAILED:
-      return "WL_CONNECT_FAILED";
+      LOGWARN(F("WiFi lost"));
 
-    case WL_DISCONNECTED:
-      return "WL_DISCONNECTED";
+      // Left to the SDK reconnection for the first, shortest, backoff
+      _supBackoff = 0;
+      superviseRetry();
 
-    default:
-      return "UNKNOWN";
-  }
-}
+      return false;
 
-//////////////////////////////////////////
+    case WM_SUPERVISOR_BACKOFF:
 
-String ESP_WiFiManager::getConfigPortalSSID()
-{
-  return _apName;
-}
+      if (WiFi.status() == WL_CONNECTED)
+      {
+        LOGWARN(F("WiFi connected"));
 
-//////////////////////////////////////////
+        _supBackoff = 0;
+        _supState   = WM_SUPERVISOR_CONNECTED;
 
-String ESP_WiFiManager::getConfigPortalPW()
-{
-  return _apPassword;
-}
+        return true;
+      }
 
-//////////////////////////////////////////
+      if ( (long) (millis() - _supNextTry) < 0 )
+        return false;
 
-void ESP_WiFiManager::resetSettings()
-{
-  LOGINFO(F("Previous settings invalidated"));
+      LOGWARN(F("Scanning for saved networks"));
 
-#ifdef ESP8266
-  WiFi.disconnect(true);
-#else
-  WiFi.disconnect(true, true);
+      setWiFiMode( (WiFiMode_t) (WiFi.getMode() | WIFI_STA) );
 
-  // Temporary fix for issue of not clearing WiFi SSID/PW from flash of ESP32
-  // See https://github.com/khoih-prog/ESP_WiFiManager/issues/25 and https://github.com/espressif/arduino-esp32/issues/400
-  WiFi.begin("0", "0");
-  //////
-#endif
+      _supStart = millis();
 
-  delay(200);
+      if (WiFi.scanNetworks(true, true) == WIFI_SCAN_RUNNING)
+      {
+        _supState = WM_SUPERVISOR_SCANNING;
 
-  return;
-}
+        return false;
+      }
 
-//////////////////////////////////////////
+      // Scan not started, try them all unseen
+      for (uint8_t k = 0; k < MAX_WIFI_CREDENTIALS; k++)
+        _credentials[k].rssi = 0;
 
-void ESP_WiFiManager::setTimeout(const unsigned long& seconds)
-{
-  setConfigPortalTimeout(seconds);
-}
+      _supCount = rankCredentials(_supOrder);
+      _supNext  = 0;
 
-//////////////////////////////////////////
+      superviseNext();
 
-void ESP_WiFiManager::setConfigPortalTimeout(const unsigned long& seconds)
-{
-  _configPortalTimeout = seconds * 1000;
-}
+      return false;
 
-//////////////////////////////////////////
+    case WM_SUPERVISOR_SCANNING:
+    {
+      int n = WiFi.scanComplete();
 
-void ESP_WiFiManager::setConnectTimeout(const unsigned long& seconds)
-{
-  _connectTimeout = seconds * 1000;
-}
+      if ( (n == WIFI_SCAN_RUNNING) && (millis() - _supStart < WM_SUPERVISOR_SCAN_TIMEOUT) )
+        return false;
 
-//////////////////////////////////////////
+      for (uint8_t k = 0; k < MAX_WIFI_CREDENTIALS; k++)
+        _credentials[k].rssi = 0;
 
-void ESP_WiFiManager::setDebugOutput(bool debug)
-{
-  _debug = debug;
-}
+      if (n > 0)
+        matchKnownNetworks(n);
 
-//////////////////////////////////////////
+      WiFi.scanDelete();
 
-// KH, To enable dynamic/random channel
-int ESP_WiFiManager::setConfigPortalChannel(const int& channel)
-{
-  // If channel < MIN_WIFI_CHANNEL - 1 or channel > MAX_WIFI_CHANNEL => channel = 1
-  // If channel == 0 => will use random channel from MIN_WIFI_CHANNEL to MAX_WIFI_CHANNEL
-  // If (MIN_WIFI_CHANNEL <= channel <= MAX_WIFI_CHANNEL) => use it
-  if ( (channel < MIN_WIFI_CHANNEL - 1) || (channel > MAX_WIFI_CHANNEL) )
-    _WiFiAPChannel = 1;
-  else if ( (channel >= MIN_WIFI_CHANNEL - 1) && (channel <= MAX_WIFI_CHANNEL) )
-    _WiFiAPChannel = channel;
+      _attemptScanTime = millis() - _supStart;
 
-  return _WiFiAPChannel;
-}
+      _supCount = rankCredentials(_supOrder);
+      _supNext  = 0;
 
-//////////////////////////////////////////
+      superviseNext();
 
-void ESP_WiFiManager::setAPStaticIPConfig(const IPAddress& ip, const IPAddress& gw, const IPAddress& sn)
-{
-  LOGINFO(F("setAPStaticIPConfig"));
-  _WiFi_AP_IPconfig._ap_static_ip = ip;
-  _WiFi_AP_IPconfig._ap_static_gw = gw;
-  _WiFi_AP_IPconfig._ap_static_sn = sn;
+      return false;
+    }
+
+    case WM_SUPERVISOR_CONNECTING:
+    {
+      uint8_t         status  = connectEventResult();
+      uint8_t         index   = _supOrder[_supNext];
+      unsigned long   timeout = (_connectTimeout == 0) ? WM_SUPERVISOR_CONNECT_TIMEOUT : _connectTimeout;
+
+      if (status == WL_CONNECTED)
+      {
+        // Roaming: the status may still be the one of the AP left, until the SDK drops it. A roam once on the new AP
+        uint8_t*  bssid   = WiFi.BSSID();
+        bool      roamed  = bssid && (memcmp(bssid, _roamAP.bssid, sizeof(_roamAP.bssid)) == 0);
+
+        if (_roamConnecting && !roamed)
+        {
+          if (millis() - _supStart < timeout)
+            return true;
+
+          // Still on the AP left, the link kept but the roam failed
+          LOGWARN(F("Roam timed out, same AP"));
+
+          endConnectAttempt(WL_CONNECT_FAILED);
+          _connectStats.roamFailures++;
+        }
+        else
+        {
+          LOGWARN1(F("Connected to"), WiFi.SSID());
+
+          if (_roamConnecting)
+            _connectStats.roams++;
+
+          endConnectAttempt(status);
+          rememberConnectedAP(index);
+        }
+
+        _supBackoff     = 0;
+        _supState       = WM_SUPERVISOR_CONNECTED;
+        _roamRssi       = 0;
+        _roamConnecting = false;
+
+        return true;
+      }
+
+      // Failures reported by the events end the attempt now, otherwise the timeout
+      if ( (status == WL_DISCONNECTED) && (millis() - _supStart < timeout) )
+        return false;
+
+      LOGWARN1(F("Failed to connect, status ="), getStatus(status));
+
+      endConnectAttempt(status);
+
+      if (_credentials[index].failures < UINT16_MAX)
+        _credentials[index].failures++;
+
+      if (_roamConnecting)
+        _connectStats.roamFailures++;
+
+      _roamConnecting = false;
+      _supNext++;
+
+      superviseNext();
+
+      return false;
+    }
+
+    case WM_SUPERVISOR_ROAMING:
+    {
+      // Lost while scanning, taken over by the next call
+      if (WiFi.status() != WL_CONNECTED)
+      {
+        _supState = WM_SUPERVISOR_CONNECTED;
+
+        return false;
+      }
+
+      int n = WiFi.scanComplete();
+
+      if ( (n == WIFI_SCAN_RUNNING) && (millis() - _supStart < WM_SUPERVISOR_SCAN_TIMEOUT) )
+        return true;
+
+      if (n > 0)
+        collectRoamingAPs(n);
+
+      WiFi.scanDelete();
+
+      if (_roamPending && startRoamingScan())
+        return true;
+
+      endRoamingScan();
+
+      return (_supState == WM_SUPERVISOR_CONNECTED);
+    }
+  }
+
+  return false;
 }
 
 //////////////////////////////////////////
 
-void ESP_WiFiManager::setAPStaticIPConfig(const WiFi_AP_IPConfig&  WM_AP_IPconfig)
+// Starts the connection to the next saved network in _supOrder, or backs off if all were tried
+void ESP_WiFiManager::superviseNext()
 {
-  LOGINFO(F("setAPStaticIPConfig"));
+  if (_supNext >= _supCount)
+  {
+    superviseRetry();
 
-  memcpy((void*) &_WiFi_AP_IPconfig, &WM_AP_IPconfig, sizeof(_WiFi_AP_IPconfig));
+    return;
+  }
+
+  WM_Credential& cred = _credentials[_supOrder[_supNext]];
+
+  // Empty only for the first one, and the system-stored credentials
+  if ( (cred.ssid == "") && (WiFi_SSID() == "") )
+  {
+    _supNext++;
+
+    superviseNext();
+
+    return;
+  }
+
+  beginConnectAttempt();
+
+  setWifiStaticIP();
+
+  // Seen by the scan: straight to its channel and BSSID. Otherwise still tried, in case it is hidden
+  if (cred.rssi)
+    startConnect(cred.ssid, cred.pass, cred.ap.channel, cred.ap.bssid);
+  else
+    startConnect(cred.ssid, cred.pass, 0, NULL);
+
+  _supStart = millis();
+  _supState = WM_SUPERVISOR_CONNECTING;
 }
 
 //////////////////////////////////////////
 
-void ESP_WiFiManager::getAPStaticIPConfig(WiFi_AP_IPConfig  &WM_AP_IPconfig)
+// Jittered exponential backoff
+void ESP_WiFiManager::superviseRetry()
 {
-  LOGINFO(F("getAPStaticIPConfig"));
+  _supBackoff = _supBackoff ? std::min(2 * _supBackoff, (unsigned long) WM_SUPERVISOR_BACKOFF_MAX)
+                : WM_SUPERVISOR_BACKOFF_MIN;
 
-  memcpy((void*) &WM_AP_IPconfig, &_WiFi_AP_IPconfig, sizeof(WM_AP_IPconfig));
+  unsigned long wait = (_supBackoff / 2) + random(_supBackoff / 2 + 1);
+
+  LOGWARN1(F("WiFi retry in ms ="), wait);
+
+  _supNextTry = millis() + wait;
+  _supState   = WM_SUPERVISOR_BACKOFF;
 }
 
 //////////////////////////////////////////
 
-void ESP_WiFiManager::setSTAStaticIPConfig(const IPAddress& ip, const IPAddress& gw, const IPAddress& sn)
+void ESP_WiFiManager::setRoaming(const bool& enable, const int8_t& threshold, const uint8_t& hysteresis)
 {
-  LOGINFO(F("setSTAStaticIPConfig"));
-  _WiFi_STA_IPconfig._sta_static_ip = ip;
-  _WiFi_STA_IPconfig._sta_static_gw = gw;
-  _WiFi_STA_IPconfig._sta_static_sn = sn;
+  _roamEnabled    = enable;
+  _roamThreshold  = threshold;
+  _roamHysteresis = hysteresis;
+  _roamRssi       = 0;
 }
 
 //////////////////////////////////////////
 
-void ESP_WiFiManager::setSTAStaticIPConfig(const WiFi_STA_IPConfig& WM_STA_IPconfig)
+// Averages the RSSI of the connection, and starts a roaming scan when it is too low
+void ESP_WiFiManager::superviseRoaming()
 {
-  LOGINFO(F("setSTAStaticIPConfig"));
+  if ( (long) (millis() - _roamNextSample) < 0 )
+    return;
 
-  memcpy((void*) &_WiFi_STA_IPconfig, &WM_STA_IPconfig, sizeof(_WiFi_STA_IPconfig));
-}
+  _roamNextSample = millis() + WM_ROAM_SAMPLE_INTERVAL;
 
-//////////////////////////////////////////
+  int32_t rssi = WiFi.RSSI();
 
-void ESP_WiFiManager::getSTAStaticIPConfig(WiFi_STA_IPConfig &WM_STA_IPconfig)
-{
-  LOGINFO(F("getSTAStaticIPConfig"));
+  // Not valid
+  if (rssi >= 0)
+    return;
 
-  memcpy((void*) &WM_STA_IPconfig, &_WiFi_STA_IPconfig, sizeof(WM_STA_IPconfig));
+  if (_roamRssi == 0)
+    _roamRssi = rssi * 16;
+  else
+    _roamRssi += (rssi * 16 - _roamRssi) / WM_ROAM_EWMA_WEIGHT;
+
+  if ( (_roamRssi >= _roamThreshold * 16) || ( (long) (millis() - _roamNextScan) < 0 ) )
+    return;
+
+  LOGWARN1(F("Weak signal, looking for a stronger AP, RSSI ="), getRoamingRSSI());
+
+  uint8_t channel = (uint8_t) WiFi.channel();
+
+  if (channel < 16)
+    _roamChannels |= (1 << channel);
+
+  // Channels the SSID was seen on, or all of them now and then to find new ones
+  _roamPending  = (_roamScans++ % WM_ROAM_FULL_SCAN_EVERY) ? _roamChannels : 0;
+  _roamBest     = 0;
+
+  if (startRoamingScan())
+    _supState = WM_SUPERVISOR_ROAMING;
+  else
+    _roamNextScan = millis() + WM_ROAM_SCAN_INTERVAL;
 }
 
 //////////////////////////////////////////
 
-#if USE_CONFIGURABLE_DNS
-void ESP_WiFiManager::setSTAStaticIPConfig(const IPAddress& ip, const IPAddress& gw, const IPAddress& sn,
-                                           const IPAddress& dns_address_1, const IPAddress& dns_address_2)
+// Async scan of the next channel in _roamPending, or of all of them if none is left
+bool ESP_WiFiManager::startRoamingScan()
 {
-  LOGINFO(F("setSTAStaticIPConfig for USE_CONFIGURABLE_DNS"));
-  _WiFi_STA_IPconfig._sta_static_ip = ip;
-  _WiFi_STA_IPconfig._sta_static_gw = gw;
-  _WiFi_STA_IPconfig._sta_static_sn = sn;
-  _WiFi_STA_IPconfig._sta_static_dns1 = dns_address_1; //***** Added argument *****
-  _WiFi_STA_IPconfig._sta_static_dns2 = dns_address_2; //***** Added argument *****
-}
+  uint8_t channel = 0;
+
+#if WM_CHANNEL_SCAN
+  for (uint8_t k = 1; k < 16; k++)
+  {
+    if (_roamPending & (1 << k))
+    {
+      channel = k;
+      _roamPending &= ~(1 << k);
+
+      break;
+    }
+  }
+#else
+  _roamPending = 0;
 #endif
 
-//////////////////////////////////////////
+  LOGDEBUG1(F("Roaming scan, channel ="), channel);
 
-void ESP_WiFiManager::setMinimumSignalQuality(const int& quality)
-{
-  _minimumQuality = quality;
+  _supStart = millis();
+
+#if WM_CHANNEL_SCAN
+  #ifdef ESP8266
+    return (WiFi.scanNetworks(true, false, channel) == WIFI_SCAN_RUNNING);
+  #else
+    return (WiFi.scanNetworks(true, false, false, WM_KNOWN_SCAN_CHANNEL_TIME, channel) == WIFI_SCAN_RUNNING);
+  #endif
+#else
+  return (WiFi.scanNetworks(true, false) == WIFI_SCAN_RUNNING);
+#endif
 }
 
 //////////////////////////////////////////
 
-void ESP_WiFiManager::setBreakAfterConfig(bool shouldBreak)
+// Keeps where the SSID was seen, and its strongest AP other than the current one
+void ESP_WiFiManager::collectRoamingAPs(const int& n)
 {
-  _shouldBreakAfterConfig = shouldBreak;
+  String    current = WiFi.SSID();
+  uint8_t*  connectedBssid = WiFi.BSSID();
+
+  for (int i = 0; i < n; i++)
+  {
+    if (WiFi.SSID(i) != current)
+      continue;
+
+    int32_t   rssi    = WiFi.RSSI(i);
+    int32_t   channel = WiFi.channel(i);
+    uint8_t*  bssid   = WiFi.BSSID(i);
+
+    if ( (channel > 0) && (channel < 16) )
+      _roamChannels |= (1 << channel);
+
+    if ( !bssid || ( connectedBssid && (memcmp(bssid, connectedBssid, sizeof(_roamAP.bssid)) == 0) ) )
+      continue;
+
+    if ( (_roamBest == 0) || (rssi > _roamBest) )
+    {
+      _roamBest       = (int8_t) std::min(rssi, (int32_t) -1);
+      _roamAP.channel = (uint8_t) channel;
+      memcpy(_roamAP.bssid, bssid, sizeof(_roamAP.bssid));
+    }
+  }
 }
 
 //////////////////////////////////////////
 
-void ESP_WiFiManager::reportStatus(String &page)
+// Reassociates to the best AP found if it beats the average by the hysteresis. Not again before WM_ROAM_SCAN_INTERVAL
+void ESP_WiFiManager::endRoamingScan()
 {
-  page += FPSTR(WM_HTTP_SCRIPT_NTP_MSG);
+  _roamNextScan = millis() + WM_ROAM_SCAN_INTERVAL;
+  _supState     = WM_SUPERVISOR_CONNECTED;
 
-  if (WiFi_SSID() != "")
+  if ( (_roamBest == 0) || (_roamBest * 16 < _roamRssi + _roamHysteresis * 16) )
   {
-    page += F("Configured to connect to access point <b>");
-    page += WiFi_SSID();
+    LOGINFO1(F("No stronger AP, best RSSI ="), _roamBest);
 
-    if (WiFi.status() == WL_CONNECTED)
-    {
-      page += F(" and currently connected</b> on IP <a href=\"http://");
-      page += WiFi.localIP().toString();
-      page += F("/\">");
-      page += WiFi.localIP().toString();
-      page += F("</a>");
-    }
-    else
+    return;
+  }
+
+  // Saved network connected to, or the system-stored credentials
+  String  current = WiFi.SSID();
+  uint8_t index   = MAX_WIFI_CREDENTIALS;
+
+  for (uint8_t k = 0; k < MAX_WIFI_CREDENTIALS; k++)
+  {
+    if ( (_credentials[k].ssid != "") && (_credentials[k].ssid == current) )
     {
-      page += F(" but not currently connected</b> to network.");
+      index = k;
+
+      break;
     }
   }
-  else
+
+  if ( (index == MAX_WIFI_CREDENTIALS) && (_credentials[0].ssid == "") && (WiFi_SSID() == current) )
+    index = 0;
+
+  if (index == MAX_WIFI_CREDENTIALS)
   {
-    page += F("No network currently configured.");
+    LOGINFO1(F("No credentials to roam on"), current);
+
+    return;
   }
+
+  LOGWARN3(F("Roaming to channel"), _roamAP.channel, F(", RSSI ="), _roamBest);
+
+  // Straight to the new AP, IP configuration kept. Followed as any attempt of the supervisor
+  beginConnectAttempt();
+
+  startConnect(_credentials[index].ssid, _credentials[index].pass, _roamAP.channel, _roamAP.bssid);
+
+  _supOrder[0]    = index;
+  _supCount       = 1;
+  _supNext        = 0;
+  _supStart       = millis();
+  _supState       = WM_SUPERVISOR_CONNECTING;
+  _roamConnecting = true;
 }
 
 //////////////////////////////////////////
 
-/** Handle root or redirect to captive portal */
-void ESP_WiFiManager::handleRoot()
+// Saved networks worth trying into order, most likely to succeed first, insertion sorted. Equal scores keep the
+// saved order. An empty first SSID is kept, it still means the system-stored one. Returns how many
+uint8_t ESP_WiFiManager::rankCredentials(uint8_t* order)
 {
-  LOGDEBUG(F("Handle root"));
+  int     scores[MAX_WIFI_CREDENTIALS];
+  uint8_t count = 0;
 
-  // Disable _configPortalTimeout when someone accessing Portal to give some time to config
-  _configPortalTimeout = 0;   //KH
-
-  if (captivePortal())
+  for (uint8_t k = 0; k < MAX_WIFI_CREDENTIALS; k++)
   {
-    // If caprive portal redirect instead of displaying the error page.
-    return;
+    if ( (k > 0) && (_credentials[k].ssid == "") )
+      continue;
+
+    int     score = credentialScore(k);
+    uint8_t j     = count++;
+
+    for ( ; (j > 0) && (scores[j - 1] < score); j--)
+    {
+      order[j]  = order[j - 1];
+      scores[j] = scores[j - 1];
+    }
+
+    order[j]  = k;
+    scores[j] = score;
   }
 
-  server->sendHeader(FPSTR(WM_HTTP_CACHE_CONTROL), FPSTR(WM_HTTP_NO_STORE));
+  return count;
+}
 
-#if USING_CORS_FEATURE
-  // For configure CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
-  server->sendHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
+//////////////////////////////////////////
+
+// Connection order, highest first: seen by the last scan and its signal, then connected before, then few failures
+int ESP_WiFiManager::credentialScore(const uint8_t& index)
+{
+  const WM_Credential& cred = _credentials[index];
+
+  int score = 0;
+
+  if (cred.rssi)
+    score += 100 + getRSSIasQuality(cred.rssi);
+
+  if (cred.lastSuccess)
+    score += 50;
+
+  score -= 25 * std::min(cred.failures, (uint16_t) 4);
+
+  return score;
+}
+
+//////////////////////////////////////////
+
+// Looks for the saved networks on the channels they were last seen on only, then with a full sweep if none is there.
+// No scan at all if no channel is known, WiFi.begin() is then as quick as before.
+// Sets the rssi of those seen, and where. Returns the index of the strongest one, or -1
+int ESP_WiFiManager::scanKnownNetworks()
+{
+  int           found     = -1;
+  bool          targeted  = false;
+  unsigned long startedAt = millis();
+
+  for (int k = 0; k < MAX_WIFI_CREDENTIALS; k++)
+    _credentials[k].rssi = 0;
+
+#if WM_CHANNEL_SCAN
+  // Bit per channel already scanned
+  uint16_t scanned = 0;
+
+  for (int k = 0; k < MAX_WIFI_CREDENTIALS; k++)
+  {
+    uint8_t channel = _credentials[k].ap.channel;
+
+    if ( (channel == 0) || (channel > 15) || (scanned & (1 << channel)) || (_credentials[k].ssid == "") )
+      continue;
+
+    scanned |= (1 << channel);
+    targeted  = true;
+
+    LOGDEBUG1(F("Scanning known channel"), channel);
+
+#ifdef ESP8266
+    int n = WiFi.scanNetworks(false, true, channel);
+#else
+    int n = WiFi.scanNetworks(false, true, false, WM_KNOWN_SCAN_CHANNEL_TIME, channel);
 #endif
 
-  server->sendHeader(FPSTR(WM_HTTP_PRAGMA), FPSTR(WM_HTTP_NO_CACHE));
-  server->sendHeader(FPSTR(WM_HTTP_EXPIRES), "-1");
+    if (n > 0)
+      found = matchKnownNetworks(n);
 
-  String page = FPSTR(WM_HTTP_HEAD_START);
+    WiFi.scanDelete();
+  }
+#endif
 
-  page.replace("{v}", "Options");
-  page += FPSTR(WM_HTTP_SCRIPT);
-  page += FPSTR(WM_HTTP_SCRIPT_NTP);
-  page += FPSTR(WM_HTTP_STYLE);
-  page += _customHeadElement;
-  page += FPSTR(WM_HTTP_HEAD_END);
-  page += "<h2>";
-  page += _apName;
+  unsigned long scanTime = millis() - startedAt;
 
-  if (WiFi_SSID() != "")
+  if (found >= 0)
   {
-    if (WiFi.status() == WL_CONNECTED)
-    {
-      page += " on ";
-      page += WiFi_SSID();
-    }
-    else
-    {
-      page += " <s>on ";
-      page += WiFi_SSID();
-      page += "</s>";
-    }
+    _connectStats.knownScans++;
+
+    if (_connectStats.fullScanTime > scanTime)
+      _connectStats.scanTimeSaved += _connectStats.fullScanTime - scanTime;
+
+    LOGWARN3(F("Found"), _credentials[found].ssid, F("on its channel, ms ="), scanTime);
   }
+  else if (targeted)
+  {
+    LOGWARN(F("Saved networks not on their channels, full scan"));
+
+    unsigned long fullStartedAt = millis();
+
+    int n = WiFi.scanNetworks(false, true);
 
-  page += "</h2>";
-  page += FPSTR(WM_HTTP_PORTAL_OPTIONS);
-  page += F("<div class=\"msg\">");
-  reportStatus(page);
-  page += F("</div>");
-  page += FPSTR(WM_HTTP_END);
+    _connectStats.fullScanTime = millis() - fullStartedAt;
+    _connectStats.fullScans++;
+
+    if (n > 0)
+      found = matchKnownNetworks(n);
+
+    WiFi.scanDelete();
+  }
+  else
+  {
+    LOGDEBUG(F("No channel known, no scan"));
+  }
 
-  server->send(200, "text/html", page);
+  _connectStats.lastScanTime = millis() - startedAt;
 
+  return found;
 }
 
 //////////////////////////////////////////
 
-/** Wifi config page handler */
-void ESP_WiFiManager::handleWifi()
+// Keeps the RSSI, channel and BSSID of the strongest AP of each saved network in the driver scan, over the
+// scans since scanKnownNetworks() started. Returns the index of the strongest saved network seen, or -1
+int ESP_WiFiManager::matchKnownNetworks(const int& n)
 {
-  LOGDEBUG(F("Handle WiFi"));
+  for (int i = 0; i < n; i++)
+  {
+    String  ssid = WiFi.SSID(i);
+    int32_t rssi = WiFi.RSSI(i);
 
-  // Disable _configPortalTimeout when someone accessing Portal to give some time to config
-  _configPortalTimeout = 0;   //KH
+    if (ssid == "")
+      continue;
 
-  server->sendHeader(FPSTR(WM_HTTP_CACHE_CONTROL), FPSTR(WM_HTTP_NO_STORE));
+    for (int k = 0; k < MAX_WIFI_CREDENTIALS; k++)
+    {
+      WM_Credential& cred = _credentials[k];
 
-#if USING_CORS_FEATURE
-  // For configure CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
-  server->sendHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
-#endif
+      if ( ( cred.rssi && (rssi <= cred.rssi) ) || (ssid != cred.ssid) )
+        continue;
 
-  server->sendHeader(FPSTR(WM_HTTP_PRAGMA), FPSTR(WM_HTTP_NO_CACHE));
-  server->sendHeader(FPSTR(WM_HTTP_EXPIRES), "-1");
+      uint8_t* bssid = WiFi.BSSID(i);
 
-  String page = FPSTR(WM_HTTP_HEAD_START);
+      if (!bssid)
+        continue;
 
-  page.replace("{v}", "Config ESP");
-  page += FPSTR(WM_HTTP_SCRIPT);
-  page += FPSTR(WM_HTTP_SCRIPT_NTP);
-  page += FPSTR(WM_HTTP_STYLE);
-  page += _customHeadElement;
-  page += FPSTR(WM_HTTP_HEAD_END);
-  page += F("<h2>Configuration</h2>");
+      // 0 is "not seen"
+      cred.rssi       = (int8_t) std::min(rssi, (int32_t) -1);
+      cred.ap.channel = (uint8_t) WiFi.channel(i);
+      memcpy(cred.ap.bssid, bssid, sizeof(cred.ap.bssid));
+    }
+  }
 
-  //  KH, New
-  numberOfNetworks = scanWifiNetworks(&networkIndices);
+  int found = -1;
 
-  //Print list of WiFi networks that were found in earlier scan
-  if (numberOfNetworks == 0)
+  for (int k = 0; k < MAX_WIFI_CREDENTIALS; k++)
   {
-    page += F("No network found. Refresh to scan again.");
+    if ( _credentials[k].rssi && ( (found < 0) || (_credentials[k].rssi > _credentials[found].rssi) ) )
+      found = k;
   }
-  else
+
+  return found;
+}
+
+//////////////////////////////////////////
+
+// Same from the Config Portal scan, strongest first. Networks not in it keep where they were last seen
+void ESP_WiFiManager::updateKnownAPs(const WM_ScanResult* results, const int& n)
+{
+  for (int k = 0; k < MAX_WIFI_CREDENTIALS; k++)
   {
-    page += FPSTR(WM_FLDSET_START);
+    WM_Credential& cred = _credentials[k];
 
-    //display networks in page
-    for (int i = 0; i < numberOfNetworks; i++)
+    if (cred.ssid == "")
+      continue;
+
+    for (int i = 0; i < n; i++)
     {
-      if (networkIndices[i] == -1)
-        continue; // skip dups and those that are below the required quality
+      if (strcmp(results[i].ssid, cred.ssid.c_str()) == 0)
+      {
+        cred.rssi       = std::min(results[i].rssi, (int8_t) -1);
+        cred.ap.channel = results[i].channel;
+        memcpy(cred.ap.bssid, results[i].bssid, sizeof(cred.ap.bssid));
+
+        break;
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////
+
+// A success for the ranking, and the channel and BSSID of the current connection for the next channel-targeted scan
+void ESP_WiFiManager::rememberConnectedAP(const uint8_t& index)
+{
+  if (index >= MAX_WIFI_CREDENTIALS)
+    return;
+
+  WM_Credential& cred = _credentials[index];
+
+  // 0 is "never"
+  cred.lastSuccess  = std::max(millis(), 1UL);
+  cred.failures     = 0;
+
+  uint8_t* bssid = WiFi.BSSID();
+
+  if (!bssid)
+    return;
+
+  cred.ap.channel = (uint8_t) WiFi.channel();
+  memcpy(cred.ap.bssid, bssid, sizeof(cred.ap.bssid));
+}
+
+//////////////////////////////////////////
+
+// Resets the connection history if the SSID changes
+void ESP_WiFiManager::setCredential(const uint8_t& index, const String& ssid, const String& pwd)
+{
+  if (index >= MAX_WIFI_CREDENTIALS)
+    return;
+
+  WM_Credential& cred = _credentials[index];
+
+  if (cred.ssid != ssid)
+  {
+    cred.ssid         = ssid;
+    cred.lastSuccess  = 0;
+    cred.failures     = 0;
+    cred.rssi         = 0;
+    memset(&cred.ap, 0, sizeof(cred.ap));
+  }
+
+  cred.pass = pwd;
+}
+
+//////////////////////////////////////////
+
+int ESP_WiFiManager::connectWifi(const String& ssid, const String& pass, const uint8_t& channel, const uint8_t* bssid)
+{
+#if USE_WM_RTC_CACHE
+
+  // Fast reconnect, straight to the cached AP. With USE_WM_RTC_LEASE, also with the cached lease until it was used
+  // WM_RTC_LEASE_MAX_USES times, then through DHCP for a new one
+  if ( (channel == 0) && loadRTCCache( (ssid != "") ? ssid : WiFi_SSID() ) )
+  {
+    _rtcLeaseWanted = USE_WM_RTC_LEASE && (_rtcCache.leaseUses < WM_RTC_LEASE_MAX_USES);
+
+    LOGWARN3(F("Fast reconnect on channel"), _rtcCache.channel, F(", cached lease ="), _rtcLeaseWanted);
+
+    bool    leaseUsed = _rtcLeaseWanted;
+    bool    connected = beginConnectWifi(ssid, pass, _rtcCache.channel, _rtcCache.bssid);
+
+    _rtcLeaseWanted = false;
+
+    if (connected)
+      return WL_CONNECTED;
+
+    int connRes = waitForConnectResult();
+
+    if (connRes == WL_CONNECTED)
+    {
+      saveRTCCache(leaseUsed ? _rtcCache.leaseUses + 1 : 0);
+
+      return connRes;
+    }
+
+    LOGWARN1(F("Fast reconnect failed, full connect. Result:"), getStatus(connRes));
+
+    // The full connect can't loop back here. Its setWifiStaticIP() goes back to DHCP
+    clearRTCCache();
+  }
+
+#endif
+
+  if (beginConnectWifi(ssid, pass, channel, bssid))
+    return WL_CONNECTED;
+
+  int connRes = waitForConnectResult();
+
+  LOGWARN1("Connection result: ", getStatus(connRes));
+
+  //not connected, WPS enabled, no pass - first attempt
+  if (_tryWPS && connRes != WL_CONNECTED && pass == "")
+  {
+    startWPS();
+    //should be connected at the end of WPS
+    connRes = waitForConnectResult();
+  }
+
+#if USE_WM_RTC_CACHE
+
+  if (connRes == WL_CONNECTED)
+    saveRTCCache();
+
+#endif
+
+  return connRes;
+}
+
+//////////////////////////////////////////
+
+#if USE_WM_RTC_CACHE
+
+#ifdef ESP32
+// Kept through deep sleep
+RTC_DATA_ATTR WM_RTCCache wmRTCCache;
+#endif
+
+// Into _rtcCache. True if it is valid and for ssid
+bool ESP_WiFiManager::loadRTCCache(const String& ssid)
+{
+  if (ssid == "")
+    return false;
+
+#ifdef ESP8266
+
+  if (!ESP.rtcUserMemoryRead(WM_RTC_CACHE_OFFSET, (uint32_t*) &_rtcCache, sizeof(_rtcCache)))
+    return false;
+
+#else
+  _rtcCache = wmRTCCache;
+#endif
+
+  if (_rtcCache.crc != wmCrc32(&_rtcCache.ssidHash, sizeof(_rtcCache) - sizeof(_rtcCache.crc)))
+  {
+    LOGDEBUG(F("No valid RTC cache"));
+
+    return false;
+  }
+
+  return (_rtcCache.ssidHash == wmFnv1a(ssid.c_str(), ssid.length())) && (_rtcCache.channel != 0);
+}
+
+//////////////////////////////////////////
+
+// AP and lease of the current connection, the lease used leaseUses times already
+void ESP_WiFiManager::saveRTCCache(const uint8_t& leaseUses)
+{
+  String    ssid  = WiFi.SSID();
+  uint8_t*  bssid = WiFi.BSSID();
+
+  if ( (ssid == "") || !bssid )
+    return;
+
+  WM_RTCCache cache;
+
+  memset(&cache, 0, sizeof(cache));
+
+  cache.ssidHash  = wmFnv1a(ssid.c_str(), ssid.length());
+  cache.channel   = (uint8_t) WiFi.channel();
+  memcpy(cache.bssid, bssid, sizeof(cache.bssid));
+  cache.leaseUses = leaseUses;
+
+  cache.ip        = (uint32_t) WiFi.localIP();
+  cache.gw        = (uint32_t) WiFi.gatewayIP();
+  cache.sn        = (uint32_t) WiFi.subnetMask();
+  cache.dns1      = (uint32_t) WiFi.dnsIP(0);
+  cache.dns2      = (uint32_t) WiFi.dnsIP(1);
+
+  cache.crc       = wmCrc32(&cache.ssidHash, sizeof(cache) - sizeof(cache.crc));
+
+#ifdef ESP8266
+  ESP.rtcUserMemoryWrite(WM_RTC_CACHE_OFFSET, (uint32_t*) &cache, sizeof(cache));
+#else
+  wmRTCCache = cache;
+#endif
+
+  LOGDEBUG1(F("RTC cache saved, channel ="), cache.channel);
+}
+
+//////////////////////////////////////////
+
+// All zero, whose CRC doesn't match
+void ESP_WiFiManager::clearRTCCache()
+{
+  memset(&_rtcCache, 0, sizeof(_rtcCache));
+
+#ifdef ESP8266
+  ESP.rtcUserMemoryWrite(WM_RTC_CACHE_OFFSET, (uint32_t*) &_rtcCache, sizeof(_rtcCache));
+#else
+  wmRTCCache = _rtcCache;
+#endif
+}
+
+#endif
+
+//////////////////////////////////////////
+
+// With a known channel and BSSID, the driver doesn't sweep all channels for the AP
+bool ESP_WiFiManager::beginConnectWifi(const String& ssid, const String& pass, const uint8_t& channel,
+                                       const uint8_t* bssid)
+{
+  // Add option if didn't input/update SSID/PW => Use the previous saved Credentials.
+  // But update the Static/DHCP options if changed.
+  if ( (ssid != "") || ( (ssid == "") && (WiFi_SSID() != "") ) )
+  {
+    //fix for auto connect racing issue, to avoid resetSettings()
+    if (WiFi.status() == WL_CONNECTED)
+    {
+      LOGWARN(F("Already connected. Bailing out."));
+      return true;
+    }
+
+    beginConnectAttempt();
+
+    // Previous network dropped. Not with resetSettings(), whose delay(200) would hold up process(), and whose WiFi
+    // off and on again are two more mode switches
+    if (ssid != "")
+      WiFi.disconnect();
+
+#ifdef ESP8266
+    setWifiStaticIP();
+#endif
+
+    // AP_STA for the Config Portal only. Otherwise a softAP started by the sketch is kept, none is started
+    if ( (_portalStatus == WM_PORTAL_RUNNING) || (_portalStatus == WM_PORTAL_CONNECTING) )
+      setWiFiMode(WIFI_AP_STA);
+    else
+      setWiFiMode( (WiFiMode_t) (WiFi.getMode() | WIFI_STA) );
+
+    setHostname();
+
+    // KH, Fix ESP32 staticIP after exiting CP
+#ifdef ESP32
+    setWifiStaticIP();
+#endif
+
+    startConnect(ssid, pass, channel, bssid);
+  }
+  else if (WiFi_SSID() == "")
+  {
+    LOGWARN(F("No saved credentials"));
+  }
+
+  return false;
+}
+
+//////////////////////////////////////////
+
+// Global, per boot
+WM_ModeStats wmModeStats = { 0, 0, 0, 0 };
+
+// All the WiFi mode changes of the library. Each switch restarts the radio, so those to the mode already set are skipped
+bool ESP_WiFiManager::setWiFiMode(const WiFiMode_t& mode)
+{
+  if (WiFi.getMode() == mode)
+  {
+    wmModeStats.skipped++;
+
+    return true;
+  }
+
+  unsigned long startedAt = millis();
+
+  bool result = WiFi.mode(mode);
+
+  wmModeStats.lastSwitchTime  = millis() - startedAt;
+  wmModeStats.switchTime     += wmModeStats.lastSwitchTime;
+  wmModeStats.switches++;
+
+  LOGINFO3(F("WiFi mode ="), mode, F(", ms ="), wmModeStats.lastSwitchTime);
+
+  return result;
+}
+
+//////////////////////////////////////////
+
+const WM_ModeStats& ESP_WiFiManager::getModeStats()
+{
+  return wmModeStats;
+}
+
+//////////////////////////////////////////
+
+// WiFi.begin(), ssid "" for the system-stored credentials. Mode and IP settings are left to the caller
+void ESP_WiFiManager::startConnect(const String& ssid, const String& pass, const uint8_t& channel, const uint8_t* bssid)
+{
+  // Events from here on are this attempt's
+  String target = (ssid != "") ? ssid : WiFi_SSID();
+
+  _connectEvents.clear();
+  _connectSsidHash = wmFnv1a(target.c_str(), target.length());
+
+  setConnectPhase(WM_PHASE_MODE, millis() - _attemptStart);
+  _attemptBegin = millis();
+
+  if (ssid != "")
+  {
+    // Start Wifi with new values.
+    LOGWARN(F("Connect to new WiFi using new IP parameters"));
+
+    if (channel)
+      WiFi.begin(ssid.c_str(), pass.c_str(), channel, bssid);
+    else
+      WiFi.begin(ssid.c_str(), pass.c_str());
+  }
+  else
+  {
+    // Start Wifi with old values.
+    LOGWARN(F("Connect to previous WiFi using new IP parameters"));
+
+    if (channel)
+      WiFi.begin(WiFi_SSID().c_str(), WiFi_Pass().c_str(), channel, bssid);
+    else
+      WiFi.begin();
+  }
+}
+
+//////////////////////////////////////////
+
+uint8_t ESP_WiFiManager::waitForConnectResult()
+{
+  return waitForConnectResult( (_connectTimeout == 0) ? WM_PORTAL_CONNECT_TIMEOUT : _connectTimeout );
+}
+
+//////////////////////////////////////////
+
+// Returns as soon as the WiFi events tell how the attempt ended: connected with an IP, no such SSID, or an
+// authentication failure. The timeout is only for attempts that never end
+uint8_t ESP_WiFiManager::waitForConnectResult(const unsigned long& timeout)
+{
+  unsigned long startedAt = millis();
+  uint8_t       status;
+
+  // Nothing was started
+  if (WiFi_SSID() == "")
+    return WiFi.status();
+
+  while (true)
+  {
+    status = connectEventResult();
+
+    if (status != WL_DISCONNECTED)
+      break;
+
+    unsigned long waited = millis() - startedAt;
+
+    if (waited >= timeout)
+    {
+      LOGERROR(F("Connection timed out"));
+
+      status = WiFi.status();
+
+      break;
+    }
+
+    unsigned long slice = std::min(timeout - waited, (unsigned long) WM_CONNECT_WAIT_SLICE);
+
+#ifdef ESP8266
+    delay(slice);
+#else
+    xSemaphoreTake(_connectEventSem, pdMS_TO_TICKS(slice));
+#endif
+  }
+
+  float waited = (millis() - startedAt);
+
+  LOGWARN1(F("Connection result after waiting (s) :"), waited / 1000);
+  LOGWARN1(F("Local ip ="), WiFi.localIP());
+
+  endConnectAttempt(status);
+
+  return status;
+}
+
+//////////////////////////////////////////
+
+// The WiFi callbacks only queue the events, connectEventResult() reads them
+void ESP_WiFiManager::beginConnectEvents()
+{
+#ifdef ESP8266
+
+  _connectedHandler = WiFi.onStationModeConnected([this](const WiFiEventStationModeConnected & event)
+  {
+    pushConnectEvent(WM_EVENT_CONNECTED, 0, (const uint8_t*) event.ssid.c_str(), event.ssid.length());
+  });
+
+  _gotIPHandler = WiFi.onStationModeGotIP([this](const WiFiEventStationModeGotIP & event)
+  {
+    (void) event;
+
+    pushConnectEvent(WM_EVENT_GOT_IP);
+  });
+
+  _disconnectedHandler = WiFi.onStationModeDisconnected([this](const WiFiEventStationModeDisconnected & event)
+  {
+    pushConnectEvent(WM_EVENT_DISCONNECTED, (uint8_t) event.reason, (const uint8_t*) event.ssid.c_str(),
+                     event.ssid.length());
+  });
+
+#else
+
+  _connectEventSem = xSemaphoreCreateBinary();
+
+  _connectEventId = WiFi.onEvent([this](WiFiEvent_t event, WiFiEventInfo_t info)
+  {
+    switch (event)
+    {
+      case WM_ESP32_STA_CONNECTED:
+        pushConnectEvent(WM_EVENT_CONNECTED);
+        break;
+
+      case WM_ESP32_STA_GOT_IP:
+        pushConnectEvent(WM_EVENT_GOT_IP);
+        break;
+
+      case WM_ESP32_STA_DISCONNECTED:
+        pushConnectEvent(WM_EVENT_DISCONNECTED, WM_ESP32_DISCONNECTED_INFO(info).reason,
+                         WM_ESP32_DISCONNECTED_INFO(info).ssid, WM_ESP32_DISCONNECTED_INFO(info).ssid_len);
+        break;
+
+      default:
+        break;
+    }
+  });
+
+#endif
+}
+
+//////////////////////////////////////////
+
+// From the WiFi callbacks only, the single producer of _connectEvents
+void ESP_WiFiManager::pushConnectEvent(const uint8_t& type, const uint8_t& reason, const uint8_t* ssid,
+                                       const size_t& ssidLen)
+{
+  WM_ConnectEvent event;
+
+  event.type      = type;
+  event.reason    = reason;
+  event.ssidHash  = ssid ? wmFnv1a(ssid, ssidLen) : 0;
+  event.time      = millis();
+
+  _connectEvents.push(event);
+
+  // Connections lost, for the link-quality monitor
+  if (type == WM_EVENT_GOT_IP)
+  {
+    _linkUp = true;
+  }
+  else if ( (type == WM_EVENT_DISCONNECTED) && _linkUp )
+  {
+    _linkUp = false;
+    _linkDrops++;
+  }
+
+#ifdef ESP32
+
+  if (_connectEventSem)
+    xSemaphoreGive(_connectEventSem);
+
+#endif
+}
+
+//////////////////////////////////////////
+
+// WL_CONNECTED once there is an IP, WL_NO_SSID_AVAIL or WL_CONNECT_FAILED if a disconnect of the current attempt
+// ends it, WL_DISCONNECTED while it goes on. Events of other SSIDs, from before WiFi.begin(), are skipped.
+// Polled, with WiFi.status(), by the non-blocking portal
+uint8_t ESP_WiFiManager::connectEventResult()
+{
+  WM_ConnectEvent event;
+
+  while (_connectEvents.pop(event))
+  {
+    if (event.type == WM_EVENT_GOT_IP)
+    {
+      setConnectPhase(WM_PHASE_DHCP, event.time - (_attemptLinkUp ? _attemptLinkUp : _attemptBegin));
+
+      return WL_CONNECTED;
+    }
+
+    if ( _connectSsidHash && event.ssidHash && (event.ssidHash != _connectSsidHash) )
+      continue;
+
+    if (event.type == WM_EVENT_CONNECTED)
+    {
+      setConnectPhase(WM_PHASE_LINK, event.time - _attemptBegin);
+      _attemptLinkUp = event.time;
+
+      continue;
+    }
+
+    switch (event.reason)
+    {
+      case WM_REASON_NO_AP_FOUND:
+        LOGWARN(F("SSID not found"));
+
+        return WL_NO_SSID_AVAIL;
+
+      case WM_REASON_AUTH_FAIL:
+      case WM_REASON_4WAY_HANDSHAKE_TIMEOUT:
+      case WM_REASON_HANDSHAKE_TIMEOUT:
+        LOGWARN1(F("Authentication failed, reason ="), event.reason);
+
+        return WL_CONNECT_FAILED;
+
+      default:
+        break;
+    }
+  }
+
+  // Events dropped by a full queue still show in the status
+  uint8_t status = WiFi.status();
+
+  if ( (status == WL_CONNECTED) || (status == WL_CONNECT_FAILED) || (status == WL_NO_SSID_AVAIL) )
+    return status;
+
+  return WL_DISCONNECTED;
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::beginConnectAttempt()
+{
+  memset(&_attempt, 0, sizeof(_attempt));
+
+  _attemptOpen    = true;
+  _attemptStart   = millis();
+  _attemptBegin   = _attemptStart;
+  _attemptLinkUp  = 0;
+
+  if (_attemptScanTime)
+  {
+    setConnectPhase(WM_PHASE_SCAN, _attemptScanTime);
+
+    _attemptScanTime = 0;
+  }
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::setConnectPhase(const uint8_t& phase, const unsigned long& ms)
+{
+  if (!_attemptOpen)
+    return;
+
+  _attempt.phase[phase]  = (uint16_t) std::min(ms, (unsigned long) UINT16_MAX);
+  _attempt.reached      |= (1 << phase);
+}
+
+//////////////////////////////////////////
+
+// Into the history. Only the first call after beginConnectAttempt() counts
+void ESP_WiFiManager::endConnectAttempt(const uint8_t& result)
+{
+  if (!_attemptOpen)
+    return;
+
+  setConnectPhase(WM_PHASE_TOTAL, millis() - _attemptStart + _attempt.phase[WM_PHASE_SCAN]);
+
+  _attempt.result = result;
+  _attemptOpen    = false;
+
+  LOGWARN3(F("Connect ms, link ="), _attempt.phase[WM_PHASE_LINK], F(", DHCP ="), _attempt.phase[WM_PHASE_DHCP]);
+
+  if (!_attempts)
+  {
+    _attempts.reset(new (std::nothrow) WM_ConnectAttempt[WM_CONNECT_HISTORY]);
+
+    if (!_attempts)
+      return;
+  }
+
+  _attempts[_attemptNext] = _attempt;
+  _attemptNext = (_attemptNext + 1) % WM_CONNECT_HISTORY;
+
+  if (_attemptCount < WM_CONNECT_HISTORY)
+    _attemptCount++;
+}
+
+//////////////////////////////////////////
+
+WM_ConnectTiming ESP_WiFiManager::getConnectTiming()
+{
+  WM_ConnectTiming  timing;
+  uint32_t          sum[WM_PHASE_COUNT]   = { 0 };
+  uint8_t           count[WM_PHASE_COUNT] = { 0 };
+
+  memset(&timing, 0, sizeof(timing));
+
+  timing.attempts = _attemptCount;
+
+  for (uint8_t i = 0; i < _attemptCount; i++)
+  {
+    const WM_ConnectAttempt& attempt = _attempts[i];
+
+    if (attempt.result == WL_CONNECTED)
+      timing.connected++;
+
+    for (uint8_t phase = 0; phase < WM_PHASE_COUNT; phase++)
+    {
+      if ( !(attempt.reached & (1 << phase)) )
+        continue;
+
+      WM_PhaseStats& stats = timing.phase[phase];
+
+      if ( (count[phase] == 0) || (attempt.phase[phase] < stats.min) )
+        stats.min = attempt.phase[phase];
+
+      if (attempt.phase[phase] > stats.max)
+        stats.max = attempt.phase[phase];
+
+      sum[phase] += attempt.phase[phase];
+      count[phase]++;
+    }
+  }
+
+  for (uint8_t phase = 0; phase < WM_PHASE_COUNT; phase++)
+  {
+    if (count[phase])
+      timing.phase[phase].avg = sum[phase] / count[phase];
+  }
+
+  if (_attemptCount)
+    timing.last = _attempts[(_attemptNext + WM_CONNECT_HISTORY - 1) % WM_CONNECT_HISTORY];
+
+  return timing;
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::printConnectMetrics(Print& out)
+{
+  static const char* const phaseNames[WM_PHASE_COUNT] = { "scan", "mode", "link", "dhcp", "total" };
+
+  WM_ConnectTiming  timing = getConnectTiming();
+  char              line[256];
+  int               len;
+
+  len = snprintf_P(line, sizeof(line), WM_METRICS_PHASE_HEAD);
+  out.write((const uint8_t*) line, len);
+
+  for (uint8_t phase = 0; phase < WM_PHASE_COUNT; phase++)
+  {
+    const WM_PhaseStats& stats = timing.phase[phase];
+
+    len = snprintf_P(line, sizeof(line), WM_METRICS_PHASE, phaseNames[phase], "min", stats.min);
+    out.write((const uint8_t*) line, len);
+    len = snprintf_P(line, sizeof(line), WM_METRICS_PHASE, phaseNames[phase], "avg", stats.avg);
+    out.write((const uint8_t*) line, len);
+    len = snprintf_P(line, sizeof(line), WM_METRICS_PHASE, phaseNames[phase], "max", stats.max);
+    out.write((const uint8_t*) line, len);
+  }
+
+  len = snprintf_P(line, sizeof(line), WM_METRICS_COUNTERS, timing.attempts, timing.connected, timing.last.result);
+  out.write((const uint8_t*) line, len);
+
+  len = snprintf_P(line, sizeof(line), WM_METRICS_SCAN, _connectStats.knownScans, _connectStats.fullScans,
+                   _connectStats.lastScanTime, _connectStats.scanTimeSaved);
+  out.write((const uint8_t*) line, len);
+
+  len = snprintf_P(line, sizeof(line), WM_METRICS_ROAM, _connectStats.roams, _connectStats.roamFailures,
+                   getRoamingRSSI());
+  out.write((const uint8_t*) line, len);
+
+  len = snprintf_P(line, sizeof(line), WM_METRICS_MODE, wmModeStats.switches, wmModeStats.skipped,
+                   wmModeStats.switchTime);
+  out.write((const uint8_t*) line, len);
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::setLinkMonitor(const bool& enable, const unsigned long& interval)
+{
+  if (enable && !_linkSamples)
+  {
+    _linkSamples.reset(new (std::nothrow) WM_LinkSample[WM_LINK_HISTORY]);
+  }
+  else if (!enable)
+  {
+    _linkSamples.reset();
+  }
+
+  _linkNext       = 0;
+  _linkCount      = 0;
+  _linkEnabled    = enable && _linkSamples;
+  _linkInterval   = interval;
+  _linkNextSample = millis();
+
+  if (enable && !_linkEnabled)
+  {
+    LOGERROR(F("No memory for the link monitor"));
+  }
+}
+
+//////////////////////////////////////////
+
+// Records a sample, with the answer to the echo sent by the previous one, and sends the next echo
+void ESP_WiFiManager::monitorLink()
+{
+  if ( !_linkEnabled || ( (long) (millis() - _linkNextSample) < 0 ) )
+    return;
+
+  _linkNextSample = millis() + _linkInterval;
+
+  bool            connected = (WiFi.status() == WL_CONNECTED);
+  int32_t         rssi      = connected ? WiFi.RSSI() : 0;
+  uint16_t        rtt       = _linkRtt;
+  WM_LinkSample&  sample    = _linkSamples[_linkNext];
+
+  sample.time   = millis();
+  // ESP8266 gives 31 when not valid
+  sample.rssi   = (rssi < 0) ? (int8_t) std::max(rssi, (int32_t) INT8_MIN) : 0;
+  sample.rtt    = (rtt == WM_LINK_RTT_PENDING) ? WM_LINK_RTT_LOST : rtt;
+  sample.drops  = _linkDrops;
+
+  _linkNext = (_linkNext + 1) % WM_LINK_HISTORY;
+
+  if (_linkCount < WM_LINK_HISTORY)
+    _linkCount++;
+
+  _linkRtt = WM_LINK_RTT_NONE;
+
+#if USE_WM_LINK_PING
+  IPAddress gateway = WiFi.gatewayIP();
+
+  if ( connected && ( (uint32_t) gateway != 0 ) )
+  {
+    // Set first, the ESP32 answer comes from the ping task
+    _linkRtt = WM_LINK_RTT_PENDING;
+
+    if (!sendLinkPing(gateway))
+      _linkRtt = WM_LINK_RTT_NONE;
+  }
+
+#endif
+}
+
+//////////////////////////////////////////
+
+#if USE_WM_LINK_PING
+  #ifdef ESP8266
+
+// ICMP echo request on a raw pcb, made once. lwIP hands the reply to linkPingReply()
+bool ESP_WiFiManager::sendLinkPing(const IPAddress& gateway)
+{
+  if (!_linkPcb)
+  {
+    _linkPcb = raw_new(IP_PROTO_ICMP);
+
+    if (!_linkPcb)
+      return false;
+
+    raw_recv(_linkPcb, [](void* arg, struct raw_pcb* pcb, struct pbuf* p, const ip_addr_t* addr) -> u8_t
+    {
+      (void) pcb;
+      (void) addr;
+
+      return ((ESP_WiFiManager*) arg)->linkPingReply(p);
+    }, this);
+
+    raw_bind(_linkPcb, IP_ADDR_ANY);
+  }
+
+  struct pbuf* p = pbuf_alloc(PBUF_IP, sizeof(struct icmp_echo_hdr) + WM_LINK_PING_DATA, PBUF_RAM);
+
+  if (!p)
+    return false;
+
+  struct icmp_echo_hdr* echo = (struct icmp_echo_hdr*) p->payload;
+
+  memset(echo, 0, p->len);
+
+  echo->type    = ICMP_ECHO;
+  echo->id      = lwip_htons(WM_LINK_PING_ID);
+  echo->seqno   = lwip_htons(++_linkSeq);
+  echo->chksum  = inet_chksum(echo, p->len);
+
+  ip_addr_t target;
+
+  IP_ADDR4(&target, gateway[0], gateway[1], gateway[2], gateway[3]);
+
+  _linkPingSent = millis();
+
+  err_t err = raw_sendto(_linkPcb, p, &target);
+
+  pbuf_free(p);
+
+  return (err == ERR_OK);
+}
+
+//////////////////////////////////////////
+
+// In the lwIP context. Takes the echo reply to the last request only, other ICMP goes on
+uint8_t ESP_WiFiManager::linkPingReply(struct pbuf* p)
+{
+  struct icmp_echo_hdr  echo;
+  uint16_t              headerLen = IPH_HL((struct ip_hdr*) p->payload) * 4;
+
+  if (pbuf_copy_partial(p, &echo, sizeof(echo), headerLen) != sizeof(echo))
+    return 0;
+
+  if ( (echo.type != ICMP_ER) || (echo.id != lwip_htons(WM_LINK_PING_ID)) || (echo.seqno != lwip_htons(_linkSeq)) )
+    return 0;
+
+  if (_linkRtt == WM_LINK_RTT_PENDING)
+    _linkRtt = (uint16_t) std::min(millis() - _linkPingSent, (unsigned long) WM_LINK_RTT_PENDING - 1);
+
+  pbuf_free(p);
+
+  return 1;
+}
+
+  #else
+
+// esp_ping session of one echo, made once per gateway. Its task reports back through the callbacks
+bool ESP_WiFiManager::sendLinkPing(const IPAddress& gateway)
+{
+  if ( _linkPing && (_linkPingAddr != (uint32_t) gateway) )
+  {
+    esp_ping_delete_session(_linkPing);
+    _linkPing = NULL;
+  }
+
+  if (!_linkPing)
+  {
+    esp_ping_config_t config = ESP_PING_DEFAULT_CONFIG();
+
+    IP_ADDR4(&config.target_addr, gateway[0], gateway[1], gateway[2], gateway[3]);
+
+    config.count      = 1;
+    config.timeout_ms = WM_LINK_PING_TIMEOUT;
+    config.data_size  = WM_LINK_PING_DATA;
+
+    esp_ping_callbacks_t callbacks = {};
+
+    callbacks.cb_args = this;
+
+    callbacks.on_ping_success = [](esp_ping_handle_t hdl, void* args)
+    {
+      ESP_WiFiManager*  wm = (ESP_WiFiManager*) args;
+      uint32_t          elapsed;
+
+      esp_ping_get_profile(hdl, ESP_PING_PROF_TIMEGAP, &elapsed, sizeof(elapsed));
+
+      if (wm->_linkRtt == WM_LINK_RTT_PENDING)
+        wm->_linkRtt = (uint16_t) std::min(elapsed, (uint32_t) WM_LINK_RTT_PENDING - 1);
+    };
+
+    callbacks.on_ping_timeout = [](esp_ping_handle_t hdl, void* args)
+    {
+      (void) hdl;
+
+      ESP_WiFiManager* wm = (ESP_WiFiManager*) args;
+
+      if (wm->_linkRtt == WM_LINK_RTT_PENDING)
+        wm->_linkRtt = WM_LINK_RTT_LOST;
+    };
+
+    if (esp_ping_new_session(&config, &callbacks, &_linkPing) != ESP_OK)
+    {
+      _linkPing = NULL;
+
+      return false;
+    }
+
+    _linkPingAddr = (uint32_t) gateway;
+  }
+
+  return (esp_ping_start(_linkPing) == ESP_OK);
+}
+
+  #endif
+#endif
+
+//////////////////////////////////////////
+
+uint8_t ESP_WiFiManager::getLinkHistory(WM_LinkSample* samples, const uint8_t& size)
+{
+  uint8_t count = std::min(size, _linkCount);
+  uint8_t first = (_linkNext + WM_LINK_HISTORY - count) % WM_LINK_HISTORY;
+
+  for (uint8_t i = 0; i < count; i++)
+    samples[i] = _linkSamples[(first + i) % WM_LINK_HISTORY];
+
+  return count;
+}
+
+//////////////////////////////////////////
+
+// Sorted on the stack, nothing allocated
+WM_LinkStats ESP_WiFiManager::getLinkStats()
+{
+  WM_LinkStats  stats = { _linkCount, 0, 0, 0, WM_LINK_RTT_NONE, WM_LINK_RTT_NONE, WM_LINK_RTT_NONE, 0, 0 };
+  int8_t        rssi[WM_LINK_HISTORY];
+  uint16_t      rtt[WM_LINK_HISTORY];
+  uint8_t       rssiCount = 0;
+  uint8_t       rttCount  = 0;
+
+  if (_linkCount == 0)
+    return stats;
+
+  uint8_t first = (_linkNext + WM_LINK_HISTORY - _linkCount) % WM_LINK_HISTORY;
+
+  for (uint8_t i = 0; i < _linkCount; i++)
+  {
+    const WM_LinkSample& sample = _linkSamples[(first + i) % WM_LINK_HISTORY];
+
+    if (sample.rssi)
+    {
+      uint8_t j = rssiCount++;
+
+      for ( ; (j > 0) && (rssi[j - 1] > sample.rssi); j--)
+        rssi[j] = rssi[j - 1];
+
+      rssi[j] = sample.rssi;
+    }
+
+    if (sample.rtt == WM_LINK_RTT_LOST)
+    {
+      stats.lost++;
+    }
+    else if (sample.rtt != WM_LINK_RTT_NONE)
+    {
+      uint8_t j = rttCount++;
+
+      for ( ; (j > 0) && (rtt[j - 1] > sample.rtt); j--)
+        rtt[j] = rtt[j - 1];
+
+      rtt[j] = sample.rtt;
+    }
+  }
+
+  stats.drops = _linkSamples[(first + _linkCount - 1) % WM_LINK_HISTORY].drops - _linkSamples[first].drops;
+
+  // Nearest rank
+  if (rssiCount)
+  {
+    stats.rssiP10 = rssi[(10 * rssiCount + 99) / 100 - 1];
+    stats.rssiP50 = rssi[(50 * rssiCount + 99) / 100 - 1];
+    stats.rssiP90 = rssi[(90 * rssiCount + 99) / 100 - 1];
+  }
+
+  if (rttCount)
+  {
+    stats.rttP50 = rtt[(50 * rttCount + 99) / 100 - 1];
+    stats.rttP90 = rtt[(90 * rttCount + 99) / 100 - 1];
+    stats.rttMax = rtt[rttCount - 1];
+  }
+
+  return stats;
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::startWPS()
+{
+  // The SSID comes from WPS
+  _connectSsidHash = 0;
+
+#ifdef ESP8266
+  LOGINFO("START WPS");
+  WiFi.beginWPSConfig();
+  LOGINFO("END WPS");
+#else   //ESP32
+  // TODO
+  LOGINFO("ESP32 WPS TODO");
+#endif
+}
+
+//////////////////////////////////////////
+
+#ifdef ESP8266
+
+// From the SDK WPS callback, WM_WPS_PENDING until WPS is over
+volatile int8_t wmWPSStatus = WM_WPS_PENDING;
+
+void wmWPSStatusCallback(int status)
+{
+  // As in the SDK example, connect with the credentials WPS has stored
+  if (status == WPS_CB_ST_SUCCESS)
+  {
+    wifi_wps_disable();
+    wifi_station_connect();
+  }
+
+  wmWPSStatus = status;
+}
+
+#endif
+
+//////////////////////////////////////////
+
+// Push button WPS, without waiting for it as WiFi.beginWPSConfig() does. Polled with wpsResult()
+bool ESP_WiFiManager::beginWPS()
+{
+  // The SSID comes from WPS
+  _connectSsidHash = 0;
+
+#ifdef ESP8266
+  LOGINFO("START WPS");
+
+  WiFi.disconnect();
+  wifi_wps_disable();
+
+  wmWPSStatus = WM_WPS_PENDING;
+
+  if (wifi_wps_enable(WPS_TYPE_PBC) && wifi_set_wps_cb(wmWPSStatusCallback) && wifi_wps_start())
+    return true;
+
+  LOGERROR(F("WPS start failed"));
+
+  wifi_wps_disable();
+#else   //ESP32
+  // TODO
+  LOGINFO("ESP32 WPS TODO");
+#endif
+
+  return false;
+}
+
+//////////////////////////////////////////
+
+int8_t ESP_WiFiManager::wpsResult()
+{
+#ifdef ESP8266
+  return wmWPSStatus;
+#else
+  return WM_WPS_PENDING;
+#endif
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::endWPS()
+{
+  _portalWPS = false;
+
+#ifdef ESP8266
+  wifi_wps_disable();
+#endif
+}
+
+//////////////////////////////////////////
+
+//Convenient for debugging but wasteful of program space.
+//Remove if short of space
+const char* ESP_WiFiManager::getStatus(const int& status)
+{
+  switch (status)
+  {
+    case WL_IDLE_STATUS:
+      return "WL_IDLE_STATUS";
+
+    case WL_NO_SSID_AVAIL:
+      return "WL_NO_SSID_AVAIL";
+
+    case WL_CONNECTED:
+      return "WL_CONNECTED";
+
+    case WL_CONNECT_FAILED:
+      return "WL_CONNECT_FAILED";
+
+    case WL_DISCONNECTED:
+      return "WL_DISCONNECTED";
+
+    default:
+      return "UNKNOWN";
+  }
+}
+
+//////////////////////////////////////////
+
+String ESP_WiFiManager::getConfigPortalSSID()
+{
+  return _apName;
+}
+
+//////////////////////////////////////////
+
+String ESP_WiFiManager::getConfigPortalPW()
+{
+  return _apPassword;
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::resetSettings()
+{
+  LOGINFO(F("Previous settings invalidated"));
+
+#ifdef ESP8266
+  WiFi.disconnect(true);
+#else
+  WiFi.disconnect(true, true);
+
+  // Temporary fix for issue of not clearing WiFi SSID/PW from flash of ESP32
+  // See https://github.com/khoih-prog/ESP_WiFiManager/issues/25 and https://github.com/espressif/arduino-esp32/issues/400
+  WiFi.begin("0", "0");
+  //////
+#endif
+
+  delay(200);
+
+  return;
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::setTimeout(const unsigned long& seconds)
+{
+  setConfigPortalTimeout(seconds);
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::setConfigPortalTimeout(const unsigned long& seconds)
+{
+  _configPortalTimeout = seconds * 1000;
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::setConnectTimeout(const unsigned long& seconds)
+{
+  _connectTimeout = seconds * 1000;
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::setScanCacheTTL(const unsigned long& seconds)
+{
+  _scanCacheTTL = seconds * 1000;
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::setDebugOutput(bool debug)
+{
+  _debug = debug;
+}
+
+//////////////////////////////////////////
+
+// KH, To enable dynamic/random channel
+int ESP_WiFiManager::setConfigPortalChannel(const int& channel)
+{
+  // If channel < MIN_WIFI_CHANNEL - 1 or channel > MAX_WIFI_CHANNEL => channel = 1
+  // If channel == 0 => will use random channel from MIN_WIFI_CHANNEL to MAX_WIFI_CHANNEL
+  // If (MIN_WIFI_CHANNEL <= channel <= MAX_WIFI_CHANNEL) => use it
+  if ( (channel < MIN_WIFI_CHANNEL - 1) || (channel > MAX_WIFI_CHANNEL) )
+    _WiFiAPChannel = 1;
+  else if ( (channel >= MIN_WIFI_CHANNEL - 1) && (channel <= MAX_WIFI_CHANNEL) )
+    _WiFiAPChannel = channel;
+
+  return _WiFiAPChannel;
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::setAPStaticIPConfig(const IPAddress& ip, const IPAddress& gw, const IPAddress& sn)
+{
+  LOGINFO(F("setAPStaticIPConfig"));
+  _WiFi_AP_IPconfig._ap_static_ip = ip;
+  _WiFi_AP_IPconfig._ap_static_gw = gw;
+  _WiFi_AP_IPconfig._ap_static_sn = sn;
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::setAPStaticIPConfig(const WiFi_AP_IPConfig&  WM_AP_IPconfig)
+{
+  LOGINFO(F("setAPStaticIPConfig"));
+
+  memcpy((void*) &_WiFi_AP_IPconfig, &WM_AP_IPconfig, sizeof(_WiFi_AP_IPconfig));
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::getAPStaticIPConfig(WiFi_AP_IPConfig  &WM_AP_IPconfig)
+{
+  LOGINFO(F("getAPStaticIPConfig"));
+
+  memcpy((void*) &WM_AP_IPconfig, &_WiFi_AP_IPconfig, sizeof(WM_AP_IPconfig));
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::setSTAStaticIPConfig(const IPAddress& ip, const IPAddress& gw, const IPAddress& sn)
+{
+  LOGINFO(F("setSTAStaticIPConfig"));
+  _WiFi_STA_IPconfig._sta_static_ip = ip;
+  _WiFi_STA_IPconfig._sta_static_gw = gw;
+  _WiFi_STA_IPconfig._sta_static_sn = sn;
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::setSTAStaticIPConfig(const WiFi_STA_IPConfig& WM_STA_IPconfig)
+{
+  LOGINFO(F("setSTAStaticIPConfig"));
+
+  memcpy((void*) &_WiFi_STA_IPconfig, &WM_STA_IPconfig, sizeof(_WiFi_STA_IPconfig));
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::getSTAStaticIPConfig(WiFi_STA_IPConfig &WM_STA_IPconfig)
+{
+  LOGINFO(F("getSTAStaticIPConfig"));
+
+  memcpy((void*) &WM_STA_IPconfig, &_WiFi_STA_IPconfig, sizeof(WM_STA_IPconfig));
+}
+
+//////////////////////////////////////////
+
+#if USE_CONFIGURABLE_DNS
+void ESP_WiFiManager::setSTAStaticIPConfig(const IPAddress& ip, const IPAddress& gw, const IPAddress& sn,
+                                           const IPAddress& dns_address_1, const IPAddress& dns_address_2)
+{
+  LOGINFO(F("setSTAStaticIPConfig for USE_CONFIGURABLE_DNS"));
+  _WiFi_STA_IPconfig._sta_static_ip = ip;
+  _WiFi_STA_IPconfig._sta_static_gw = gw;
+  _WiFi_STA_IPconfig._sta_static_sn = sn;
+  _WiFi_STA_IPconfig._sta_static_dns1 = dns_address_1; //***** Added argument *****
+  _WiFi_STA_IPconfig._sta_static_dns2 = dns_address_2; //***** Added argument *****
+}
+#endif
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::setMinimumSignalQuality(const int& quality)
+{
+  _minimumQuality = quality;
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::setBreakAfterConfig(bool shouldBreak)
+{
+  _shouldBreakAfterConfig = shouldBreak;
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::setTryWPS(const bool& tryWPS)
+{
+  _tryWPS = tryWPS;
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::pageBegin(const char* contentType, const int& code)
+{
+  _pageLen = 0;
+
+#if USE_CHUNKED_CP_PAGES
+  // Send status line and headers now. Content will follow in chunks
+  server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server->send(code, contentType, "");
+#else
+  _page             = "";
+  _pageContentType  = contentType;
+  _pageCode         = code;
+#endif
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::pageAdd(const char* content, const size_t& len)
+{
+  size_t remaining = len;
+
+  while (remaining > 0)
+  {
+    if (_pageLen == WM_PAGE_CHUNK_SIZE)
+    {
+      pageFlush();
+    }
+
+    size_t count = std::min(remaining, (size_t) (WM_PAGE_CHUNK_SIZE - _pageLen));
+
+    memcpy(_pageBuf.get() + _pageLen, content, count);
+
+    _pageLen  += count;
+    content   += count;
+    remaining -= count;
+  }
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::pageAdd(const char* content)
+{
+  if (content != NULL)
+  {
+    pageAdd(content, strlen(content));
+  }
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::pageAdd(const String& content)
+{
+  pageAdd(content.c_str(), content.length());
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::pageAdd(const __FlashStringHelper* content)
+{
+  PGM_P p = reinterpret_cast<PGM_P>(content);
+
+  pageAdd_P(p, strlen_P(p));
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::pageAdd_P(PGM_P content, size_t len)
+{
+  while (len > 0)
+  {
+    if (_pageLen == WM_PAGE_CHUNK_SIZE)
+    {
+      pageFlush();
+    }
+
+    size_t count = std::min(len, (size_t) (WM_PAGE_CHUNK_SIZE - _pageLen));
+
+    memcpy_P(_pageBuf.get() + _pageLen, content, count);
+
+    _pageLen  += count;
+    content   += count;
+    len       -= count;
+  }
+}
+
+//////////////////////////////////////////
+
+// One linear pass over the segments split at compile time. tokens[] are the substitution values,
+// indexed by WM_Token. NULL values are rendered as empty
+void ESP_WiFiManager::pageAddTemplate(PGM_P tpl, const WM_TemplateSeg* segs, const uint8_t& segCount,
+                                      const char* const tokens[WM_TOKEN_COUNT])
+{
+  WM_TemplateSeg seg;
+
+  for (uint8_t i = 0; i < segCount; i++)
+  {
+    memcpy_P(&seg, &segs[i], sizeof(seg));
+
+    pageAdd_P(tpl + seg.start, seg.len);
+
+    if (seg.token < WM_TOKEN_COUNT)
+    {
+      pageAdd(tokens[seg.token]);
+    }
+  }
+}
+
+//////////////////////////////////////////
+
+// Static IP row, rendered from WM_HTTP_FORM_LABEL + WM_HTTP_FORM_PARAM
+void ESP_WiFiManager::pageAddIPItem(const char* id, const char* placeholder, const IPAddress& ip)
+{
+  String value = ip.toString();
+
+  const char* tokens[WM_TOKEN_COUNT] = { NULL };
+
+  tokens[WM_TOKEN_I] = id;
+  tokens[WM_TOKEN_N] = id;
+  tokens[WM_TOKEN_P] = placeholder;
+  tokens[WM_TOKEN_L] = "15";
+  tokens[WM_TOKEN_V] = value.c_str();
+
+  pageAddTemplate(WM_TEMPLATE(WM_HTTP_FORM_LABEL), tokens);
+  pageAddTemplate(WM_TEMPLATE(WM_HTTP_FORM_PARAM), tokens);
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::pageHead(const char* title)
+{
+  const char* tokens[WM_TOKEN_COUNT] = { NULL };
+
+  tokens[WM_TOKEN_V] = title;
+
+  pageAddTemplate(WM_TEMPLATE(WM_HTTP_HEAD_START), tokens);
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::pageFlush()
+{
+  if (_pageLen == 0)
+    return;
+
+#if USE_CHUNKED_CP_PAGES
+  // sendContent_P() also accepts RAM buffer, and is available in all supported cores
+  server->sendContent_P(_pageBuf.get(), _pageLen);
+#else
+  _pageBuf[_pageLen] = 0;
+  _page += _pageBuf.get();
+#endif
+
+  _pageLen = 0;
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::pageEnd()
+{
+  pageFlush();
+
+#if !USE_CHUNKED_CP_PAGES
+  server->send(_pageCode, _pageContentType, _page);
+
+  // Free the page now, not when next page is built
+  _page = String();
+#endif
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::reportStatus()
+{
+  pageAdd(FPSTR(WM_HTTP_SCRIPT_NTP_MSG));
+
+  if (WiFi_SSID() != "")
+  {
+    pageAdd(F("Configured to connect to access point <b>"));
+    pageAdd(WiFi_SSID());
+
+    if (WiFi.status() == WL_CONNECTED)
+    {
+      pageAdd(F(" and currently connected</b> on IP <a href=\"http://"));
+      pageAdd(WiFi.localIP().toString());
+      pageAdd(F("/\">"));
+      pageAdd(WiFi.localIP().toString());
+      pageAdd(F("</a>"));
+    }
+    else
+    {
+      pageAdd(F(" but not currently connected</b> to network."));
+    }
+  }
+  else
+  {
+    pageAdd(F("No network currently configured."));
+  }
+}
+
+//////////////////////////////////////////
+
+/** Handle root or redirect to captive portal */
+void ESP_WiFiManager::handleRoot()
+{
+  LOGDEBUG(F("Handle root"));
+
+  // Disable _configPortalTimeout when someone accessing Portal to give some time to config
+  _configPortalTimeout = 0;   //KH
+
+  if (captivePortal())
+  {
+    // If caprive portal redirect instead of displaying the error page.
+    return;
+  }
+
+#if USING_CORS_FEATURE
+  // For configure CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
+  server->sendHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
+#endif
+
+  if (notModified())
+  {
+    return;
+  }
+
+  pageBegin();
+
+  pageHead("Options");
+  pageAdd(FPSTR(WM_HTTP_HEAD_ASSETS));
+  pageAdd(FPSTR(WM_HTTP_SCRIPT_NTP));
+  pageAdd(_customHeadElement);
+  pageAdd(FPSTR(WM_HTTP_HEAD_END));
+  pageAdd("<h2>");
+  pageAdd(_apName);
+
+  if (WiFi_SSID() != "")
+  {
+    if (WiFi.status() == WL_CONNECTED)
+    {
+      pageAdd(" on ");
+      pageAdd(WiFi_SSID());
+    }
+    else
+    {
+      pageAdd(" <s>on ");
+      pageAdd(WiFi_SSID());
+      pageAdd("</s>");
+    }
+  }
+
+  pageAdd("</h2>");
+  pageAdd(FPSTR(WM_HTTP_PORTAL_OPTIONS));
+  pageAdd(F("<div class=\"msg\">"));
+  reportStatus();
+  pageAdd(F("</div>"));
+  pageAdd(FPSTR(WM_HTTP_END));
+
+  pageEnd();
+}
+
+//////////////////////////////////////////
+
+/** Wifi config page handler */
+void ESP_WiFiManager::handleWifi()
+{
+  LOGDEBUG(F("Handle WiFi"));
+
+  // Disable _configPortalTimeout when someone accessing Portal to give some time to config
+  _configPortalTimeout = 0;   //KH
+
+#if USING_CORS_FEATURE
+  // For configure CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
+  server->sendHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
+#endif
+
+  sendNoStoreHeaders();
+
+  // Rendered from the last background scan, a new one is started after the response if needed
+  requestScan(server->arg("refresh") == "1");
+
+  pageBegin();
+
+  pageHead("Config ESP");
+  pageAdd(FPSTR(WM_HTTP_HEAD_ASSETS));
+  pageAdd(FPSTR(WM_HTTP_SCRIPT_NTP));
+  pageAdd(_customHeadElement);
+  pageAdd(FPSTR(WM_HTTP_HEAD_END));
+  pageAdd(F("<h2>Configuration</h2>"));
+
+  //Print list of WiFi networks that were found in earlier scan
+  if (_scanCount == 0)
+  {
+    if (_scanRunning || _scanWanted)
+      pageAdd(F("Scanning. Refresh in a few seconds."));
+    else
+      pageAdd(F("No network found. <a href='/wifi?refresh=1'>Scan again</a>"));
+  }
+  else
+  {
+    pageAdd(FPSTR(WM_FLDSET_START));
+
+    //display networks in page
+    for (int i = 0; i < _scanCount; i++)
+    {
+      const WM_ScanResult& result = _scanResults[i];
+
+      const char* ssid = result.ssid;
+
+      LOGDEBUG1(F("Index ="), i);
+      LOGDEBUG1(F("SSID ="), ssid);
+      LOGDEBUG1(F("RSSI ="), result.rssi);
+
+      char rssiQ[8];
+
+      snprintf(rssiQ, sizeof(rssiQ), "%d", getRSSIasQuality(result.rssi));
+
+      const char* tokens[WM_TOKEN_COUNT] = { NULL };
+
+      tokens[WM_TOKEN_V] = ssid;
+      tokens[WM_TOKEN_R] = rssiQ;
+
+      char apCount[32];
+
+      if (result.apCount > 1)
+      {
+        snprintf_P(apCount, sizeof(apCount), WM_HTTP_ITEM_APS, result.apCount);
+        tokens[WM_TOKEN_A] = apCount;
+      }
+
+#ifdef ESP8266
+
+      if (result.encryption != ENC_TYPE_NONE)
+#else   //ESP32
+      if (result.encryption != WIFI_AUTH_OPEN)
+#endif
+      {
+        tokens[WM_TOKEN_I] = "l";
+      }
+
+      pageAddTemplate(WM_TEMPLATE(WM_HTTP_ITEM), tokens);
+      delay(0);
+    }
+
+    pageAdd(FPSTR(WM_FLDSET_END));
+
+    char scanAge[96];
+
+    snprintf_P(scanAge, sizeof(scanAge), WM_HTTP_SCAN_AGE, (millis() - _scanTime) / 1000);
+    pageAdd(scanAge);
+
+    pageAdd("<br/>");
+  }
+
+  pageAdd("<small>*Hint: To reuse the saved WiFi credentials, leave SSID and PWD fields empty</small>");
+
+#if DISPLAY_STORED_CREDENTIALS_IN_CP
+  // Populate SSIDs and PWDs if valid
+  const char* credTokens[WM_TOKEN_COUNT] = { NULL };
+
+  credTokens[WM_TOKEN_X]  = _credentials[0].ssid.c_str();
+  credTokens[WM_TOKEN_W]  = _credentials[0].pass.c_str();
+  credTokens[WM_TOKEN_X1] = _credentials[1].ssid.c_str();
+  credTokens[WM_TOKEN_W1] = _credentials[1].pass.c_str();
+
+  pageAddTemplate(WM_TEMPLATE(WM_HTTP_FORM_START), credTokens);
+#else
+  pageAdd(FPSTR(WM_HTTP_FORM_START));
+#endif
+
+  char parLength[12];
+
+  pageAdd(FPSTR(WM_FLDSET_START));
+
+  // add the extra parameters to the form
+  for (int i = 0; i < _paramsCount; i++)
+  {
+    if (_params[i] == NULL)
+    {
+      break;
+    }
+
+    if (_params[i]->getID() == NULL)
+    {
+      pageAdd(_params[i]->getCustomHTML());
+
+      continue;
+    }
+
+    const char* tokens[WM_TOKEN_COUNT] = { NULL };
+
+    snprintf(parLength, sizeof(parLength), "%d", _params[i]->getValueLength());
+
+    tokens[WM_TOKEN_I] = _params[i]->getID();
+    tokens[WM_TOKEN_N] = _params[i]->getID();
+    tokens[WM_TOKEN_P] = _params[i]->getPlaceholder();
+    tokens[WM_TOKEN_L] = parLength;
+    tokens[WM_TOKEN_V] = _params[i]->getValue();
+    tokens[WM_TOKEN_C] = _params[i]->getCustomHTML();
+
+    switch (_params[i]->getLabelPlacement())
+    {
+      case WFM_LABEL_BEFORE:
+        pageAddTemplate(WM_TEMPLATE(WM_HTTP_FORM_LABEL_BEFORE), tokens);
+        break;
+
+      case WFM_LABEL_AFTER:
+        pageAddTemplate(WM_TEMPLATE(WM_HTTP_FORM_LABEL_AFTER), tokens);
+        break;
+
+      default:
+        // WFM_NO_LABEL
+        pageAddTemplate(WM_TEMPLATE(WM_HTTP_FORM_PARAM), tokens);
+        break;
+    }
+  }
+
+  if (_paramsCount > 0)
+  {
+    pageAdd(FPSTR(WM_FLDSET_END));
+  }
+
+  if (_params[0] != NULL)
+  {
+    pageAdd("<br/>");
+  }
+
+  LOGDEBUG1(F("Static IP ="), _WiFi_STA_IPconfig._sta_static_ip.toString());
+
+  // KH, Comment out to permit changing from DHCP to static IP, or vice versa
+  // and add staticIP label in CP
+
+  // To permit disable/enable StaticIP configuration in Config Portal from sketch. Valid only if DHCP is used.
+  // You'll loose the feature of dynamically changing from DHCP to static IP, or vice versa
+  // You have to explicitly specify false to disable the feature.
+
+#if !USE_STATIC_IP_CONFIG_IN_CP
+
+  if (_WiFi_STA_IPconfig._sta_static_ip)
+#endif
+  {
+    pageAdd(FPSTR(WM_FLDSET_START));
+
+    pageAddIPItem("ip", "Static IP",  _WiFi_STA_IPconfig._sta_static_ip);
+    pageAddIPItem("gw", "Gateway IP", _WiFi_STA_IPconfig._sta_static_gw);
+    pageAddIPItem("sn", "Subnet",     _WiFi_STA_IPconfig._sta_static_sn);
+
+#if USE_CONFIGURABLE_DNS
+    //***** Added for DNS address options *****
+    pageAddIPItem("dns1", "DNS1 IP",  _WiFi_STA_IPconfig._sta_static_dns1);
+    pageAddIPItem("dns2", "DNS2 IP",  _WiFi_STA_IPconfig._sta_static_dns2);
+    //***** End added for DNS address options *****
+#endif
+
+    pageAdd(FPSTR(WM_FLDSET_END));
+
+    pageAdd("<br/>");
+  }
+
+  pageAdd(FPSTR(WM_HTTP_SCRIPT_NTP_HIDDEN));
+
+  pageAdd(FPSTR(WM_HTTP_FORM_END));
+
+  pageAdd(FPSTR(WM_HTTP_END));
+
+  pageEnd();
+
+  LOGDEBUG(F("Sent config page"));
+}
+
+
+//////////////////////////////////////////
+
+/** Handle the WLAN save form and redirect to WLAN config page again */
+void ESP_WiFiManager::handleWifiSave()
+{
+  LOGDEBUG(F("WiFi save"));
+
+  // All args are copied and indexed once, then read as views
+  _args->load(*server);
+
+  //SAVE/connect here
+  setCredential(0, _args->value("s"), _args->value("p"));
+  setCredential(1, _args->value("s1"), _args->value("p1"));
+
+  // Where the new networks were scanned, if they were
+  if (_scanResults)
+    updateKnownAPs(_scanResults, _scanCount);
+
+  ///////////////////////
+
+#if USING_CORS_FEATURE
+  // For configuring CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
+  server->sendHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
+#endif
+
+#if USE_ESP_WIFIMANAGER_NTP
+
+  if (*_args->value("timezone"))
+  {
+    _timezoneName = _args->value("timezone");
+    LOGDEBUG1(F("TZ name ="), _timezoneName);
+  }
+  else
+  {
+    LOGDEBUG(F("No TZ arg"));
+  }
+
+#endif
+  ///////////////////////
+
+  //parameters
+  for (int i = 0; i < _paramsCount; i++)
+  {
+    if (_params[i] == NULL)
+    {
+      break;
+    }
+
+    //read parameter and store it in array. From the server if it didn't fit in the store
+    if (_args->has(_params[i]->getID()))
+    {
+      _args->copy(_params[i]->getID(), _params[i]->_WMParam_data._value, _params[i]->_WMParam_data._length);
+    }
+    else
+    {
+      server->arg(_params[i]->getID()).toCharArray(_params[i]->_WMParam_data._value, _params[i]->_WMParam_data._length);
+    }
+
+    LOGDEBUG2(F("Parameter and value :"), _params[i]->getID(), _params[i]->_WMParam_data._value);
+  }
+
+  if (*_args->value("ip"))
+  {
+    optionalIPFromString(&_WiFi_STA_IPconfig._sta_static_ip, _args->value("ip"));
+
+    LOGDEBUG1(F("New Static IP ="), _WiFi_STA_IPconfig._sta_static_ip.toString());
+  }
+
+  if (*_args->value("gw"))
+  {
+    optionalIPFromString(&_WiFi_STA_IPconfig._sta_static_gw, _args->value("gw"));
+
+    LOGDEBUG1(F("New Static Gateway ="), _WiFi_STA_IPconfig._sta_static_gw.toString());
+  }
+
+  if (*_args->value("sn"))
+  {
+    optionalIPFromString(&_WiFi_STA_IPconfig._sta_static_sn, _args->value("sn"));
+
+    LOGDEBUG1(F("New Static Netmask ="), _WiFi_STA_IPconfig._sta_static_sn.toString());
+  }
+
+#if USE_CONFIGURABLE_DNS
+
+  //*****  Added for DNS Options *****
+  if (*_args->value("dns1"))
+  {
+    optionalIPFromString(&_WiFi_STA_IPconfig._sta_static_dns1, _args->value("dns1"));
+
+    LOGDEBUG1(F("New Static DNS1 ="), _WiFi_STA_IPconfig._sta_static_dns1.toString());
+  }
+
+  if (*_args->value("dns2"))
+  {
+    optionalIPFromString(&_WiFi_STA_IPconfig._sta_static_dns2, _args->value("dns2"));
+
+    LOGDEBUG1(F("New Static DNS2 ="), _WiFi_STA_IPconfig._sta_static_dns2.toString());
+  }
+
+  //*****  End added for DNS Options *****
+#endif
+
+  // Credentials and parameters have changed
+  bumpContentVersion();
+
+  pageBegin();
+
+  pageHead("Credentials Saved");
+  pageAdd(FPSTR(WM_HTTP_HEAD_ASSETS));
+  pageAdd(_customHeadElement);
+  pageAdd(FPSTR(WM_HTTP_HEAD_END));
+
+  const char* tokens[WM_TOKEN_COUNT] = { NULL };
+
+  tokens[WM_TOKEN_V]  = _apName;
+  tokens[WM_TOKEN_X]  = _credentials[0].ssid.c_str();
+  tokens[WM_TOKEN_X1] = _credentials[1].ssid.c_str();
+
+  pageAddTemplate(WM_TEMPLATE(WM_HTTP_SAVED), tokens);
+
+  pageAdd(FPSTR(WM_HTTP_END));
+
+  pageEnd();
+
+  LOGDEBUG(F("Sent wifi save page"));
+
+  connect = true; //signal ready to connect/reset
+
+  // Restore when Press Save WiFi
+  _configPortalTimeout = DEFAULT_PORTAL_TIMEOUT;
+}
+
+//////////////////////////////////////////
+
+/** Handle shut down the server page */
+void ESP_WiFiManager::handleServerClose()
+{
+  LOGDEBUG(F("Server Close"));
+
+#if USING_CORS_FEATURE
+  // For configuring CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
+  server->sendHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
+#endif
+
+  sendNoStoreHeaders();
+
+  pageBegin();
+
+  pageHead("Close Server");
+  pageAdd(FPSTR(WM_HTTP_HEAD_ASSETS));
+  pageAdd(_customHeadElement);
+  pageAdd(FPSTR(WM_HTTP_HEAD_END));
+  pageAdd(F("<div class=\"msg\">"));
+  pageAdd(F("My network is <b>"));
+  pageAdd(WiFi_SSID());
+  pageAdd(F("</b><br>"));
+  pageAdd(F("IP address is <b>"));
+  pageAdd(WiFi.localIP().toString());
+  pageAdd(F("</b><br><br>"));
+  pageAdd(F("Portal closed...<br><br>"));
+
+  //pageAdd(F("Push button on device to restart configuration server!"));
+
+  pageAdd(FPSTR(WM_HTTP_END));
+
+  pageEnd();
+
+  stopConfigPortal(); //signal ready to shutdown config portal
+
+  LOGDEBUG(F("Sent server close page"));
+
+  // Restore when Press Save WiFi
+  _configPortalTimeout = DEFAULT_PORTAL_TIMEOUT;
+}
+
+//////////////////////////////////////////
+
+/** Handle the info page */
+void ESP_WiFiManager::handleInfo()
+{
+  LOGDEBUG(F("Info"));
+
+  // Disable _configPortalTimeout when someone accessing Portal to give some time to config
+  _configPortalTimeout = 0;   //KH
+
+#if USING_CORS_FEATURE
+  // For configuring CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
+  server->sendHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
+#endif
+
+  if (notModified())
+  {
+    return;
+  }
+
+  pageBegin();
+
+  pageHead("Info");
+  pageAdd(FPSTR(WM_HTTP_HEAD_ASSETS));
+  pageAdd(FPSTR(WM_HTTP_SCRIPT_NTP));
+  pageAdd(_customHeadElement);
+  pageAdd(FPSTR(WM_HTTP_HEAD_END));
+
+  pageAdd(F("<h2>WiFi Information</h2>"));
+
+  reportStatus();
+
+  pageAdd(FPSTR(WM_FLDSET_START));
+
+  pageAdd(F("<h3>Device Data</h3>"));
+  pageAdd(F("<table class=\"table\">"));
+  pageAdd(F("<thead><tr><th>Name</th><th>Value</th></tr></thead><tbody><tr><td>Chip ID</td><td>"));
+
+  pageAdd(F("0x"));
+#ifdef ESP8266
+  pageAdd(String(ESP.getChipId(), HEX));   //ESP.getChipId();
+#else   //ESP32
+
+  pageAdd(String(ESP_getChipId(), HEX));   //ESP.getChipId();
+
+  pageAdd(F("</td></tr>"));
+  pageAdd(F("<tr><td>Chip OUI</td><td>"));
+  pageAdd(F("0x"));
+  pageAdd(String(getChipOUI(), HEX));    //ESP.getChipId();
+
+  pageAdd(F("</td></tr>"));
+  pageAdd(F("<tr><td>Chip Model</td><td>"));
+  pageAdd(ESP.getChipModel());
+  pageAdd(F(" Rev"));
+  pageAdd(String(ESP.getChipRevision()));
+#endif
+
+  pageAdd(F("</td></tr>"));
+  pageAdd(F("<tr><td>Flash Chip ID</td><td>"));
+
+#ifdef ESP8266
+  pageAdd(String(ESP.getFlashChipId(), HEX));    //ESP.getFlashChipId();
+#else   //ESP32
+  // TODO
+  pageAdd(F("TODO"));
+#endif
+
+  pageAdd(F("</td></tr>"));
+  pageAdd(F("<tr><td>IDE Flash Size</td><td>"));
+  pageAdd(String(ESP.getFlashChipSize()));
+  pageAdd(F(" bytes</td></tr>"));
+  pageAdd(F("<tr><td>Real Flash Size</td><td>"));
+
+#ifdef ESP8266
+  pageAdd(String(ESP.getFlashChipRealSize()));
+#else   //ESP32
+  // TODO
+  pageAdd(F("TODO"));
+#endif
+
+  pageAdd(F(" bytes</td></tr>"));
+  pageAdd(F("<tr><td>Access Point IP</td><td>"));
+  pageAdd(WiFi.softAPIP().toString());
+  pageAdd(F("</td></tr>"));
+  pageAdd(F("<tr><td>Access Point MAC</td><td>"));
+  pageAdd(WiFi.softAPmacAddress());
+  pageAdd(F("</td></tr>"));
+
+  pageAdd(F("<tr><td>SSID</td><td>"));
+  pageAdd(WiFi_SSID());
+  pageAdd(F("</td></tr>"));
+
+  pageAdd(F("<tr><td>Station IP</td><td>"));
+  pageAdd(WiFi.localIP().toString());
+  pageAdd(F("</td></tr>"));
+
+  pageAdd(F("<tr><td>Station MAC</td><td>"));
+  pageAdd(WiFi.macAddress());
+  pageAdd(F("</td></tr>"));
+  pageAdd(F("</tbody></table>"));
+
+  pageAdd(FPSTR(WM_FLDSET_END));
+
+#if USE_AVAILABLE_PAGES
+  pageAdd(FPSTR(WM_FLDSET_START));
+
+  pageAdd(FPSTR(WM_HTTP_AVAILABLE_PAGES));
+
+  pageAdd(FPSTR(WM_FLDSET_END));
+#endif
+
+  pageAdd(F("<p/>More information about ESP_WiFiManager at"));
+  pageAdd(F("<p/><a href=\"https://github.com/khoih-prog/ESP_WiFiManager\">https://github.com/khoih-prog/ESP_WiFiManager</a>"));
+  pageAdd(FPSTR(WM_HTTP_END));
+
+  pageEnd();
+
+  LOGDEBUG(F("Sent info page"));
+}
+
+//////////////////////////////////////////
+
+/** Handle the state page */
+void ESP_WiFiManager::handleState()
+{
+  LOGDEBUG(F("State - json"));
+
+#if USING_CORS_FEATURE
+  // For configuring CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
+  server->sendHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
+#endif
+
+  if (notModified())
+  {
+    return;
+  }
+
+  pageBegin("application/json");
+
+  pageAdd(F("{\"Soft_AP_IP\":\""));
+  pageAdd(WiFi.softAPIP().toString());
+  pageAdd(F("\",\"Soft_AP_MAC\":\""));
+  pageAdd(WiFi.softAPmacAddress());
+  pageAdd(F("\",\"Station_IP\":\""));
+  pageAdd(WiFi.localIP().toString());
+  pageAdd(F("\",\"Station_MAC\":\""));
+  pageAdd(WiFi.macAddress());
+  pageAdd(F("\","));
+
+  if (WiFi.psk() != "")
+  {
+    pageAdd(F("\"Password\":true,"));
+  }
+  else
+  {
+    pageAdd(F("\"Password\":false,"));
+  }
 
-      LOGDEBUG1(F("Index ="), i);
-      LOGDEBUG1(F("SSID ="), WiFi.SSID(networkIndices[i]));
-      LOGDEBUG1(F("RSSI ="), WiFi.RSSI(networkIndices[i]));
+  pageAdd(F("\"SSID\":\""));
+  pageAdd(WiFi_SSID());
+  pageAdd(F("\"}"));
 
-      int quality = getRSSIasQuality(WiFi.RSSI(networkIndices[i]));
+  pageEnd();
 
-      String item = FPSTR(WM_HTTP_ITEM);
-      String rssiQ;
-      rssiQ += quality;
-      item.replace("{v}", WiFi.SSID(networkIndices[i]));
-      item.replace("{r}", rssiQ);
+  LOGDEBUG(F("Sent state page in json format"));
+}
 
-#ifdef ESP8266
+//////////////////////////////////////////
 
-      if (WiFi.encryptionType(networkIndices[i]) != ENC_TYPE_NONE)
-#else   //ESP32
-      if (WiFi.encryptionType(networkIndices[i]) != WIFI_AUTH_OPEN)
-#endif
-      {
-        item.replace("{i}", "l");
-      }
-      else
-      {
-        item.replace("{i}", "");
-      }
+/** Handle the status page */
+// Waiting, Connecting, Connected or Failed, for the credentials last saved. Idle before
+void ESP_WiFiManager::handleStatus()
+{
+  LOGDEBUG(F("Status - json"));
 
-      //LOGDEBUG(item);
+#if USING_CORS_FEATURE
+  // For configuring CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
+  server->sendHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
+#endif
 
-      page += item;
-      delay(0);
-    }
+  sendNoStoreHeaders();
 
-    page += FPSTR(WM_FLDSET_END);
+  const char* state   = "Idle";
+  String      ip;
 
-    page += "<br/>";
+  if (_portalConnectResult == WL_CONNECTED)
+  {
+    state = "Connected";
+    ip    = WiFi.localIP().toString();
+  }
+  else if (_portalConnectResult != WL_IDLE_STATUS)
+  {
+    state = "Failed";
+  }
+  else if (_portalStatus == WM_PORTAL_CONNECTING)
+  {
+    state = _portalConnectBegun ? "Connecting" : "Waiting";
   }
 
-  page += "<small>*Hint: To reuse the saved WiFi credentials, leave SSID and PWD fields empty</small>";
+  pageBegin("application/json");
 
-  page += FPSTR(WM_HTTP_FORM_START);
+  const char* tokens[WM_TOKEN_COUNT] = { NULL };
 
-#if DISPLAY_STORED_CREDENTIALS_IN_CP
-  // Populate SSIDs and PWDs if valid
-  page.replace("[[ssid]]",  _ssid );
-  page.replace("[[pwd]]",   _pass );
-  page.replace("[[ssid1]]", _ssid1 );
-  page.replace("[[pwd1]]",  _pass1 );
-#endif
+  tokens[WM_TOKEN_V] = state;
+  tokens[WM_TOKEN_X] = _credentials[0].ssid.c_str();
+  tokens[WM_TOKEN_R] = getStatus(_portalConnectResult);
+  tokens[WM_TOKEN_I] = ip.c_str();
 
-  char parLength[2];
+  pageAddTemplate(WM_TEMPLATE(JSON_STATUS), tokens);
 
-  page += FPSTR(WM_FLDSET_START);
+  pageEnd();
+}
 
-  // add the extra parameters to the form
-  for (int i = 0; i < _paramsCount; i++)
-  {
-    if (_params[i] == NULL)
-    {
-      break;
-    }
+//////////////////////////////////////////
 
-    String pitem;
+class WM_PagePrint : public Print
+{
+  public:
+    WM_PagePrint(ESP_WiFiManager& wm) : _wm(wm) {}
 
-    switch (_params[i]->getLabelPlacement())
+    size_t write(uint8_t c) override
     {
-      case WFM_LABEL_BEFORE:
-        pitem = FPSTR(WM_HTTP_FORM_LABEL_BEFORE);
-        break;
-
-      case WFM_LABEL_AFTER:
-        pitem = FPSTR(WM_HTTP_FORM_LABEL_AFTER);
-        break;
+      _wm.pageAdd((const char*) &c, 1);
 
-      default:
-        // WFM_NO_LABEL
-        pitem = FPSTR(WM_HTTP_FORM_PARAM);
-        break;
+      return 1;
     }
 
-    if (_params[i]->getID() != NULL)
-    {
-      pitem.replace("{i}", _params[i]->getID());
-      pitem.replace("{n}", _params[i]->getID());
-      pitem.replace("{p}", _params[i]->getPlaceholder());
-      snprintf(parLength, 2, "%d", _params[i]->getValueLength());
-      pitem.replace("{l}", parLength);
-      pitem.replace("{v}", _params[i]->getValue());
-      pitem.replace("{c}", _params[i]->getCustomHTML());
-    }
-    else
+    size_t write(const uint8_t* buffer, size_t size) override
     {
-      pitem = _params[i]->getCustomHTML();
+      _wm.pageAdd((const char*) buffer, size);
+
+      return size;
     }
 
-    page += pitem;
-  }
+  private:
+    ESP_WiFiManager& _wm;
+};
 
-  if (_paramsCount > 0)
-  {
-    page += FPSTR(WM_FLDSET_END);
-  }
+//////////////////////////////////////////
 
-  if (_params[0] != NULL)
-  {
-    page += "<br/>";
-  }
+/** Handle the metrics page */
+void ESP_WiFiManager::handleMetrics()
+{
+  LOGDEBUG(F("Metrics"));
 
-  LOGDEBUG1(F("Static IP ="), _WiFi_STA_IPconfig._sta_static_ip.toString());
+#if USING_CORS_FEATURE
+  // For configuring CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
+  server->sendHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
+#endif
 
-  // KH, Comment out to permit changing from DHCP to static IP, or vice versa
-  // and add staticIP label in CP
+  sendNoStoreHeaders();
 
-  // To permit disable/enable StaticIP configuration in Config Portal from sketch. Valid only if DHCP is used.
-  // You'll loose the feature of dynamically changing from DHCP to static IP, or vice versa
-  // You have to explicitly specify false to disable the feature.
+  pageBegin("text/plain; version=0.0.4");
 
-#if !USE_STATIC_IP_CONFIG_IN_CP
+  WM_PagePrint page(*this);
 
-  if (_WiFi_STA_IPconfig._sta_static_ip)
-#endif
-  {
-    page += FPSTR(WM_FLDSET_START);
+  printConnectMetrics(page);
 
-    String item = FPSTR(WM_HTTP_FORM_LABEL);
-    item += FPSTR(WM_HTTP_FORM_PARAM);
-    item.replace("{i}", "ip");
-    item.replace("{n}", "ip");
-    item.replace("{p}", "Static IP");
-    item.replace("{l}", "15");
-    item.replace("{v}", _WiFi_STA_IPconfig._sta_static_ip.toString());
+  pageEnd();
+}
 
-    page += item;
+//////////////////////////////////////////
 
-    item = FPSTR(WM_HTTP_FORM_LABEL);
-    item += FPSTR(WM_HTTP_FORM_PARAM);
-    item.replace("{i}", "gw");
-    item.replace("{n}", "gw");
-    item.replace("{p}", "Gateway IP");
-    item.replace("{l}", "15");
-    item.replace("{v}", _WiFi_STA_IPconfig._sta_static_gw.toString());
+/** Handle the link-quality page */
+// RTT in ms, -1 if the echo was not answered, null if none was sent. History oldest first, Age in ms
+void ESP_WiFiManager::handleLink()
+{
+  LOGDEBUG(F("Link - json"));
 
-    page += item;
+#if USING_CORS_FEATURE
+  // For configuring CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
+  server->sendHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
+#endif
 
-    item = FPSTR(WM_HTTP_FORM_LABEL);
-    item += FPSTR(WM_HTTP_FORM_PARAM);
-    item.replace("{i}", "sn");
-    item.replace("{n}", "sn");
-    item.replace("{p}", "Subnet");
-    item.replace("{l}", "15");
-    item.replace("{v}", _WiFi_STA_IPconfig._sta_static_sn.toString());
+  sendNoStoreHeaders();
 
-#if USE_CONFIGURABLE_DNS
-    //***** Added for DNS address options *****
-    page += item;
-
-    item = FPSTR(WM_HTTP_FORM_LABEL);
-    item += FPSTR(WM_HTTP_FORM_PARAM);
-    item.replace("{i}", "dns1");
-    item.replace("{n}", "dns1");
-    item.replace("{p}", "DNS1 IP");
-    item.replace("{l}", "15");
-    item.replace("{v}", _WiFi_STA_IPconfig._sta_static_dns1.toString());
-
-    page += item;
-
-    item = FPSTR(WM_HTTP_FORM_LABEL);
-    item += FPSTR(WM_HTTP_FORM_PARAM);
-    item.replace("{i}", "dns2");
-    item.replace("{n}", "dns2");
-    item.replace("{p}", "DNS2 IP");
-    item.replace("{l}", "15");
-    item.replace("{v}", _WiFi_STA_IPconfig._sta_static_dns2.toString());
-    //***** End added for DNS address options *****
-#endif
+  pageBegin("application/json");
 
-    page += item;
+  WM_LinkStats  stats = getLinkStats();
+  char          line[192];
+  char          rtt[3][8];
+  uint16_t      rttStats[3] = { stats.rttP50, stats.rttP90, stats.rttMax };
 
-    page += FPSTR(WM_FLDSET_END);
+  for (uint8_t i = 0; i < 3; i++)
+    linkRttJson(rtt[i], sizeof(rtt[i]), rttStats[i]);
 
-    page += "<br/>";
-  }
+  int len = snprintf_P(line, sizeof(line), WM_LINK_JSON_HEAD, stats.samples, _linkInterval, stats.lost, stats.drops,
+                       stats.rssiP10, stats.rssiP50, stats.rssiP90, rtt[0], rtt[1], rtt[2]);
+  pageAdd(line, len);
 
-  page += FPSTR(WM_HTTP_SCRIPT_NTP_HIDDEN);
+  uint8_t first = (_linkNext + WM_LINK_HISTORY - _linkCount) % WM_LINK_HISTORY;
 
-  page += FPSTR(WM_HTTP_FORM_END);
+  for (uint8_t i = 0; i < _linkCount; i++)
+  {
+    const WM_LinkSample& sample = _linkSamples[(first + i) % WM_LINK_HISTORY];
+
+    linkRttJson(rtt[0], sizeof(rtt[0]), sample.rtt);
 
-  page += FPSTR(WM_HTTP_END);
+    len = snprintf_P(line, sizeof(line), WM_LINK_JSON_SAMPLE, i ? "," : "", millis() - sample.time, sample.rssi,
+                     rtt[0], sample.drops);
+    pageAdd(line, len);
+  }
 
-  server->send(200, "text/html", page);
+  pageAdd(F("]}"));
 
-  LOGDEBUG(F("Sent config page"));
+  pageEnd();
 }
 
 //////////////////////////////////////////
 
-/** Handle the WLAN save form and redirect to WLAN config page again */
-void ESP_WiFiManager::handleWifiSave()
+void ESP_WiFiManager::linkRttJson(char* buffer, const size_t& size, const uint16_t& rtt)
 {
-  LOGDEBUG(F("WiFi save"));
+  if (rtt == WM_LINK_RTT_NONE)
+    strncpy(buffer, "null", size);
+  else if (rtt == WM_LINK_RTT_LOST)
+    strncpy(buffer, "-1", size);
+  else
+    snprintf(buffer, size, "%u", rtt);
+}
 
-  //SAVE/connect here
-  _ssid = server->arg("s").c_str();
-  _pass = server->arg("p").c_str();
+//////////////////////////////////////////
+
+/** Handle the scan page */
+// /scan?since=<Version>&offset=&limit=&min_quality=, all optional.
+// With a since still in the delta window, only APs added or changed after that version are listed, and the BSSIDs
+// gone since then, or now below min_quality, are in Removed. Otherwise the full list, with "Delta":false.
+// Total counts the APs matching before offset and limit.
+void ESP_WiFiManager::handleScan()
+{
+  LOGDEBUG(F("Scan"));
 
-  _ssid1 = server->arg("s1").c_str();
-  _pass1 = server->arg("p1").c_str();
+  // Disable _configPortalTimeout when someone accessing Portal to give some time to config
+  _configPortalTimeout = 0;   //KH
 
-  ///////////////////////
+  LOGDEBUG(F("State-Json"));
 
 #if USING_CORS_FEATURE
   // For configuring CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
   server->sendHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
 #endif
 
-#if USE_ESP_WIFIMANAGER_NTP
+  // Results of the last background scan, a new one is started after the response if needed
+  requestScan(server->arg("refresh") == "1");
 
-  if (server->arg("timezone") != "")
-  {
-    _timezoneName = server->arg("timezone");
-    LOGDEBUG1(F("TZ name ="), _timezoneName);
-  }
-  else
+  // Seconds since that scan, not part of the ETag
+  if (_scanDone)
+    server->sendHeader(FPSTR(WM_HTTP_AGE), String((millis() - _scanTime) / 1000));
+
+  if (notModified())
   {
-    LOGDEBUG(F("No TZ arg"));
+    return;
   }
 
-#endif
-  ///////////////////////
+  uint32_t  since       = strtoul(server->arg("since").c_str(), NULL, 10);
+  bool      delta       = server->hasArg("since") && scanDeltaValid(since);
+  int       minQuality  = server->hasArg("min_quality") ? server->arg("min_quality").toInt() : -1;
+  int       offset      = server->arg("offset").toInt();
+  int       limit       = server->hasArg("limit") ? server->arg("limit").toInt() : _scanCount;
 
-  //parameters
-  for (int i = 0; i < _paramsCount; i++)
+  int       total       = 0;
+  int       sent        = 0;
+
+  pageBegin("application/json");
+
+  pageAdd(F("{\"Access_Points\":["));
+
+  //display networks in page
+  for (int i = 0; i < _scanCount; i++)
   {
-    if (_params[i] == NULL)
-    {
-      break;
-    }
+    const WM_ScanResult& result = _scanResults[i];
 
-    //read parameter
-    String value = server->arg(_params[i]->getID()).c_str();
+    if ( delta && ((int32_t) (result.version - since) <= 0) )
+      continue;
 
-    //store it in array
-    value.toCharArray(_params[i]->_WMParam_data._value, _params[i]->_WMParam_data._length);
+    int quality = getRSSIasQuality(result.rssi);
 
-    LOGDEBUG2(F("Parameter and value :"), _params[i]->getID(), value);
-  }
+    if (quality < minQuality)
+      continue;
 
-  if (server->arg("ip") != "")
-  {
-    String ip = server->arg("ip");
-    optionalIPFromString(&_WiFi_STA_IPconfig._sta_static_ip, ip.c_str());
+    total++;
 
-    LOGDEBUG1(F("New Static IP ="), _WiFi_STA_IPconfig._sta_static_ip.toString());
-  }
+    if ( (total <= offset) || (sent >= limit) )
+      continue;
 
-  if (server->arg("gw") != "")
-  {
-    String gw = server->arg("gw");
-    optionalIPFromString(&_WiFi_STA_IPconfig._sta_static_gw, gw.c_str());
+    if (sent++ != 0)
+      pageAdd(F(", "));
 
-    LOGDEBUG1(F("New Static Gateway ="), _WiFi_STA_IPconfig._sta_static_gw.toString());
-  }
+    const char* ssid = result.ssid;
 
-  if (server->arg("sn") != "")
-  {
-    String sn = server->arg("sn");
-    optionalIPFromString(&_WiFi_STA_IPconfig._sta_static_sn, sn.c_str());
+    LOGDEBUG1(F("Index ="), i);
+    LOGDEBUG1(F("SSID ="), ssid);
+    LOGDEBUG1(F("RSSI ="), result.rssi);
 
-    LOGDEBUG1(F("New Static Netmask ="), _WiFi_STA_IPconfig._sta_static_sn.toString());
-  }
+    char rssiQ[8];
 
-#if USE_CONFIGURABLE_DNS
+    snprintf(rssiQ, sizeof(rssiQ), "%d", quality);
 
-  //*****  Added for DNS Options *****
-  if (server->arg("dns1") != "")
-  {
-    String dns1 = server->arg("dns1");
-    optionalIPFromString(&_WiFi_STA_IPconfig._sta_static_dns1, dns1.c_str());
+    const char* tokens[WM_TOKEN_COUNT] = { NULL };
 
-    LOGDEBUG1(F("New Static DNS1 ="), _WiFi_STA_IPconfig._sta_static_dns1.toString());
-  }
+    char apCount[4];
+    char bssid[18];
+    char channel[4];
 
-  if (server->arg("dns2") != "")
-  {
-    String dns2 = server->arg("dns2");
-    optionalIPFromString(&_WiFi_STA_IPconfig._sta_static_dns2, dns2.c_str());
+    snprintf(apCount, sizeof(apCount), "%u", result.apCount);
+    wmBssidToString(result.bssid, bssid);
+    snprintf(channel, sizeof(channel), "%u", result.channel);
 
-    LOGDEBUG1(F("New Static DNS2 ="), _WiFi_STA_IPconfig._sta_static_dns2.toString());
-  }
+    tokens[WM_TOKEN_V] = ssid;
+    tokens[WM_TOKEN_R] = rssiQ;
+    tokens[WM_TOKEN_A] = apCount;
+    tokens[WM_TOKEN_B] = bssid;
+    tokens[WM_TOKEN_C] = channel;
 
-  //*****  End added for DNS Options *****
-#endif
+#ifdef ESP8266
 
-  String page = FPSTR(WM_HTTP_HEAD_START);
+    if (result.encryption != ENC_TYPE_NONE)
+#else   //ESP32
+    if (result.encryption != WIFI_AUTH_OPEN)
+#endif
+    {
+      tokens[WM_TOKEN_I] = "true";
+    }
+    else
+    {
+      tokens[WM_TOKEN_I] = "false";
+    }
 
-  page.replace("{v}", "Credentials Saved");
-  page += FPSTR(WM_HTTP_SCRIPT);
-  page += FPSTR(WM_HTTP_STYLE);
-  page += _customHeadElement;
-  page += FPSTR(WM_HTTP_HEAD_END);
-  page += FPSTR(WM_HTTP_SAVED);
-  page.replace("{v}", _apName);
-  page.replace("{x}", _ssid);
-  page.replace("{x1}", _ssid1);
+    pageAddTemplate(WM_TEMPLATE(JSON_ITEM), tokens);
+    delay(0);
+  }
 
-  page += FPSTR(WM_HTTP_END);
+  pageAdd(F("], \"Removed\":["));
 
-  server->send(200, "text/html", page);
+  if (delta)
+  {
+    char  bssid[21];
+    bool  first = true;
 
-  LOGDEBUG(F("Sent wifi save page"));
+    // Changed since, but now below min_quality
+    for (int i = 0; i < _scanCount; i++)
+    {
+      if ( ((int32_t) (_scanResults[i].version - since) > 0) && (getRSSIasQuality(_scanResults[i].rssi) < minQuality) )
+      {
+        bssid[0] = '"';
+        wmBssidToString(_scanResults[i].bssid, bssid + 1);
+        strcat(bssid, "\"");
 
-  connect = true; //signal ready to connect/reset
+        pageAdd(first ? "" : ", ");
+        pageAdd(bssid);
 
-  // Restore when Press Save WiFi
-  _configPortalTimeout = DEFAULT_PORTAL_TIMEOUT;
-}
+        first = false;
+      }
+    }
 
-//////////////////////////////////////////
+    // Gone since, unless back in the list
+    for (int j = 0; j < _scanRemovedCount; j++)
+    {
+      const WM_ScanRemoved& removed = _scanArena->removed[j];
 
-/** Handle shut down the server page */
-void ESP_WiFiManager::handleServerClose()
-{
-  LOGDEBUG(F("Server Close"));
+      if ((int32_t) (removed.version - since) <= 0)
+        continue;
 
-  server->sendHeader(FPSTR(WM_HTTP_CACHE_CONTROL), FPSTR(WM_HTTP_NO_STORE));
+      bool present = false;
 
-#if USING_CORS_FEATURE
-  // For configuring CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
-  server->sendHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
-#endif
+      for (int i = 0; (i < _scanCount) && !present; i++)
+      {
+        present = (memcmp(_scanResults[i].bssid, removed.bssid, sizeof(removed.bssid)) == 0);
+      }
 
-  server->sendHeader(FPSTR(WM_HTTP_PRAGMA), FPSTR(WM_HTTP_NO_CACHE));
-  server->sendHeader(FPSTR(WM_HTTP_EXPIRES), "-1");
+      if (present)
+        continue;
 
-  String page = FPSTR(WM_HTTP_HEAD_START);
+      bssid[0] = '"';
+      wmBssidToString(removed.bssid, bssid + 1);
+      strcat(bssid, "\"");
 
-  page.replace("{v}", "Close Server");
-  page += FPSTR(WM_HTTP_SCRIPT);
-  page += FPSTR(WM_HTTP_STYLE);
-  page += _customHeadElement;
-  page += FPSTR(WM_HTTP_HEAD_END);
-  page += F("<div class=\"msg\">");
-  page += F("My network is <b>");
-  page += WiFi_SSID();
-  page += F("</b><br>");
-  page += F("IP address is <b>");
-  page += WiFi.localIP().toString();
-  page += F("</b><br><br>");
-  page += F("Portal closed...<br><br>");
+      pageAdd(first ? "" : ", ");
+      pageAdd(bssid);
 
-  //page += F("Push button on device to restart configuration server!");
+      first = false;
+    }
+  }
 
-  page += FPSTR(WM_HTTP_END);
+  char tail[64];
 
-  server->send(200, "text/html", page);
+  snprintf(tail, sizeof(tail), "], \"Version\":%lu, \"Delta\":%s, \"Total\":%d}",
+           (unsigned long) _scanVersion, delta ? "true" : "false", total);
 
-  stopConfigPortal = true; //signal ready to shutdown config portal
+  pageAdd(tail);
 
-  LOGDEBUG(F("Sent server close page"));
+  pageEnd();
 
-  // Restore when Press Save WiFi
-  _configPortalTimeout = DEFAULT_PORTAL_TIMEOUT;
+  LOGDEBUG(F("Sent WiFiScan Data in Json format"));
 }
 
 //////////////////////////////////////////
 
-/** Handle the info page */
-void ESP_WiFiManager::handleInfo()
+/** Handle the reset page */
+void ESP_WiFiManager::handleReset()
 {
-  LOGDEBUG(F("Info"));
+  LOGDEBUG(F("Reset"));
 
-  // Disable _configPortalTimeout when someone accessing Portal to give some time to config
-  _configPortalTimeout = 0;   //KH
+  sendNoStoreHeaders();
 
-  server->sendHeader(FPSTR(WM_HTTP_CACHE_CONTROL), FPSTR(WM_HTTP_NO_STORE));
+  pageBegin();
 
-#if USING_CORS_FEATURE
-  // For configuring CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
-  server->sendHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
-#endif
+  pageHead("WiFi Information");
+  pageAdd(FPSTR(WM_HTTP_HEAD_ASSETS));
+  pageAdd(_customHeadElement);
+  pageAdd(FPSTR(WM_HTTP_HEAD_END));
+  pageAdd(F("Resetting"));
+  pageAdd(FPSTR(WM_HTTP_END));
 
-  server->sendHeader(FPSTR(WM_HTTP_PRAGMA), FPSTR(WM_HTTP_NO_CACHE));
-  server->sendHeader(FPSTR(WM_HTTP_EXPIRES), "-1");
+  pageEnd();
 
-  String page = FPSTR(WM_HTTP_HEAD_START);
+  LOGDEBUG(F("Sent reset page"));
+  delay(5000);
 
-  page.replace("{v}", "Info");
-  page += FPSTR(WM_HTTP_SCRIPT);
-  page += FPSTR(WM_HTTP_SCRIPT_NTP);
-  page += FPSTR(WM_HTTP_STYLE);
-  page += _customHeadElement;
-  page += FPSTR(WM_HTTP_HEAD_END);
+  // Temporary fix for issue of not clearing WiFi SSID/PW from flash of ESP32
+  // See https://github.com/khoih-prog/ESP_WiFiManager/issues/25 and https://github.com/espressif/arduino-esp32/issues/400
+  resetSettings();
 
-  page += F("<h2>WiFi Information</h2>");
+  //WiFi.disconnect(true); // Wipe out WiFi credentials.
+  //////
 
-  reportStatus(page);
+#ifdef ESP8266
+  ESP.reset();
+#else   //ESP32
+  ESP.restart();
+#endif
 
-  page += FPSTR(WM_FLDSET_START);
+  delay(2000);
+}
 
-  page += F("<h3>Device Data</h3>");
-  page += F("<table class=\"table\">");
-  page += F("<thead><tr><th>Name</th><th>Value</th></tr></thead><tbody><tr><td>Chip ID</td><td>");
+//////////////////////////////////////////
 
-  page += F("0x");
-#ifdef ESP8266
-  page += String(ESP.getChipId(), HEX);   //ESP.getChipId();
-#else   //ESP32
+void ESP_WiFiManager::handleNotFound()
+{
+  if (captivePortal())
+  {
+    // If caprive portal redirect instead of displaying the error page.
+    return;
+  }
 
-  page += String(ESP_getChipId(), HEX);   //ESP.getChipId();
+  String message = "File Not Found\n\n";
 
-  page += F("</td></tr>");
-  page += F("<tr><td>Chip OUI</td><td>");
-  page += F("0x");
-  page += String(getChipOUI(), HEX);    //ESP.getChipId();
+  message += "URI: ";
+  message += server->uri();
+  message += "\nMethod: ";
+  message += (server->method() == HTTP_GET) ? "GET" : "POST";
+  message += "\nArguments: ";
+  message += server->args();
+  message += "\n";
 
-  page += F("</td></tr>");
-  page += F("<tr><td>Chip Model</td><td>");
-  page += ESP.getChipModel();
-  page += F(" Rev");
-  page += ESP.getChipRevision();
-#endif
+  for (uint8_t i = 0; i < server->args(); i++)
+  {
+    message += " " + server->argName(i) + ": " + server->arg(i) + "\n";
+  }
 
-  page += F("</td></tr>");
-  page += F("<tr><td>Flash Chip ID</td><td>");
+  sendNoStoreHeaders();
 
-#ifdef ESP8266
-  page += String(ESP.getFlashChipId(), HEX);    //ESP.getFlashChipId();
-#else   //ESP32
-  // TODO
-  page += F("TODO");
+  server->send(404, "text/plain", message);
+}
+
+//////////////////////////////////////////
+
+// One pre-serialized block when the WebServer supports header sets (patched ESP32-S2 WebServer)
+void ESP_WiFiManager::sendNoStoreHeaders()
+{
+#if WEBSERVER_HAS_HEADER_SETS
+  server->sendHeaders_P(WM_HTTP_HEADERS_NO_STORE);
+#else
+  server->sendHeader(FPSTR(WM_HTTP_CACHE_CONTROL), FPSTR(WM_HTTP_NO_STORE));
+  server->sendHeader(FPSTR(WM_HTTP_PRAGMA), FPSTR(WM_HTTP_NO_CACHE));
+  server->sendHeader(FPSTR(WM_HTTP_EXPIRES), "-1");
 #endif
+}
+
+//////////////////////////////////////////
+
+void ESP_WiFiManager::bumpContentVersion()
+{
+  _contentVersion++;
+}
 
-  page += F("</td></tr>");
-  page += F("<tr><td>IDE Flash Size</td><td>");
-  page += ESP.getFlashChipSize();
-  page += F(" bytes</td></tr>");
-  page += F("<tr><td>Real Flash Size</td><td>");
+//////////////////////////////////////////
 
-#ifdef ESP8266
-  page += ESP.getFlashChipRealSize();
-#else   //ESP32
-  // TODO
-  page += F("TODO");
-#endif
+// WiFi status and station IP are polled here, so a page is considered changed as soon as they are.
+// Sends the ETag and, if the client already has this version, a header-only 304 and returns true
+bool ESP_WiFiManager::notModified()
+{
+  uint8_t  status   = WiFi.status();
+  uint32_t localIP  = (uint32_t) WiFi.localIP();
+
+  if ( (status != _contentWiFiStatus) || (localIP != _contentLocalIP) )
+  {
+    _contentWiFiStatus  = status;
+    _contentLocalIP     = localIP;
 
-  page += F(" bytes</td></tr>");
-  page += F("<tr><td>Access Point IP</td><td>");
-  page += WiFi.softAPIP().toString();
-  page += F("</td></tr>");
-  page += F("<tr><td>Access Point MAC</td><td>");
-  page += WiFi.softAPmacAddress();
-  page += F("</td></tr>");
+    bumpContentVersion();
+  }
 
-  page += F("<tr><td>SSID</td><td>");
-  page += WiFi_SSID();
-  page += F("</td></tr>");
+  char etag[12];
 
-  page += F("<tr><td>Station IP</td><td>");
-  page += WiFi.localIP().toString();
-  page += F("</td></tr>");
+  snprintf(etag, sizeof(etag), "\"%08lx\"", (unsigned long) _contentVersion);
 
-  page += F("<tr><td>Station MAC</td><td>");
-  page += WiFi.macAddress();
-  page += F("</td></tr>");
-  page += F("</tbody></table>");
+  server->sendHeader(FPSTR(WM_HTTP_ETAG), etag);
+  server->sendHeader(FPSTR(WM_HTTP_CACHE_CONTROL), FPSTR(WM_HTTP_NO_CACHE));
 
-  page += FPSTR(WM_FLDSET_END);
+  if (server->header(FPSTR(WM_HTTP_IF_NONE_MATCH)) == etag)
+  {
+    LOGDEBUG1(F("Not modified, ETag ="), etag);
 
-#if USE_AVAILABLE_PAGES
-  page += FPSTR(WM_FLDSET_START);
+    server->send(304);
 
-  page += FPSTR(WM_HTTP_AVAILABLE_PAGES);
+    return true;
+  }
 
-  page += FPSTR(WM_FLDSET_END);
-#endif
+  return false;
+}
 
-  page += F("<p/>More information about ESP_WiFiManager at");
-  page += F("<p/><a href=\"https://github.com/khoih-prog/ESP_WiFiManager\">https://github.com/khoih-prog/ESP_WiFiManager</a>");
-  page += FPSTR(WM_HTTP_END);
+//////////////////////////////////////////
 
-  server->send(200, "text/html", page);
+// A stale or missing scan is only refreshed when a page asks for it, so an idle portal doesn't keep
+// taking the radio off the AP channel. The scan itself is started by processScan(), after the response
+void ESP_WiFiManager::requestScan(const bool& force)
+{
+  // A running scan gives fresh results anyway
+  if (_scanRunning)
+    return;
 
-  LOGDEBUG(F("Sent info page"));
+  if ( force || !_scanDone || (millis() - _scanTime >= _scanCacheTTL) )
+    _scanWanted = true;
 }
 
 //////////////////////////////////////////
 
-/** Handle the state page */
-void ESP_WiFiManager::handleState()
+void ESP_WiFiManager::processScan()
 {
-  LOGDEBUG(F("State - json"));
+  if (_scanRunning)
+  {
+    int n = WiFi.scanComplete();
 
-  server->sendHeader(FPSTR(WM_HTTP_CACHE_CONTROL), FPSTR(WM_HTTP_NO_STORE));
+    if (n == WIFI_SCAN_RUNNING)
+      return;
 
-#if USING_CORS_FEATURE
-  // For configuring CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
-  server->sendHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
-#endif
+    _scanRunning = false;
 
-  server->sendHeader(FPSTR(WM_HTTP_PRAGMA), FPSTR(WM_HTTP_NO_CACHE));
-  server->sendHeader(FPSTR(WM_HTTP_EXPIRES), "-1");
+    LOGDEBUG1(F("processScan: Done, Scanned Networks n ="), n);
 
-  String page = F("{\"Soft_AP_IP\":\"");
+    // Keep the previous results if the scan failed. Still stale, so the next page retries
+    if ( (n >= 0) && _scanArena )
+    {
+      // Into the set not being served, compared with the current one, then swapped
+      uint8_t         set     = (_scanResults == _scanArena->results[0]) ? 1 : 0;
+      WM_ScanResult*  results = _scanArena->results[set];
 
-  page += WiFi.softAPIP().toString();
-  page += F("\",\"Soft_AP_MAC\":\"");
-  page += WiFi.softAPmacAddress();
-  page += F("\",\"Station_IP\":\"");
-  page += WiFi.localIP().toString();
-  page += F("\",\"Station_MAC\":\"");
-  page += WiFi.macAddress();
-  page += F("\",");
+      int count = collectScanResults(n, results, _scanArena->ssids[set][0], WM_MAX_SCAN_RESULTS,
+                                     _scanArena->table, WM_SCAN_TABLE_SLOTS);
 
-  if (WiFi.psk() != "")
-  {
-    page += F("\"Password\":true,");
+      if (updateScanDelta(results, count))
+        bumpContentVersion();
+
+      _scanResults  = results;
+      _scanCount    = count;
+      _scanTime     = millis();
+      _scanDone     = true;
+
+      updateKnownAPs(_scanResults, _scanCount);
+    }
+
+    // Results are copied, release the driver ones
+    WiFi.scanDelete();
   }
-  else
+  else if (_scanWanted && (_portalStatus != WM_PORTAL_CONNECTING) )
   {
-    page += F("\"Password\":false,");
-  }
-
-  page += F("\"SSID\":\"");
-  page += WiFi_SSID();
-  page += F("\"}");
+    _scanWanted = false;
 
-  server->send(200, "application/json", page);
+    LOGDEBUG(F("Scanning Network in background"));
 
-  LOGDEBUG(F("Sent state page in json format"));
+    _scanRunning = (WiFi.scanNetworks(true, true) == WIFI_SCAN_RUNNING);
+  }
 }
 
 //////////////////////////////////////////
 
-/** Handle the scan page */
-void ESP_WiFiManager::handleScan()
+// Matches the new scan with the current one by BSSID. New and changed APs get the next scan version, unchanged ones
+// keep their version and the RSSI already reported, so that small variations don't count as changes.
+// APs no longer seen are remembered for the deltas. Returns true if anything changed
+bool ESP_WiFiManager::updateScanDelta(WM_ScanResult* results, const int& n)
 {
-  LOGDEBUG(F("Scan"));
-
-  // Disable _configPortalTimeout when someone accessing Portal to give some time to config
-  _configPortalTimeout = 0;   //KH
-
-  LOGDEBUG(F("State-Json"));
-
-  server->sendHeader(FPSTR(WM_HTTP_CACHE_CONTROL), FPSTR(WM_HTTP_NO_STORE));
-
-#if USING_CORS_FEATURE
-  // For configuring CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
-  server->sendHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
-#endif
+  uint32_t  nextVersion = _scanVersion + 1;
+  bool      changed     = false;
+  uint16_t  tableSize   = 4;
 
-  server->sendHeader(FPSTR(WM_HTTP_PRAGMA), FPSTR(WM_HTTP_NO_CACHE));
-  server->sendHeader(FPSTR(WM_HTTP_EXPIRES), "-1");
+  while (tableSize < 2 * _scanCount)
+    tableSize <<= 1;
 
-  int n;
-  int *indices;
+  // current results index + 1, 0 if empty
+  uint8_t* table = _scanArena->table;
 
-  //Space for indices array allocated on heap in scanWifiNetworks
-  //and should be freed when indices no longer required.
+  memset(table, 0, tableSize);
 
-  n = scanWifiNetworks(&indices);
+  for (int j = 0; j < _scanCount; j++)
+  {
+    uint16_t slot = wmFnv1a(_scanResults[j].bssid, sizeof(_scanResults[j].bssid)) & (tableSize - 1);
 
-  LOGDEBUG(F("In handleScan, scanWifiNetworks done"));
+    while (table[slot] != 0)
+      slot = (slot + 1) & (tableSize - 1);
 
-  String page = F("{\"Access_Points\":[");
+    table[slot] = j + 1;
+  }
 
-  //display networks in page
   for (int i = 0; i < n; i++)
   {
-    if (indices[i] == -1)
-      continue; // skip duplicates and those that are below the required quality
+    WM_ScanResult&  result  = results[i];
+    WM_ScanResult*  current = NULL;
+    uint16_t        slot    = wmFnv1a(result.bssid, sizeof(result.bssid)) & (tableSize - 1);
 
-    if (i != 0)
-      page += F(", ");
-
-    LOGDEBUG1(F("Index ="), i);
-    LOGDEBUG1(F("SSID ="), WiFi.SSID(indices[i]));
-    LOGDEBUG1(F("RSSI ="), WiFi.RSSI(indices[i]));
-
-    int quality = getRSSIasQuality(WiFi.RSSI(indices[i]));
-    String item = FPSTR(JSON_ITEM);
-    String rssiQ;
+    for ( ; table[slot] != 0; slot = (slot + 1) & (tableSize - 1))
+    {
+      WM_ScanResult& candidate = _scanResults[table[slot] - 1];
 
-    rssiQ += quality;
-    item.replace("{v}", WiFi.SSID(indices[i]));
-    item.replace("{r}", rssiQ);
+      // Matched ones are marked with index UINT8_MAX
+      if ( (candidate.index != UINT8_MAX) && (memcmp(candidate.bssid, result.bssid, sizeof(result.bssid)) == 0) )
+      {
+        current = &candidate;
 
-#ifdef ESP8266
+        break;
+      }
+    }
 
-    if (WiFi.encryptionType(indices[i]) != ENC_TYPE_NONE)
-#else   //ESP32
-    if (WiFi.encryptionType(indices[i]) != WIFI_AUTH_OPEN)
-#endif
+    if ( current && (current->encryption == result.encryption) && (current->channel == result.channel)
+         && (current->apCount == result.apCount) && (strcmp(current->ssid, result.ssid) == 0)
+         && (abs(getRSSIasQuality(current->rssi) - getRSSIasQuality(result.rssi)) < WM_SCAN_DELTA_QUALITY) )
     {
-      item.replace("{i}", "true");
+      result.version  = current->version;
+      result.rssi     = current->rssi;
     }
     else
     {
-      item.replace("{i}", "false");
+      result.version  = nextVersion;
+      changed         = true;
     }
 
-    //LOGDEBUG(item);
-
-    page += item;
-    delay(0);
+    if (current)
+      current->index = UINT8_MAX;
   }
 
-  if (indices)
+  for (int j = 0; j < _scanCount; j++)
   {
-    free(indices); //indices array no longer required so free memory
-  }
+    if (_scanResults[j].index != UINT8_MAX)
+    {
+      addScanRemoved(_scanResults[j].bssid, nextVersion);
 
-  page += F("]}");
+      changed = true;
+    }
+  }
 
-  server->send(200, "application/json", page);
+  if (changed)
+    _scanVersion = nextVersion;
 
-  LOGDEBUG(F("Sent WiFiScan Data in Json format"));
+  return changed;
 }
 
 //////////////////////////////////////////
 
-/** Handle the reset page */
-void ESP_WiFiManager::handleReset()
+void ESP_WiFiManager::addScanRemoved(const uint8_t* bssid, const uint32_t& version)
 {
-  LOGDEBUG(F("Reset"));
-
-  server->sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-  server->sendHeader("Pragma", "no-cache");
-  server->sendHeader("Expires", "-1");
+  WM_ScanRemoved& removed = _scanArena->removed[_scanRemovedNext];
 
-  String page = FPSTR(WM_HTTP_HEAD_START);
+  // The oldest removal is overwritten, so a delta from before it would be incomplete
+  if (_scanRemovedCount == WM_SCAN_REMOVED_HISTORY)
+    _scanFloorVersion = removed.version;
+  else
+    _scanRemovedCount++;
 
-  page.replace("{v}", "WiFi Information");
-  page += FPSTR(WM_HTTP_SCRIPT);
-  page += FPSTR(WM_HTTP_STYLE);
-  page += _customHeadElement;
-  page += FPSTR(WM_HTTP_HEAD_END);
-  page += F("Resetting");
-  page += FPSTR(WM_HTTP_END);
+  memcpy(removed.bssid, bssid, sizeof(removed.bssid));
+  removed.version = version;
 
-  server->send(200, "text/html", page);
+  _scanRemovedNext = (_scanRemovedNext + 1) % WM_SCAN_REMOVED_HISTORY;
+}
 
-  LOGDEBUG(F("Sent reset page"));
-  delay(5000);
+//////////////////////////////////////////
 
-  // Temporary fix for issue of not clearing WiFi SSID/PW from flash of ESP32
-  // See https://github.com/khoih-prog/ESP_WiFiManager/issues/25 and https://github.com/espressif/arduino-esp32/issues/400
-  resetSettings();
+// since must be between _scanFloorVersion and _scanVersion, the versions being allowed to wrap around
+bool ESP_WiFiManager::scanDeltaValid(const uint32_t& since)
+{
+  return (uint32_t) (since - _scanFloorVersion) <= (uint32_t) (_scanVersion - _scanFloorVersion);
+}
 
-  //WiFi.disconnect(true); // Wipe out WiFi credentials.
-  //////
+//////////////////////////////////////////
 
-#ifdef ESP8266
-  ESP.reset();
-#else   //ESP32
-  ESP.restart();
-#endif
+/** Handle the stylesheet */
+void ESP_WiFiManager::handleStyle()
+{
+  LOGDEBUG(F("Handle CSS"));
 
-  delay(2000);
+  sendAsset(PSTR("text/css"), WM_ASSET_CSS_GZ, WM_ASSET_CSS_GZ_LEN, WM_ASSET_CSS_ETAG);
 }
 
 //////////////////////////////////////////
 
-void ESP_WiFiManager::handleNotFound()
+/** Handle the page script, with jstz bundled in when NTP is configured locally */
+void ESP_WiFiManager::handleScript()
 {
-  if (captivePortal())
-  {
-    // If caprive portal redirect instead of displaying the error page.
-    return;
-  }
+  LOGDEBUG(F("Handle JS"));
 
-  String message = "File Not Found\n\n";
+#if (USE_ESP_WIFIMANAGER_NTP && !USE_CLOUDFLARE_NTP)
+  sendAsset(PSTR("application/javascript"), WM_ASSET_JS_NTP_GZ, WM_ASSET_JS_NTP_GZ_LEN, WM_ASSET_JS_NTP_ETAG);
+#else
+  sendAsset(PSTR("application/javascript"), WM_ASSET_JS_GZ, WM_ASSET_JS_GZ_LEN, WM_ASSET_JS_ETAG);
+#endif
+}
 
-  message += "URI: ";
-  message += server->uri();
-  message += "\nMethod: ";
-  message += (server->method() == HTTP_GET) ? "GET" : "POST";
-  message += "\nArguments: ";
-  message += server->args();
-  message += "\n";
+//////////////////////////////////////////
 
-  for (uint8_t i = 0; i < server->args(); i++)
+// The assets are pre-gzipped in flash and never change for a given firmware, so they are
+// sent as is with a strong ETag and a one-year max-age. A matching If-None-Match gets 304
+void ESP_WiFiManager::sendAsset(PGM_P contentType, const uint8_t* gz, const size_t& gzLen, PGM_P etag)
+{
+  server->sendHeader(FPSTR(WM_HTTP_ETAG), FPSTR(etag));
+  server->sendHeader(FPSTR(WM_HTTP_CACHE_CONTROL), FPSTR(WM_HTTP_CACHE_FOREVER));
+
+  if (server->header(FPSTR(WM_HTTP_IF_NONE_MATCH)) == FPSTR(etag))
   {
-    message += " " + server->argName(i) + ": " + server->arg(i) + "\n";
-  }
+    server->send(304);
 
-  server->sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-  server->sendHeader("Pragma", "no-cache");
-  server->sendHeader("Expires", "-1");
+    return;
+  }
 
-  server->send(404, "text/plain", message);
+  server->sendHeader(FPSTR(WM_HTTP_CONTENT_ENCODING), FPSTR(WM_HTTP_GZIP));
+  server->send_P(200, contentType, (PGM_P) gz, gzLen);
 }
 
 //////////////////////////////////////////
@@ -1923,6 +4585,8 @@ void ESP_WiFiManager::setSaveConfigCallback(void(*func)())
 void ESP_WiFiManager::setCustomHeadElement(const char* element)
 {
   _customHeadElement = element;
+
+  bumpContentVersion();
 }
 
 //if this is true, remove duplicated Access Points - defaut true
@@ -1934,8 +4598,8 @@ void ESP_WiFiManager::setRemoveDuplicateAPs(bool removeDuplicates)
 //////////////////////////////////////////
 
 //Scan for WiFiNetworks in range and sort by signal strength
-//space for indices array allocated on the heap and should be freed when no longer required
-int ESP_WiFiManager::scanWifiNetworks(int **indicesptr)
+//space for results array allocated on the heap and should be freed when no longer required
+int ESP_WiFiManager::scanWifiNetworks(WM_ScanResult **resultsptr)
 {
   LOGDEBUG(F("Scanning Network"));
 
@@ -1943,6 +4607,8 @@ int ESP_WiFiManager::scanWifiNetworks(int **indicesptr)
 
   LOGDEBUG1(F("scanWifiNetworks: Done, Scanned Networks n ="), n);
 
+  *resultsptr = NULL;
+
   //KH, Terrible bug here. WiFi.scanNetworks() returns n < 0 => malloc( negative == very big ) => crash!!!
   //In .../esp32/libraries/WiFi/src/WiFiType.h
   //#define WIFI_SCAN_RUNNING   (-1)
@@ -1954,96 +4620,258 @@ int ESP_WiFiManager::scanWifiNetworks(int **indicesptr)
 
     return (0);
   }
-  else
+
+  // WiFi.SSID(), WiFi.RSSI(), etc. take an uint8_t index
+  if (n > UINT8_MAX)
+    n = UINT8_MAX;
+
+  uint16_t tableSize = 4;
+
+  while (tableSize < 2 * n)
+    tableSize <<= 1;
+
+  // Allocate space off the heap for results array, followed by the SSIDs.
+  // This space should be freed when no longer required.
+  WM_ScanResult*  results = (WM_ScanResult *) malloc(n * (sizeof(WM_ScanResult) + WM_SCAN_SSID_SIZE));
+  uint8_t*        table   = (uint8_t *) malloc(tableSize);
+
+  if ( (results == NULL) || (table == NULL) )
   {
-    // Allocate space off the heap for indices array.
-    // This space should be freed when no longer required.
-    int* indices = (int *)malloc(n * sizeof(int));
+    LOGDEBUG(F("ERROR: Out of memory"));
 
-    if (indices == NULL)
-    {
-      LOGDEBUG(F("ERROR: Out of memory"));
-      *indicesptr = NULL;
+    free(results);
+    free(table);
 
-      return (0);
-    }
+    return (0);
+  }
 
-    *indicesptr = indices;
+  *resultsptr = results;
 
-    //sort networks
-    for (int i = 0; i < n; i++)
-    {
-      indices[i] = i;
-    }
+  n = collectScanResults(n, results, (char *) (results + n), n, table, tableSize);
 
-    LOGDEBUG(F("Sorting"));
+  free(table);
 
-    // RSSI SORT
-    // old sort
-    for (int i = 0; i < n; i++)
+  return (n);
+}
+
+//////////////////////////////////////////
+
+// Copies the n driver scan results into results[capacity], and their SSIDs into ssids[capacity][WM_SCAN_SSID_SIZE].
+// The strongest are kept when there are more than capacity. The copy is then sorted and filtered.
+// table[tableSize], power of 2 and >= 2 * capacity, is the work area of removeDuplicateAPs()
+int ESP_WiFiManager::collectScanResults(int n, WM_ScanResult* results, char* ssids, const int& capacity,
+                                        uint8_t* table, const uint16_t& tableSize)
+{
+  if (n <= 0)
+  {
+    LOGDEBUG(F("No network found"));
+
+    return (0);
+  }
+
+  // WiFi.SSID(), WiFi.RSSI(), etc. take an uint8_t index
+  if (n > UINT8_MAX)
+    n = UINT8_MAX;
+
+  int count = 0;
+
+  // One pass over the driver results. Everything below works on the snapshot
+  for (int i = 0; i < n; i++)
+  {
+    int8_t  rssi = (int8_t) WiFi.RSSI(i);
+    int     slot = count;
+
+    if (count < capacity)
+    {
+      count++;
+    }
+    else
     {
-      for (int j = i + 1; j < n; j++)
+      // Full, replace the weakest if weaker than this one
+      slot = 0;
+
+      for (int j = 1; j < capacity; j++)
       {
-        if (WiFi.RSSI(indices[j]) > WiFi.RSSI(indices[i]))
-        {
-          std::swap(indices[i], indices[j]);
-        }
+        if (results[j].rssi < results[slot].rssi)
+          slot = j;
       }
+
+      if (results[slot].rssi >= rssi)
+        continue;
+    }
+
+    WM_ScanResult&  result  = results[slot];
+    char*           ssidBuf = ssids + slot * WM_SCAN_SSID_SIZE;
+
+#ifdef ESP32
+    // Straight from the driver record, without a temporary String
+    const wifi_ap_record_t* record = (const wifi_ap_record_t*) WiFi.getScanInfoByIndex(i);
+
+    size_t len = record ? strnlen((const char*) record->ssid, WM_SCAN_SSID_SIZE - 1) : 0;
+
+    if (len)
+      memcpy(ssidBuf, record->ssid, len);
+#else
+    String ssid = WiFi.SSID(i);
+
+    size_t len = std::min((size_t) ssid.length(), (size_t) (WM_SCAN_SSID_SIZE - 1));
+
+    memcpy(ssidBuf, ssid.c_str(), len);
+#endif
+
+    ssidBuf[len] = 0;
+
+    result.ssid       = ssidBuf;
+    result.ssidHash   = wmFnv1a(ssidBuf, len);
+    result.rssi       = rssi;
+    result.channel    = (uint8_t) WiFi.channel(i);
+    result.encryption = WiFi.encryptionType(i);
+    result.index      = (uint8_t) i;
+    result.apCount    = 1;
+    result.version    = 0;
+
+    uint8_t* bssid = WiFi.BSSID(i);
+
+    if (bssid)
+      memcpy(result.bssid, bssid, sizeof(result.bssid));
+    else
+      memset(result.bssid, 0, sizeof(result.bssid));
+  }
+
+  if (n > count)
+  {
+    LOGDEBUG1(F("Kept strongest APs ="), count);
+  }
+
+  n = count;
+
+  LOGDEBUG(F("Sorting"));
+
+  // RSSI SORT, the scan index keeps the order of equal RSSIs and therefore the ETag stable
+  std::sort(results, results + n, [](const WM_ScanResult & a, const WM_ScanResult & b)
+  {
+    return (a.rssi != b.rssi) ? (a.rssi > b.rssi) : (a.index < b.index);
+  });
+
+  LOGDEBUG(F("Removing Dup"));
+
+  // remove duplicates ( must be RSSI sorted )
+  if (_removeDuplicateAPs)
+  {
+    removeDuplicateAPs(results, n, table, tableSize);
+  }
+
+  // Compact out the dups and those that are below the required quality
+  count = 0;
+
+  for (int i = 0; i < n; i++)
+  {
+    if (results[i].index == UINT8_MAX)
+      continue; // skip dups
+
+    int quality = getRSSIasQuality(results[i].rssi);
+
+    if (!(_minimumQuality == -1 || _minimumQuality < quality))
+    {
+      LOGDEBUG(F("Skipping low quality"));
+
+      continue;
     }
 
-    LOGDEBUG(F("Removing Dup"));
+    results[count++] = results[i];
+  }
+
+#if (DEBUG_WIFIMGR > 2)
+
+  for (int i = 0; i < count; i++)
+  {
+    Serial.println(results[i].ssid);
+  }
+
+#endif
+
+  return (count);
+}
+
+//////////////////////////////////////////
+
+// Open addressing on the SSID hashes, at most half full. The SSIDs themselves are only compared when hashes match.
+// The first, therefore strongest, AP of an SSID is kept and counts the others, which are marked with index UINT8_MAX
+void ESP_WiFiManager::removeDuplicateAPs(WM_ScanResult* results, const int& n, uint8_t* table, const uint16_t& tableSize)
+{
+  // results index + 1, 0 if empty
+  memset(table, 0, tableSize);
+
+  for (int i = 0; i < n; i++)
+  {
+    uint16_t slot = results[i].ssidHash & (tableSize - 1);
 
-    // remove duplicates ( must be RSSI sorted )
-    if (_removeDuplicateAPs)
+    while (table[slot] != 0)
     {
-      String cssid;
+      WM_ScanResult& kept = results[table[slot] - 1];
 
-      for (int i = 0; i < n; i++)
+      if (kept.ssidHash == results[i].ssidHash)
       {
-        if (indices[i] == -1)
-          continue;
+        if (strcmp(kept.ssid, results[i].ssid) == 0)
+        {
+          LOGDEBUG1("DUP AP:", kept.ssid);
 
-        cssid = WiFi.SSID(indices[i]);
+          if (kept.apCount < UINT8_MAX)
+            kept.apCount++;
 
-        for (int j = i + 1; j < n; j++)
-        {
-          if (cssid == WiFi.SSID(indices[j]))
-          {
-            LOGDEBUG1("DUP AP:", WiFi.SSID(indices[j]));
-            indices[j] = -1; // set dup aps to index -1
-          }
+          results[i].index = UINT8_MAX; // mark dup aps
+
+          break;
         }
       }
+
+      slot = (slot + 1) & (tableSize - 1);
     }
 
-    for (int i = 0; i < n; i++)
-    {
-      if (indices[i] == -1)
-        continue; // skip dups
+    if (table[slot] == 0)
+      table[slot] = i + 1;
+  }
+}
 
-      int quality = getRSSIasQuality(WiFi.RSSI(indices[i]));
+//////////////////////////////////////////
 
-      if (!(_minimumQuality == -1 || _minimumQuality < quality))
-      {
-        indices[i] = -1;
-        LOGDEBUG(F("Skipping low quality"));
-      }
-    }
+int ESP_WiFiManager::scanWifiNetworks(int **indicesptr)
+{
+  WM_ScanResult* results;
 
-#if (DEBUG_WIFIMGR > 2)
+  int n = scanWifiNetworks(&results);
 
+  *indicesptr = NULL;
+
+  if (n == 0)
+  {
+    if (results)
+      free(results);
+
+    return (0);
+  }
+
+  int* indices = (int *) malloc(n * sizeof(int));
+
+  if (indices != NULL)
+  {
     for (int i = 0; i < n; i++)
     {
-      if (indices[i] == -1)
-        continue; // skip dups
-      else
-        Serial.println(WiFi.SSID(indices[i]));
+      indices[i] = results[i].index;
     }
+  }
+  else
+  {
+    LOGDEBUG(F("ERROR: Out of memory"));
 
-#endif
-
-    return (n);
+    n = 0;
   }
+
+  free(results);
+
+  *indicesptr = indices;
+
+  return (n);
 }
 
 //////////////////////////////////////////
@@ -112,6 +112,8 @@
 
 #include <DNSServer.h>
 #include <memory>
+#include <new>
+#include <atomic>
 #undef min
 #undef max
 #include <algorithm>
@@ -124,12 +126,13 @@
   {
     #include "user_interface.h"
   }
-  
+
   #define ESP_getChipId()   (ESP.getChipId())
   
 #else		//ESP32
 
   #include <esp_wifi.h>
+  #include <freertos/semphr.h>
   
   uint32_t getChipID();
   uint32_t getChipOUI();
@@ -174,6 +177,474 @@ typedef struct
 
 ////////////////////////////////////////////////////
 
+// Returned by process() for the non-blocking Config Portal
+typedef enum
+{
+  WM_PORTAL_IDLE          = 0,    // Not started
+  WM_PORTAL_RUNNING,              // Serving DNS and HTTP
+  WM_PORTAL_CONNECTING,           // Credentials saved, trying to connect to them
+  // The portal is closed in all states below
+  WM_PORTAL_CONNECTED,            // Connected with the saved credentials
+  WM_PORTAL_CONNECT_FAILED,       // Saved credentials failed and setBreakAfterConfig(true)
+  WM_PORTAL_TIMED_OUT,            // setConfigPortalTimeout() expired, reconnecting to the stored AP
+  WM_PORTAL_STOPPED               // Closed by /close or stopConfigPortal()
+} WM_PortalStatus;
+
+// One scanned AP, copied once from the driver so that sorting and filtering don't call it again.
+// Widest fields first: aligned without packing, 24 bytes on ESP
+typedef struct
+{
+  const char* ssid;         // Owned by the results array, valid after WiFi.scanDelete()
+  uint32_t  ssidHash;       // wmFnv1a() of the SSID
+  uint32_t  version;        // Scan version at which this BSSID was added or last changed
+  int8_t    rssi;
+  uint8_t   channel;
+  uint8_t   encryption;
+  uint8_t   bssid[6];
+  uint8_t   index;          // Driver scan index, for WiFi.SSID()
+  uint8_t   apCount;        // APs with this SSID, merged into this strongest one when removing duplicates
+} WM_ScanResult;
+
+static_assert( (sizeof(void*) != 4) || (sizeof(WM_ScanResult) == 24), "WM_ScanResult must stay 24 bytes");
+
+// BSSID gone from the scan, kept so that /scan?since= can report it
+typedef struct
+{
+  uint8_t   bssid[6];
+  uint32_t  version;
+} WM_ScanRemoved;
+
+// Age after which the Config Portal scan is redone in the background, once a page needs it
+#ifndef WM_SCAN_CACHE_TTL
+  #define WM_SCAN_CACHE_TTL           30000L
+#endif
+
+// Config Portal scan storage, allocated once with the portal. If more APs are seen, the strongest ones are kept
+#ifndef WM_MAX_SCAN_RESULTS
+  #ifdef ESP8266
+    #define WM_MAX_SCAN_RESULTS       32
+  #else
+    #define WM_MAX_SCAN_RESULTS       64
+  #endif
+#endif
+
+// Open addressing table, power of 2 and >= 2 * WM_MAX_SCAN_RESULTS
+#define WM_SCAN_TABLE_SLOTS           256
+
+static_assert(WM_MAX_SCAN_RESULTS <= WM_SCAN_TABLE_SLOTS / 2, "WM_MAX_SCAN_RESULTS must be <= WM_SCAN_TABLE_SLOTS / 2");
+
+// SSID of 32 chars max, and NUL
+#define WM_SCAN_SSID_SIZE             33
+
+// Removed APs remembered for /scan?since=. A client further behind gets the full list
+#ifndef WM_SCAN_REMOVED_HISTORY
+  #define WM_SCAN_REMOVED_HISTORY     32
+#endif
+
+// Two sets, the one being served and the one being filled by the next scan, and the removals ring
+typedef struct
+{
+  WM_ScanResult   results[2][WM_MAX_SCAN_RESULTS];
+  char            ssids[2][WM_MAX_SCAN_RESULTS][WM_SCAN_SSID_SIZE];
+  uint8_t         table[WM_SCAN_TABLE_SLOTS];
+  WM_ScanRemoved  removed[WM_SCAN_REMOVED_HISTORY];
+} WM_ScanArena;
+
+// Quality change (%) for an AP to count as changed in /scan?since= deltas. Smaller changes keep the reported RSSI
+#ifndef WM_SCAN_DELTA_QUALITY
+  #define WM_SCAN_DELTA_QUALITY       10
+#endif
+
+// Time for the "Credentials Saved" page to get out before leaving the AP channel
+#ifndef WM_PORTAL_CONNECT_DELAY
+  #define WM_PORTAL_CONNECT_DELAY     2000L
+#endif
+
+// Time the portal stays up once the outcome of the saved credentials is known, for the saved page to read it from /status
+#ifndef WM_PORTAL_RESULT_LINGER
+  #define WM_PORTAL_RESULT_LINGER     5000L
+#endif
+
+// Connection timeout of the non-blocking portal and of waitForConnectResult() when setConnectTimeout() was not used
+#ifndef WM_PORTAL_CONNECT_TIMEOUT
+  #define WM_PORTAL_CONNECT_TIMEOUT   60000L
+#endif
+
+// WPS walk time. The non-blocking portal gives up on a WPS the SDK hasn't ended by then
+#ifndef WM_WPS_TIMEOUT
+  #define WM_WPS_TIMEOUT              120000L
+#endif
+
+// wpsResult() while WPS is going on, and once it succeeded (WPS_CB_ST_SUCCESS). Other values are failures
+#define WM_WPS_PENDING                (-1)
+#define WM_WPS_SUCCESS                0
+
+// Where a saved network was last seen, by the Config Portal scan or the last connection. channel 0 if unknown
+typedef struct
+{
+  uint8_t   channel;
+  uint8_t   bssid[6];
+} WM_KnownAP;
+
+// Saved networks. The Config Portal edits the first two, setCredential() all
+#ifndef MAX_WIFI_CREDENTIALS
+  #define MAX_WIFI_CREDENTIALS        2
+#endif
+
+static_assert(MAX_WIFI_CREDENTIALS >= 2, "MAX_WIFI_CREDENTIALS must be >= 2, for the Config Portal");
+
+// One saved network, with what its place in the connection order is scored on
+typedef struct
+{
+  String        ssid;
+  String        pass;
+  unsigned long lastSuccess;    // millis() of the last connection, 0 if none
+  uint16_t      failures;       // Connection failures since the last success
+  int8_t        rssi;           // Strongest AP of the last scan, 0 if not seen
+  WM_KnownAP    ap;             // Where it was last seen
+} WM_Credential;
+
+// Reconnection scan telemetry. The time saved by channel-targeted scans is counted against the last full sweep
+typedef struct
+{
+  uint16_t      knownScans;       // Channel-targeted scans that found a saved network
+  uint16_t      fullScans;        // Full sweeps, when they didn't
+  unsigned long lastScanTime;     // ms, last reconnection scan, full sweep included
+  unsigned long fullScanTime;     // ms, last full sweep, WM_FULL_SCAN_TIME until one is measured
+  unsigned long scanTimeSaved;    // ms, in total
+  uint16_t      roams;            // Reassociations to a stronger AP of the same SSID, once on it
+  uint16_t      roamFailures;     // Reassociations that failed or timed out on the AP left
+} WM_ConnectStats;
+
+// WiFi mode changes made by the library since boot. Those to the mode already set are skipped
+typedef struct
+{
+  uint16_t      switches;
+  uint16_t      skipped;
+  unsigned long switchTime;       // ms, in total
+  unsigned long lastSwitchTime;   // ms
+} WM_ModeStats;
+
+// Phases of a connection attempt. The SDKs report authentication and association together, as the link
+typedef enum
+{
+  WM_PHASE_SCAN           = 0,    // Channel-targeted or full scan of reconnectWifi(), before the attempt
+  WM_PHASE_MODE,                  // Static IP, mode and hostname, up to WiFi.begin()
+  WM_PHASE_LINK,                  // WiFi.begin() to associated and authenticated
+  WM_PHASE_DHCP,                  // Link up to IP bound
+  WM_PHASE_TOTAL,
+  WM_PHASE_COUNT
+} WM_ConnectPhase;
+
+// One connection attempt
+typedef struct
+{
+  uint16_t  phase[WM_PHASE_COUNT];    // ms, up to 65535
+  uint8_t   reached;                  // Bit per phase timed
+  uint8_t   result;                   // wl_status_t
+} WM_ConnectAttempt;
+
+typedef struct
+{
+  uint16_t  min;
+  uint16_t  avg;
+  uint16_t  max;
+} WM_PhaseStats;
+
+// Over the attempts kept, each phase over those that reached it
+typedef struct
+{
+  uint8_t           attempts;
+  uint8_t           connected;
+  WM_PhaseStats     phase[WM_PHASE_COUNT];
+  WM_ConnectAttempt last;
+} WM_ConnectTiming;
+
+// Connection attempts kept for getConnectTiming() and /metrics
+#ifndef WM_CONNECT_HISTORY
+  #define WM_CONNECT_HISTORY          8
+#endif
+
+// One link-quality sample
+typedef struct
+{
+  unsigned long time;         // millis()
+  int8_t        rssi;         // dBm, 0 if not connected
+  uint16_t      rtt;          // ms, of the gateway echo sent at the previous sample. Or WM_LINK_RTT_NONE / _LOST
+  uint16_t      drops;        // Connections lost so far
+} WM_LinkSample;
+
+// Over the samples kept, nearest-rank percentiles
+typedef struct
+{
+  uint8_t   samples;
+  int8_t    rssiP10;          // dBm, over the connected samples, 0 if none
+  int8_t    rssiP50;
+  int8_t    rssiP90;
+  uint16_t  rttP50;           // ms, over the answered echoes, WM_LINK_RTT_NONE if none
+  uint16_t  rttP90;
+  uint16_t  rttMax;
+  uint8_t   lost;             // Echoes not answered
+  uint16_t  drops;            // Connections lost from the first sample to the last
+} WM_LinkStats;
+
+// Background connection supervisor, driven by supervise() from loop()
+typedef enum
+{
+  WM_SUPERVISOR_BACKOFF   = 0,    // Waiting for the next try, the first one is immediate
+  WM_SUPERVISOR_SCANNING,         // Async scan for the saved networks
+  WM_SUPERVISOR_CONNECTING,       // Trying them, best first
+  WM_SUPERVISOR_CONNECTED,
+  WM_SUPERVISOR_ROAMING           // Connected, looking for a stronger AP of the same SSID
+} WM_SupervisorState;
+
+// Retry delay of the supervisor, doubled after each round that fails, from MIN up to MAX (ms).
+// Each wait is drawn at random in the upper half of the delay, so that devices don't retry in step
+#ifndef WM_SUPERVISOR_BACKOFF_MIN
+  #define WM_SUPERVISOR_BACKOFF_MIN   1000L
+#endif
+
+#ifndef WM_SUPERVISOR_BACKOFF_MAX
+  #define WM_SUPERVISOR_BACKOFF_MAX   300000L
+#endif
+
+// Connection timeout of the supervisor when setConnectTimeout() was not used. Failures reported by the
+// WiFi events end an attempt earlier
+#ifndef WM_SUPERVISOR_CONNECT_TIMEOUT
+  #define WM_SUPERVISOR_CONNECT_TIMEOUT   20000L
+#endif
+
+#ifndef WM_SUPERVISOR_SCAN_TIMEOUT
+  #define WM_SUPERVISOR_SCAN_TIMEOUT  10000L
+#endif
+
+// Roaming, see setRoaming(). The RSSI average moves by 1 / WM_ROAM_EWMA_WEIGHT of each sample
+#ifndef WM_ROAM_RSSI_THRESHOLD
+  #define WM_ROAM_RSSI_THRESHOLD      -75
+#endif
+
+#ifndef WM_ROAM_HYSTERESIS
+  #define WM_ROAM_HYSTERESIS          8
+#endif
+
+#ifndef WM_ROAM_SAMPLE_INTERVAL
+  #define WM_ROAM_SAMPLE_INTERVAL     1000L
+#endif
+
+#ifndef WM_ROAM_EWMA_WEIGHT
+  #define WM_ROAM_EWMA_WEIGHT         8
+#endif
+
+// Least time between roaming scans, and after a roam
+#ifndef WM_ROAM_SCAN_INTERVAL
+  #define WM_ROAM_SCAN_INTERVAL       60000L
+#endif
+
+// Every WM_ROAM_FULL_SCAN_EVERY roaming scans is a full sweep, to find the channels of the other APs
+#ifndef WM_ROAM_FULL_SCAN_EVERY
+  #define WM_ROAM_FULL_SCAN_EVERY     4
+#endif
+
+// Link-quality monitor, see setLinkMonitor(). Samples kept, for the percentiles
+#ifndef WM_LINK_HISTORY
+  #define WM_LINK_HISTORY             32
+#endif
+
+#ifndef WM_LINK_SAMPLE_INTERVAL
+  #define WM_LINK_SAMPLE_INTERVAL     10000L
+#endif
+
+// Gateway echo for the RTT: lwIP raw ICMP on ESP8266, esp_ping on ESP32 core v2+. Without, no RTT is sampled
+#ifndef USE_WM_LINK_PING
+  #if ( defined(ESP8266) || ( defined(ESP_ARDUINO_VERSION_MAJOR) && (ESP_ARDUINO_VERSION_MAJOR >= 2) ) )
+    #define USE_WM_LINK_PING          true
+  #else
+    #define USE_WM_LINK_PING          false
+  #endif
+#endif
+
+#if USE_WM_LINK_PING
+  #ifdef ESP8266
+    #include <lwip/raw.h>
+    #include <lwip/icmp.h>
+    #include <lwip/inet_chksum.h>
+    #include <lwip/prot/ip4.h>
+  #else
+    #include <ping/ping_sock.h>
+  #endif
+#endif
+
+#ifndef WM_LINK_PING_TIMEOUT
+  #define WM_LINK_PING_TIMEOUT        1000
+#endif
+
+#define WM_LINK_PING_ID               0x574D
+#define WM_LINK_PING_DATA             16
+
+// RTT of a sample without an answered echo
+#define WM_LINK_RTT_NONE              0xFFFF      // Not connected, or none sent
+#define WM_LINK_RTT_LOST              0xFFFE      // Not answered
+#define WM_LINK_RTT_PENDING           0xFFFD
+
+// Full sweep of all channels, until one is measured
+#ifndef WM_FULL_SCAN_TIME
+  #define WM_FULL_SCAN_TIME           2000L
+#endif
+
+// Fast reconnect cache, kept in RTC memory through deep sleep: where the last connection was made, and its lease
+#ifndef USE_WM_RTC_CACHE
+  #define USE_WM_RTC_CACHE            true
+#endif
+
+// Also reapply the cached lease as a static IP, without DHCP. Off by default: its lease time isn't known, and RTC
+// memory survives a reset, so the address may have been given to another station since
+#ifndef USE_WM_RTC_LEASE
+  #define USE_WM_RTC_LEASE            false
+#endif
+
+// ESP8266 ESP.rtcUserMemory offset, in 4-byte blocks out of 128. Must not overlap the sketch's own RTC data
+#ifndef WM_RTC_CACHE_OFFSET
+  #define WM_RTC_CACHE_OFFSET         96
+#endif
+
+// With USE_WM_RTC_LEASE, fast reconnects on one cached lease. The next one gets a new lease from DHCP
+#ifndef WM_RTC_LEASE_MAX_USES
+  #define WM_RTC_LEASE_MAX_USES       16
+#endif
+
+typedef struct
+{
+  uint32_t  crc;            // wmCrc32() of all that follows
+  uint32_t  ssidHash;       // wmFnv1a() of the SSID it is for
+  uint8_t   channel;
+  uint8_t   bssid[6];
+  uint8_t   leaseUses;      // Fast reconnects made with this lease
+  uint32_t  ip;
+  uint32_t  gw;
+  uint32_t  sn;
+  uint32_t  dns1;
+  uint32_t  dns2;
+} WM_RTCCache;
+
+static_assert(sizeof(WM_RTCCache) % 4 == 0, "WM_RTCCache must be a whole number of RTC memory blocks");
+
+// WiFi station events, handed from the WiFi callbacks to the connection wait
+typedef enum
+{
+  WM_EVENT_CONNECTED      = 1,    // Associated, waiting for DHCP
+  WM_EVENT_GOT_IP,
+  WM_EVENT_DISCONNECTED
+} WM_EventType;
+
+typedef struct
+{
+  uint8_t   type;           // WM_EventType
+  uint8_t   reason;         // WM_EVENT_DISCONNECTED reason
+  uint32_t  ssidHash;       // wmFnv1a() of the SSID, 0 if the event has none
+  uint32_t  time;           // millis() when it arrived
+} WM_ConnectEvent;
+
+// Disconnect reasons that end a connection attempt. Same values in the ESP8266 and ESP32 SDKs
+#define WM_REASON_4WAY_HANDSHAKE_TIMEOUT    15
+#define WM_REASON_NO_AP_FOUND               201
+#define WM_REASON_AUTH_FAIL                 202
+#define WM_REASON_HANDSHAKE_TIMEOUT         204
+
+// Power of 2. Events are dropped when full, WiFi.status() is still checked
+#ifndef WM_CONNECT_EVENT_QUEUE_SIZE
+  #define WM_CONNECT_EVENT_QUEUE_SIZE       8
+#endif
+
+// Longest sleep between checks while waiting for a connection. ESP32 is woken early by the WiFi events
+#ifndef WM_CONNECT_WAIT_SLICE
+  #ifdef ESP8266
+    #define WM_CONNECT_WAIT_SLICE           10
+  #else
+    #define WM_CONNECT_WAIT_SLICE           250
+  #endif
+#endif
+
+#ifdef ESP32
+  #if ( defined(ESP_ARDUINO_VERSION_MAJOR) && (ESP_ARDUINO_VERSION_MAJOR >= 2) )
+    #define WM_ESP32_STA_CONNECTED          ARDUINO_EVENT_WIFI_STA_CONNECTED
+    #define WM_ESP32_STA_GOT_IP             ARDUINO_EVENT_WIFI_STA_GOT_IP
+    #define WM_ESP32_STA_DISCONNECTED       ARDUINO_EVENT_WIFI_STA_DISCONNECTED
+    #define WM_ESP32_DISCONNECTED_INFO(i)   ((i).wifi_sta_disconnected)
+  #else
+    #define WM_ESP32_STA_CONNECTED          SYSTEM_EVENT_STA_CONNECTED
+    #define WM_ESP32_STA_GOT_IP             SYSTEM_EVENT_STA_GOT_IP
+    #define WM_ESP32_STA_DISCONNECTED       SYSTEM_EVENT_STA_DISCONNECTED
+    #define WM_ESP32_DISCONNECTED_INFO(i)   ((i).disconnected)
+  #endif
+#endif
+
+////////////////////////////////////////////////////
+
+// Lock-free single producer, single consumer ring. push() only from the producer, pop() and clear() only from the
+// consumer. One slot stays empty, so SIZE - 1 items fit
+template<typename T, uint16_t SIZE>
+class WM_SPSCQueue
+{
+    static_assert( (SIZE >= 2) && ((SIZE & (SIZE - 1)) == 0), "WM_SPSCQueue SIZE must be a power of 2");
+
+  public:
+
+    // False, and the item dropped, if full
+    bool push(const T& item)
+    {
+      uint16_t head = _head.load(std::memory_order_relaxed);
+      uint16_t next = (head + 1) & (SIZE - 1);
+
+      if (next == _tail.load(std::memory_order_acquire))
+        return false;
+
+      _items[head] = item;
+      _head.store(next, std::memory_order_release);
+
+      return true;
+    }
+
+    bool pop(T& item)
+    {
+      uint16_t tail = _tail.load(std::memory_order_relaxed);
+
+      if (tail == _head.load(std::memory_order_acquire))
+        return false;
+
+      item = _items[tail];
+      _tail.store((tail + 1) & (SIZE - 1), std::memory_order_release);
+
+      return true;
+    }
+
+    void clear()
+    {
+      _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+  private:
+
+    T                     _items[SIZE];
+    std::atomic<uint16_t> _head { 0 };
+    std::atomic<uint16_t> _tail { 0 };
+};
+
+////////////////////////////////////////////////////
+
+// ESP32 time (ms) on each channel of a channel-targeted scan
+#ifndef WM_KNOWN_SCAN_CHANNEL_TIME
+  #define WM_KNOWN_SCAN_CHANNEL_TIME  300
+#endif
+
+// Cores whose scanNetworks() can scan a single channel. ESP32 core v2+ passes it on in wifi_scan_config_t
+#if ( defined(ESP8266) || ( defined(ESP_ARDUINO_VERSION_MAJOR) && (ESP_ARDUINO_VERSION_MAJOR >= 2) ) )
+  #define WM_CHANNEL_SCAN             true
+#else
+  #define WM_CHANNEL_SCAN             false
+#endif
+
+////////////////////////////////////////////////////
+
 #define WFM_LABEL_BEFORE			1
 #define WFM_LABEL_AFTER				2
 #define WFM_NO_LABEL          0
@@ -190,18 +661,160 @@ typedef struct
 
 ////////////////////////////////////////////////////
 
+// Placeholders used in the HTML / JSON templates, such as {v}, {i} or {x1}
+typedef enum
+{
+  WM_TOKEN_V = 0,     // {v}
+  WM_TOKEN_I,         // {i}
+  WM_TOKEN_R,         // {r}
+  WM_TOKEN_N,         // {n}
+  WM_TOKEN_P,         // {p}
+  WM_TOKEN_L,         // {l}
+  WM_TOKEN_C,         // {c},  custom HTML, or channel
+  WM_TOKEN_X,         // {x},  SSID
+  WM_TOKEN_X1,        // {x1}, SSID1
+  WM_TOKEN_W,         // {w},  PWD
+  WM_TOKEN_W1,        // {w1}, PWD1
+  WM_TOKEN_A,         // {a},  APs sharing an SSID
+  WM_TOKEN_B,         // {b},  BSSID
+  WM_TOKEN_COUNT,
+  WM_TOKEN_NONE = 0xFF
+} WM_Token;
+
+// A template is split at compile time into segments. Each segment is a literal run of the template,
+// followed by the token to be substituted after it (WM_TOKEN_NONE for the last segment).
+// Rendering is then one linear pass, without intermediate String nor String::replace()
+typedef struct
+{
+  uint16_t  start;
+  uint16_t  len;
+  uint8_t   token;
+} WM_TemplateSeg;
+
+////////////////////////////////////////////////////
+
+constexpr uint8_t wmTokenId(const char c)
+{
+  return (c == 'v') ? WM_TOKEN_V : (c == 'i') ? WM_TOKEN_I : (c == 'r') ? WM_TOKEN_R : (c == 'n') ? WM_TOKEN_N :
+         (c == 'p') ? WM_TOKEN_P : (c == 'l') ? WM_TOKEN_L : (c == 'c') ? WM_TOKEN_C : (c == 'x') ? WM_TOKEN_X :
+         (c == 'w') ? WM_TOKEN_W : (c == 'a') ? WM_TOKEN_A : (c == 'b') ? WM_TOKEN_B : WM_TOKEN_NONE;
+}
+
+// Token starting at s, or WM_TOKEN_NONE
+constexpr uint8_t wmTokenAt(const char* s)
+{
+  return ( (s[0] != '{') || (s[1] == 0) || (s[2] == 0) ) ? (uint8_t) WM_TOKEN_NONE :
+         (s[2] == '}') ? wmTokenId(s[1]) :
+         ( (s[2] != '1') || (s[3] != '}') ) ? (uint8_t) WM_TOKEN_NONE :
+         (s[1] == 'x') ? (uint8_t) WM_TOKEN_X1 : (s[1] == 'w') ? (uint8_t) WM_TOKEN_W1 : (uint8_t) WM_TOKEN_NONE;
+}
+
+constexpr uint16_t wmTokenEnd(const char* s, const uint16_t pos)
+{
+  return pos + ( ( (wmTokenAt(s + pos) == WM_TOKEN_X1) || (wmTokenAt(s + pos) == WM_TOKEN_W1) ) ? 4 : 3 );
+}
+
+// Position of the first token at or after pos, or of the terminating NUL
+constexpr uint16_t wmFindToken(const char* s, const uint16_t pos)
+{
+  return ( (s[pos] == 0) || (wmTokenAt(s + pos) != WM_TOKEN_NONE) ) ? pos : wmFindToken(s, pos + 1);
+}
+
+constexpr uint16_t wmSegStart(const char* s, const uint8_t seg)
+{
+  return (seg == 0) ? 0 : wmTokenEnd(s, wmFindToken(s, wmSegStart(s, seg - 1)));
+}
+
+constexpr uint16_t wmSegLen(const char* s, const uint8_t seg)
+{
+  return wmFindToken(s, wmSegStart(s, seg)) - wmSegStart(s, seg);
+}
+
+constexpr uint8_t wmSegToken(const char* s, const uint8_t seg)
+{
+  return wmTokenAt(s + wmFindToken(s, wmSegStart(s, seg)));
+}
+
+constexpr uint8_t wmSegCountAt(const char* s, const uint16_t tokenPos)
+{
+  return (s[tokenPos] == 0) ? 1 : 1 + wmSegCountAt(s, wmFindToken(s, wmTokenEnd(s, tokenPos)));
+}
+
+constexpr uint8_t wmSegCount(const char* s)
+{
+  return wmSegCountAt(s, wmFindToken(s, 0));
+}
+
+#define WM_TEMPLATE_SEG(tpl, seg)       { wmSegStart(tpl, seg), wmSegLen(tpl, seg), wmSegToken(tpl, seg) }
+
+// Verify at compile time that the segment table covers the whole template
+#define WM_TEMPLATE_CHECK(tpl)          static_assert(sizeof(tpl##_SEGS) / sizeof(WM_TemplateSeg) == wmSegCount(tpl), \
+                                                      #tpl "_SEGS must have one entry per token, plus one")
+
+// To pass template and its segments to ESP_WiFiManager::pageAddTemplate()
+#define WM_TEMPLATE(tpl)                tpl, tpl##_SEGS, sizeof(tpl##_SEGS) / sizeof(WM_TemplateSeg)
+
+////////////////////////////////////////////////////
+
+#define WM_FNV1A_INIT                   0x811C9DC5UL
+
+// 32-bit FNV-1a, chainable through hash
+inline uint32_t wmFnv1a(const void* data, const size_t& len, uint32_t hash = WM_FNV1A_INIT)
+{
+  const uint8_t* p = (const uint8_t*) data;
+
+  for (size_t i = 0; i < len; i++)
+  {
+    hash = (hash ^ p[i]) * 0x01000193UL;
+  }
+
+  return hash;
+}
+
+// CRC-32 (IEEE 802.3), bitwise, no table
+inline uint32_t wmCrc32(const void* data, const size_t& len)
+{
+  const uint8_t* p   = (const uint8_t*) data;
+  uint32_t       crc = 0xFFFFFFFFUL;
+
+  for (size_t i = 0; i < len; i++)
+  {
+    crc ^= p[i];
+
+    for (uint8_t bit = 0; bit < 8; bit++)
+    {
+      crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+    }
+  }
+
+  return ~crc;
+}
+
+// "AA:BB:CC:DD:EE:FF" into buf[18]
+inline void wmBssidToString(const uint8_t* bssid, char* buf)
+{
+  snprintf(buf, 18, "%02X:%02X:%02X:%02X:%02X:%02X", bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
+}
+
+////////////////////////////////////////////////////
+
 //KH
 //Mofidy HTTP_HEAD to WM_HTTP_HEAD_START to avoid conflict in Arduino esp8266 core 2.6.0+
 const char WM_HTTP_200[] PROGMEM = "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\n\r\n";
-const char WM_HTTP_HEAD_START[] PROGMEM = "<!DOCTYPE html><html lang='en'><head><meta name='viewport' content='width=device-width, initial-scale=1, user-scalable=no'/><title>{v}</title>";
+constexpr char WM_HTTP_HEAD_START[] PROGMEM = "<!DOCTYPE html><html lang='en'><head><meta name='viewport' content='width=device-width, initial-scale=1, user-scalable=no'/><title>{v}</title>";
 
-////////////////////////////////////////////////////
+constexpr WM_TemplateSeg WM_HTTP_HEAD_START_SEGS[] PROGMEM =
+{
+  WM_TEMPLATE_SEG(WM_HTTP_HEAD_START, 0), WM_TEMPLATE_SEG(WM_HTTP_HEAD_START, 1)
+};
 
-const char WM_HTTP_STYLE[] PROGMEM = "<style>div{padding:2px;font-size:1em;}body,textarea,input,select{background: 0;border-radius: 0;font: 16px sans-serif;margin: 0}textarea,input,select{outline: 0;font-size: 14px;border: 1px solid #ccc;padding: 8px;width: 90%}.btn a{text-decoration: none}.container{margin: auto;width: 90%}@media(min-width:1200px){.container{margin: auto;width: 30%}}@media(min-width:768px) and (max-width:1200px){.container{margin: auto;width: 50%}}.btn,h2{font-size: 2em}h1{font-size: 3em}.btn{background: #0ae;border-radius: 4px;border: 0;color: #fff;cursor: pointer;display: inline-block;margin: 2px 0;padding: 10px 14px 11px;width: 100%}.btn:hover{background: #09d}.btn:active,.btn:focus{background: #08b}label>*{display: inline}form>*{display: block;margin-bottom: 10px}textarea:focus,input:focus,select:focus{border-color: #5ab}.msg{background: #def;border-left: 5px solid #59d;padding: 1.5em}.q{float: right;width: 64px;text-align: right}.l{background: url('data:image/png;base64,iVBORw0KGgoAAAANSUhEUgAAACAAAAAgCAMAAABEpIrGAAAALVBMVEX///8EBwfBwsLw8PAzNjaCg4NTVVUjJiZDRUUUFxdiZGSho6OSk5Pg4eFydHTCjaf3AAAAZElEQVQ4je2NSw7AIAhEBamKn97/uMXEGBvozkWb9C2Zx4xzWykBhFAeYp9gkLyZE0zIMno9n4g19hmdY39scwqVkOXaxph0ZCXQcqxSpgQpONa59wkRDOL93eAXvimwlbPbwwVAegLS1HGfZAAAAABJRU5ErkJggg==') no-repeat left center;background-size: 1em}input[type='checkbox']{float: left;width: 20px}.table td{padding:.5em;text-align:left}.table tbody>:nth-child(2n-1){background:#ddd}fieldset{border-radius:0.5rem;margin:0px;}</style>";
+WM_TEMPLATE_CHECK(WM_HTTP_HEAD_START);
 
 ////////////////////////////////////////////////////
 
-const char WM_HTTP_SCRIPT[] PROGMEM = "<script>function c(l){document.getElementById('s').value=l.innerText||l.textContent;document.getElementById('p').focus();document.getElementById('s1').value=l.innerText||l.textContent;document.getElementById('p1').focus();document.getElementById('timezone').value=timezone.name();}</script>";
+// Stylesheet and scripts are served gzipped and cacheable from /wm.css and /wm.js instead of inlined in every page.
+// To change them, edit utils/wm_assets and rerun utils/gen_wm_assets.py
+#include "utils/WM_Assets.h"
 
 ////////////////////////////////////////////////////
 ////////////////////////////////////////////////////
@@ -221,17 +834,6 @@ const char WM_HTTP_SCRIPT[] PROGMEM = "<script>function c(l){document.getElement
 const char WM_HTTP_SCRIPT_NTP_MSG[] PROGMEM = "<p>Your Timezone is : <b><label id='timezone' name='timezone'></b><script>document.getElementById('timezone').innerHTML=timezone.name();document.getElementById('timezone').value=timezone.name();</script></p>";
 const char WM_HTTP_SCRIPT_NTP_HIDDEN[] PROGMEM = "<p><input type='hidden' id='timezone' name='timezone'><script>document.getElementById('timezone').innerHTML=timezone.name();document.getElementById('timezone').value=timezone.name();</script></p>";
 
-#if ESP8266
-  #if !(USE_CLOUDFLARE_NTP)
-    #undef USE_CLOUDFLARE_NTP
-    #define USE_CLOUDFLARE_NTP      true
-    
-    #if (_WIFIMGR_LOGLEVEL_ > 3)
-    	#warning Forcing USE_CLOUDFLARE_NTP for ESP8266 as low memory can cause blank page
-    #endif
-  #endif
-#endif
-
 // To permit disable or configure NTP from sketch
 #ifndef USE_CLOUDFLARE_NTP
   #define USE_CLOUDFLARE_NTP          false
@@ -240,7 +842,8 @@ const char WM_HTTP_SCRIPT_NTP_HIDDEN[] PROGMEM = "<p><input type='hidden' id='ti
 #if USE_CLOUDFLARE_NTP
 const char WM_HTTP_SCRIPT_NTP[] PROGMEM = "<script src='https://cdnjs.cloudflare.com/ajax/libs/jstimezonedetect/1.0.7/jstz.min.js'></script><script>var timezone=jstz.determine();console.log('Your CloudFlare timezone is:' + timezone.name());document.getElementById('timezone').innerHTML = timezone.name();</script>";
 #else
-const char WM_HTTP_SCRIPT_NTP[] PROGMEM = "<script>(function(e){var t=function(){'use strict';var e='s',n=function(e){var t=-e.getTimezoneOffset();return t!==null?t:0},r=function(e,t,n){var r=new Date;return e!==undefined&&r.setFullYear(e),r.setDate(n),r.setMonth(t),r},i=function(e){return n(r(e,0,2))},s=function(e){return n(r(e,5,2))},o=function(e){var t=e.getMonth()>7?s(e.getFullYear()):i(e.getFullYear()),r=n(e);return t-r!==0},u=function(){var t=i(),n=s(),r=i()-s();return r<0?t+',1':r>0?n+',1,'+e:t+',0'},a=function(){var e=u();return new t.TimeZone(t.olson.timezones[e])},f=function(e){var t=new Date(2010,6,15,1,0,0,0),n={'America/Denver':new Date(2011,2,13,3,0,0,0),'America/Mazatlan':new Date(2011,3,3,3,0,0,0),'America/Chicago':new Date(2011,2,13,3,0,0,0),'America/Mexico_City':new Date(2011,3,3,3,0,0,0),'America/Asuncion':new Date(2012,9,7,3,0,0,0),'America/Santiago':new Date(2012,9,3,3,0,0,0),'America/Campo_Grande':new Date(2012,9,21,5,0,0,0),'America/Montevideo':new Date(2011,9,2,3,0,0,0),'America/Sao_Paulo':new Date(2011,9,16,5,0,0,0),'America/Los_Angeles':new Date(2011,2,13,8,0,0,0),'America/Santa_Isabel':new Date(2011,3,5,8,0,0,0),'America/Havana':new Date(2012,2,10,2,0,0,0),'America/New_York':new Date(2012,2,10,7,0,0,0),'Asia/Beirut':new Date(2011,2,27,1,0,0,0),'Europe/Helsinki':new Date(2011,2,27,4,0,0,0),'Europe/Istanbul':new Date(2011,2,28,5,0,0,0),'Asia/Damascus':new Date(2011,3,1,2,0,0,0),'Asia/Jerusalem':new Date(2011,3,1,6,0,0,0),'Asia/Gaza':new Date(2009,2,28,0,30,0,0),'Africa/Cairo':new Date(2009,3,25,0,30,0,0),'Pacific/Auckland':new Date(2011,8,26,7,0,0,0),'Pacific/Fiji':new Date(2010,11,29,23,0,0,0),'America/Halifax':new Date(2011,2,13,6,0,0,0),'America/Goose_Bay':new Date(2011,2,13,2,1,0,0),'America/Miquelon':new Date(2011,2,13,5,0,0,0),'America/Godthab':new Date(2011,2,27,1,0,0,0),'Europe/Moscow':t,'Asia/Yekaterinburg':t,'Asia/Omsk':t,'Asia/Krasnoyarsk':t,'Asia/Irkutsk':t,'Asia/Yakutsk':t,'Asia/Vladivostok':t,'Asia/Kamchatka':t,'Europe/Minsk':t,'Australia/Perth':new Date(2008,10,1,1,0,0,0)};return n[e]};return{determine:a,date_is_dst:o,dst_start_for:f}}();t.TimeZone=function(e){'use strict';var n={'America/Denver':['America/Denver','America/Mazatlan'],'America/Chicago':['America/Chicago','America/Mexico_City'],'America/Santiago':['America/Santiago','America/Asuncion','America/Campo_Grande'],'America/Montevideo':['America/Montevideo','America/Sao_Paulo'],'Asia/Beirut':['Asia/Beirut','Europe/Helsinki','Europe/Istanbul','Asia/Damascus','Asia/Jerusalem','Asia/Gaza'],'Pacific/Auckland':['Pacific/Auckland','Pacific/Fiji'],'America/Los_Angeles':['America/Los_Angeles','America/Santa_Isabel'],'America/New_York':['America/Havana','America/New_York'],'America/Halifax':['America/Goose_Bay','America/Halifax'],'America/Godthab':['America/Miquelon','America/Godthab'],'Asia/Dubai':['Europe/Moscow'],'Asia/Dhaka':['Asia/Yekaterinburg'],'Asia/Jakarta':['Asia/Omsk'],'Asia/Shanghai':['Asia/Krasnoyarsk','Australia/Perth'],'Asia/Tokyo':['Asia/Irkutsk'],'Australia/Brisbane':['Asia/Yakutsk'],'Pacific/Noumea':['Asia/Vladivostok'],'Pacific/Tarawa':['Asia/Kamchatka'],'Africa/Johannesburg':['Asia/Gaza','Africa/Cairo'],'Asia/Baghdad':['Europe/Minsk']},r=e,i=function(){var e=n[r],i=e.length,s=0,o=e[0];for(;s<i;s+=1){o=e[s];if(t.date_is_dst(t.dst_start_for(o))){r=o;return}}},s=function(){return typeof n[r]!='undefined'};return s()&&i(),{name:function(){return r}}},t.olson={},t.olson.timezones={'-720,0':'Etc/GMT+12','-660,0':'Pacific/Pago_Pago','-600,1':'America/Adak','-600,0':'Pacific/Honolulu','-570,0':'Pacific/Marquesas','-540,0':'Pacific/Gambier','-540,1':'America/Anchorage','-480,1':'America/Los_Angeles','-480,0':'Pacific/Pitcairn','-420,0':'America/Phoenix','-420,1':'America/Denver','-360,0':'America/Guatemala','-360,1':'America/Chicago','-360,1,s':'Pacific/Easter','-300,0':'America/Bogota','-300,1':'America/New_York','-270,0':'America/Caracas','-240,1':'America/Halifax','-240,0':'America/Santo_Domingo','-240,1,s':'America/Santiago','-210,1':'America/St_Johns','-180,1':'America/Godthab','-180,0':'America/Argentina/Buenos_Aires','-180,1,s':'America/Montevideo','-120,0':'Etc/GMT+2','-120,1':'Etc/GMT+2','-60,1':'Atlantic/Azores','-60,0':'Atlantic/Cape_Verde','0,0':'Etc/UTC','0,1':'Europe/London','60,1':'Europe/Berlin','60,0':'Africa/Lagos','60,1,s':'Africa/Windhoek','120,1':'Asia/Beirut','120,0':'Africa/Johannesburg','180,0':'Asia/Baghdad','180,1':'Europe/Moscow','210,1':'Asia/Tehran','240,0':'Asia/Dubai','240,1':'Asia/Baku','270,0':'Asia/Kabul','300,1':'Asia/Yekaterinburg','300,0':'Asia/Karachi','330,0':'Asia/Kolkata','345,0':'Asia/Kathmandu','360,0':'Asia/Dhaka','360,1':'Asia/Omsk','390,0':'Asia/Rangoon','420,1':'Asia/Krasnoyarsk','420,0':'Asia/Jakarta','480,0':'Asia/Shanghai','480,1':'Asia/Irkutsk','525,0':'Australia/Eucla','525,1,s':'Australia/Eucla','540,1':'Asia/Yakutsk','540,0':'Asia/Tokyo','570,0':'Australia/Darwin','570,1,s':'Australia/Adelaide','600,0':'Australia/Brisbane','600,1':'Asia/Vladivostok','600,1,s':'Australia/Sydney','630,1,s':'Australia/Lord_Howe','660,1':'Asia/Kamchatka','660,0':'Pacific/Noumea','690,0':'Pacific/Norfolk','720,1,s':'Pacific/Auckland','720,0':'Pacific/Tarawa','765,1,s':'Pacific/Chatham','780,0':'Pacific/Tongatapu','780,1,s':'Pacific/Apia','840,0':'Pacific/Kiritimati'},typeof exports!='undefined'?exports.jstz=t:e.jstz=t})(this);</script><script>var timezone=jstz.determine();console.log('Your Timezone is:' + timezone.name());document.getElementById('timezone').innerHTML = timezone.name();</script>";
+// jstz is bundled into /wm.js
+const char WM_HTTP_SCRIPT_NTP[] PROGMEM = "";
 #endif
 
 #else
@@ -252,6 +855,15 @@ const char WM_HTTP_SCRIPT_NTP[] PROGMEM = "<script>(function(e){var t=function()
 ////////////////////////////////////////////////////
 ////////////////////////////////////////////////////
 
+// The asset URLs carry the content hash so they can be cached for good and still change with the firmware
+#if (USE_ESP_WIFIMANAGER_NTP && !USE_CLOUDFLARE_NTP)
+  #define WM_ASSET_JS_SERVED_VER      WM_ASSET_JS_NTP_VER
+#else
+  #define WM_ASSET_JS_SERVED_VER      WM_ASSET_JS_VER
+#endif
+
+const char WM_HTTP_HEAD_ASSETS[] PROGMEM = "<link rel='stylesheet' href='/wm.css?v=" WM_ASSET_CSS_VER "'><script src='/wm.js?v=" WM_ASSET_JS_SERVED_VER "'></script>";
+
 const char WM_HTTP_HEAD_END[] PROGMEM = "</head><body><div class='container'><div style='text-align:left;display:inline-block;min-width:260px;'>";
 
 const char WM_FLDSET_START[]  PROGMEM = "<fieldset>";
@@ -260,8 +872,37 @@ const char WM_FLDSET_END[]    PROGMEM = "</fieldset>";
 ////////////////////////////////////////////////////
 
 const char WM_HTTP_PORTAL_OPTIONS[] PROGMEM = "<form action='/wifi' method='get'><button class='btn'>Configuration</button></form><br/><form action='/i' method='get'><button class='btn'>Information</button></form><br/><form action='/close' method='get'><button class='btn'>Exit Portal</button></form><br/>";
-const char WM_HTTP_ITEM[] PROGMEM = "<div><a href='#p' onclick='c(this)'>{v}</a>&nbsp;<span class='q {i}'>{r}%</span></div>";
-const char JSON_ITEM[] PROGMEM    = "{\"SSID\":\"{v}\", \"Encryption\":{i}, \"Quality\":\"{r}\"}";
+constexpr char WM_HTTP_ITEM[] PROGMEM = "<div><a href='#p' onclick='c(this)'>{v}</a>{a}&nbsp;<span class='q {i}'>{r}%</span></div>";
+const char WM_HTTP_ITEM_APS[] PROGMEM = "&nbsp;<small>%u APs</small>";
+const char WM_HTTP_SCAN_AGE[] PROGMEM = "<small>Scanned %lu s ago. <a href='/wifi?refresh=1'>Scan again</a></small><br/>";
+constexpr char JSON_ITEM[] PROGMEM    = "{\"SSID\":\"{v}\", \"Encryption\":{i}, \"Quality\":\"{r}\", \"APs\":{a}, \"BSSID\":\"{b}\", \"Channel\":{c}}";
+
+constexpr WM_TemplateSeg WM_HTTP_ITEM_SEGS[] PROGMEM =
+{
+  WM_TEMPLATE_SEG(WM_HTTP_ITEM, 0), WM_TEMPLATE_SEG(WM_HTTP_ITEM, 1), WM_TEMPLATE_SEG(WM_HTTP_ITEM, 2),
+  WM_TEMPLATE_SEG(WM_HTTP_ITEM, 3), WM_TEMPLATE_SEG(WM_HTTP_ITEM, 4)
+};
+
+constexpr WM_TemplateSeg JSON_ITEM_SEGS[] PROGMEM =
+{
+  WM_TEMPLATE_SEG(JSON_ITEM, 0), WM_TEMPLATE_SEG(JSON_ITEM, 1), WM_TEMPLATE_SEG(JSON_ITEM, 2),
+  WM_TEMPLATE_SEG(JSON_ITEM, 3), WM_TEMPLATE_SEG(JSON_ITEM, 4), WM_TEMPLATE_SEG(JSON_ITEM, 5),
+  WM_TEMPLATE_SEG(JSON_ITEM, 6)
+};
+
+WM_TEMPLATE_CHECK(WM_HTTP_ITEM);
+WM_TEMPLATE_CHECK(JSON_ITEM);
+
+// /status, polled by the saved page
+constexpr char JSON_STATUS[] PROGMEM  = "{\"State\":\"{v}\",\"SSID\":\"{x}\",\"Result\":\"{r}\",\"IP\":\"{i}\"}";
+
+constexpr WM_TemplateSeg JSON_STATUS_SEGS[] PROGMEM =
+{
+  WM_TEMPLATE_SEG(JSON_STATUS, 0), WM_TEMPLATE_SEG(JSON_STATUS, 1), WM_TEMPLATE_SEG(JSON_STATUS, 2),
+  WM_TEMPLATE_SEG(JSON_STATUS, 3), WM_TEMPLATE_SEG(JSON_STATUS, 4)
+};
+
+WM_TEMPLATE_CHECK(JSON_STATUS);
 
 ////////////////////////////////////////////////////
 
@@ -276,20 +917,67 @@ const char JSON_ITEM[] PROGMEM    = "{\"SSID\":\"{v}\", \"Encryption\":{i}, \"Qu
 #endif
 
 #if DISPLAY_STORED_CREDENTIALS_IN_CP
-const char WM_HTTP_FORM_START[] PROGMEM = "<form method='get' action='wifisave'><fieldset><div><label>SSID</label><input value='[[ssid]]' id='s' name='s' length=32 placeholder='SSID'><div></div></div><div><label>Password</label><input value='[[pwd]]' id='p' name='p' length=64 placeholder='password'><div></div></div><div><label>SSID1</label><input value='[[ssid1]]' id='s1' name='s1' length=32 placeholder='SSID1'><div></div></div><div><label>Password</label><input value='[[pwd1]]' id='p1' name='p1' length=64 placeholder='password1'><div></div></div></fieldset>";
+constexpr char WM_HTTP_FORM_START[] PROGMEM = "<form method='get' action='wifisave'><fieldset><div><label>SSID</label><input value='{x}' id='s' name='s' length=32 placeholder='SSID'><div></div></div><div><label>Password</label><input value='{w}' id='p' name='p' length=64 placeholder='password'><div></div></div><div><label>SSID1</label><input value='{x1}' id='s1' name='s1' length=32 placeholder='SSID1'><div></div></div><div><label>Password</label><input value='{w1}' id='p1' name='p1' length=64 placeholder='password1'><div></div></div></fieldset>";
+
+constexpr WM_TemplateSeg WM_HTTP_FORM_START_SEGS[] PROGMEM =
+{
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_START, 0), WM_TEMPLATE_SEG(WM_HTTP_FORM_START, 1),
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_START, 2), WM_TEMPLATE_SEG(WM_HTTP_FORM_START, 3),
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_START, 4)
+};
+
+WM_TEMPLATE_CHECK(WM_HTTP_FORM_START);
 #else
 const char WM_HTTP_FORM_START[] PROGMEM = "<form method='get' action='wifisave'><fieldset><div><label>SSID</label><input id='s' name='s' length=32 placeholder='SSID'><div></div></div><div><label>Password</label><input id='p' name='p' length=64 placeholder='password'><div></div></div><div><label>SSID1</label><input id='s1' name='s1' length=32 placeholder='SSID1'><div></div></div><div><label>Password</label><input id='p1' name='p1' length=64 placeholder='password1'><div></div></div></fieldset>";
 #endif
 
 ////////////////////////////////////////////////////
 
-const char WM_HTTP_FORM_LABEL_BEFORE[] PROGMEM = "<div><label for='{i}'>{p}</label><input id='{i}' name='{n}' length={l} placeholder='{p}' value='{v}' {c}><div></div></div>";
-const char WM_HTTP_FORM_LABEL_AFTER[] PROGMEM = "<div><input id='{i}' name='{n}' length={l} placeholder='{p}' value='{v}' {c}><label for='{i}'>{p}</label><div></div></div>";
+constexpr char WM_HTTP_FORM_LABEL_BEFORE[] PROGMEM = "<div><label for='{i}'>{p}</label><input id='{i}' name='{n}' length={l} placeholder='{p}' value='{v}' {c}><div></div></div>";
+constexpr char WM_HTTP_FORM_LABEL_AFTER[] PROGMEM = "<div><input id='{i}' name='{n}' length={l} placeholder='{p}' value='{v}' {c}><label for='{i}'>{p}</label><div></div></div>";
+
+constexpr WM_TemplateSeg WM_HTTP_FORM_LABEL_BEFORE_SEGS[] PROGMEM =
+{
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_BEFORE, 0), WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_BEFORE, 1),
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_BEFORE, 2), WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_BEFORE, 3),
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_BEFORE, 4), WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_BEFORE, 5),
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_BEFORE, 6), WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_BEFORE, 7),
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_BEFORE, 8)
+};
+
+constexpr WM_TemplateSeg WM_HTTP_FORM_LABEL_AFTER_SEGS[] PROGMEM =
+{
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_AFTER, 0), WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_AFTER, 1),
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_AFTER, 2), WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_AFTER, 3),
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_AFTER, 4), WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_AFTER, 5),
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_AFTER, 6), WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_AFTER, 7),
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL_AFTER, 8)
+};
+
+WM_TEMPLATE_CHECK(WM_HTTP_FORM_LABEL_BEFORE);
+WM_TEMPLATE_CHECK(WM_HTTP_FORM_LABEL_AFTER);
 
 ////////////////////////////////////////////////////
 
-const char WM_HTTP_FORM_LABEL[] PROGMEM = "<label for='{i}'>{p}</label>";
-const char WM_HTTP_FORM_PARAM[] PROGMEM = "<input id='{i}' name='{n}' length={l} placeholder='{p}' value='{v}' {c}>";
+constexpr char WM_HTTP_FORM_LABEL[] PROGMEM = "<label for='{i}'>{p}</label>";
+constexpr char WM_HTTP_FORM_PARAM[] PROGMEM = "<input id='{i}' name='{n}' length={l} placeholder='{p}' value='{v}' {c}>";
+
+constexpr WM_TemplateSeg WM_HTTP_FORM_LABEL_SEGS[] PROGMEM =
+{
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL, 0), WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL, 1),
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_LABEL, 2)
+};
+
+constexpr WM_TemplateSeg WM_HTTP_FORM_PARAM_SEGS[] PROGMEM =
+{
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_PARAM, 0), WM_TEMPLATE_SEG(WM_HTTP_FORM_PARAM, 1),
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_PARAM, 2), WM_TEMPLATE_SEG(WM_HTTP_FORM_PARAM, 3),
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_PARAM, 4), WM_TEMPLATE_SEG(WM_HTTP_FORM_PARAM, 5),
+  WM_TEMPLATE_SEG(WM_HTTP_FORM_PARAM, 6)
+};
+
+WM_TEMPLATE_CHECK(WM_HTTP_FORM_LABEL);
+WM_TEMPLATE_CHECK(WM_HTTP_FORM_PARAM);
 
 ////////////////////////////////////////////////////
 
@@ -297,7 +985,16 @@ const char WM_HTTP_FORM_END[] PROGMEM = "<button class='btn' type='submit'>Save<
 
 ////////////////////////////////////////////////////
 
-const char WM_HTTP_SAVED[] PROGMEM = "<div class='msg'><b>Credentials Saved</b><br>Try connecting ESP to the {x}/{x1} network. Wait around 10 seconds then check <a href='/'>if it's OK.</a> <p/>The {v} AP will run on the same WiFi channel of the {x}/{x1} AP. You may have to manually reconnect to the {v} AP.</div>";
+constexpr char WM_HTTP_SAVED[] PROGMEM = "<div class='msg'><b>Credentials Saved</b><br>Trying to connect ESP to the {x}/{x1} network : <b id='st'>Waiting</b><script>st()</script><p/>The {v} AP will run on the same WiFi channel of the {x}/{x1} AP. You may have to manually reconnect to the {v} AP.</div>";
+
+constexpr WM_TemplateSeg WM_HTTP_SAVED_SEGS[] PROGMEM =
+{
+  WM_TEMPLATE_SEG(WM_HTTP_SAVED, 0), WM_TEMPLATE_SEG(WM_HTTP_SAVED, 1), WM_TEMPLATE_SEG(WM_HTTP_SAVED, 2),
+  WM_TEMPLATE_SEG(WM_HTTP_SAVED, 3), WM_TEMPLATE_SEG(WM_HTTP_SAVED, 4), WM_TEMPLATE_SEG(WM_HTTP_SAVED, 5),
+  WM_TEMPLATE_SEG(WM_HTTP_SAVED, 6)
+};
+
+WM_TEMPLATE_CHECK(WM_HTTP_SAVED);
 
 ////////////////////////////////////////////////////
 
@@ -316,12 +1013,59 @@ const char WM_HTTP_PRAGMA[]          PROGMEM = "Pragma";
 const char WM_HTTP_NO_CACHE[]        PROGMEM = "no-cache";
 const char WM_HTTP_EXPIRES[]         PROGMEM = "Expires";
 const char WM_HTTP_CORS[]            PROGMEM = "Access-Control-Allow-Origin";
+const char WM_HTTP_CONTENT_ENCODING[] PROGMEM = "Content-Encoding";
+const char WM_HTTP_GZIP[]            PROGMEM = "gzip";
+const char WM_HTTP_ETAG[]            PROGMEM = "ETag";
+const char WM_HTTP_IF_NONE_MATCH[]   PROGMEM = "If-None-Match";
+const char WM_HTTP_CACHE_FOREVER[]   PROGMEM = "public, max-age=31536000, immutable";
+const char WM_HTTP_AGE[]             PROGMEM = "Age";
+
+// /metrics, Prometheus text format
+const char WM_METRICS_PHASE_HEAD[]   PROGMEM = "# HELP wm_connect_phase_ms Connection phase time over the last attempts\n"
+                                               "# TYPE wm_connect_phase_ms gauge\n";
+const char WM_METRICS_PHASE[]        PROGMEM = "wm_connect_phase_ms{phase=\"%s\",stat=\"%s\"} %u\n";
+const char WM_METRICS_COUNTERS[]     PROGMEM = "# TYPE wm_connect_attempts gauge\nwm_connect_attempts %u\n"
+                                               "# TYPE wm_connect_connected gauge\nwm_connect_connected %u\n"
+                                               "# TYPE wm_connect_last_result gauge\nwm_connect_last_result %u\n";
+const char WM_METRICS_SCAN[]         PROGMEM = "# TYPE wm_scan_known_total counter\nwm_scan_known_total %u\n"
+                                               "# TYPE wm_scan_full_total counter\nwm_scan_full_total %u\n"
+                                               "# TYPE wm_scan_last_ms gauge\nwm_scan_last_ms %lu\n"
+                                               "# TYPE wm_scan_saved_ms_total counter\nwm_scan_saved_ms_total %lu\n";
+const char WM_METRICS_ROAM[]         PROGMEM = "# TYPE wm_roam_total counter\nwm_roam_total %u\n"
+                                               "# TYPE wm_roam_failed_total counter\nwm_roam_failed_total %u\n"
+                                               "# TYPE wm_roam_rssi_dbm gauge\nwm_roam_rssi_dbm %d\n";
+const char WM_METRICS_MODE[]         PROGMEM = "# TYPE wm_mode_switches_total counter\nwm_mode_switches_total %u\n"
+                                               "# TYPE wm_mode_skipped_total counter\nwm_mode_skipped_total %u\n"
+                                               "# TYPE wm_mode_switch_ms_total counter\nwm_mode_switch_ms_total %lu\n";
+
+// /link
+const char WM_LINK_JSON_HEAD[]       PROGMEM = "{\"Samples\":%u,\"Interval\":%lu,\"Lost\":%u,\"Drops\":%u,"
+                                               "\"RSSI\":{\"P10\":%d,\"P50\":%d,\"P90\":%d},"
+                                               "\"RTT\":{\"P50\":%s,\"P90\":%s,\"Max\":%s},\"History\":[";
+const char WM_LINK_JSON_SAMPLE[]     PROGMEM = "%s{\"Age\":%lu,\"RSSI\":%d,\"RTT\":%s,\"Drops\":%u}";
+
 const char WM_HTTP_CORS_ALLOW_ALL[]  PROGMEM = "*";
 
+// Pre-serialized for WebServer::sendHeaders_P()
+const char WM_HTTP_HEADERS_NO_STORE[] PROGMEM = "Cache-Control: no-cache, no-store, must-revalidate\r\nPragma: no-cache\r\nExpires: -1\r\n";
+
+////////////////////////////////////////////////////
+
+// To stream the Config Portal pages to the client in chunks of WM_PAGE_CHUNK_SIZE instead of building the whole page
+// in one String. Peak heap per page is then bounded, no matter how many parameters or APs are displayed.
+// You have to explicitly specify false to disable the feature.
+#ifndef USE_CHUNKED_CP_PAGES
+  #define USE_CHUNKED_CP_PAGES          true
+#endif
+
+#ifndef WM_PAGE_CHUNK_SIZE
+  #define WM_PAGE_CHUNK_SIZE            256
+#endif
+
 ////////////////////////////////////////////////////
 
 #if USE_AVAILABLE_PAGES
-const char WM_HTTP_AVAILABLE_PAGES[] PROGMEM = "<h3>Available Pages</h3><table class='table'><thead><tr><th>Page</th><th>Function</th></tr></thead><tbody><tr><td><a href='/'>/</a></td><td>Menu page.</td></tr><tr><td><a href='/wifi'>/wifi</a></td><td>Show WiFi scan results and enter WiFi configuration.</td></tr><tr><td><a href='/wifisave'>/wifisave</a></td><td>Save WiFi configuration information and configure device. Needs variables supplied.</td></tr><tr><td><a href='/close'>/close</a></td><td>Close the configuration server and configuration WiFi network.</td></tr><tr><td><a href='/i'>/i</a></td><td>This page.</td></tr><tr><td><a href='/r'>/r</a></td><td>Delete WiFi configuration and reboot. ESP device will not reconnect to a network until new WiFi configuration data is entered.</td></tr><tr><td><a href='/state'>/state</a></td><td>Current device state in JSON format. Interface for programmatic WiFi configuration.</td></tr><tr><td><a href='/scan'>/scan</a></td><td>Run a WiFi scan and return results in JSON format. Interface for programmatic WiFi configuration.</td></tr></table>";
+const char WM_HTTP_AVAILABLE_PAGES[] PROGMEM = "<h3>Available Pages</h3><table class='table'><thead><tr><th>Page</th><th>Function</th></tr></thead><tbody><tr><td><a href='/'>/</a></td><td>Menu page.</td></tr><tr><td><a href='/wifi'>/wifi</a></td><td>Show WiFi scan results and enter WiFi configuration.</td></tr><tr><td><a href='/wifisave'>/wifisave</a></td><td>Save WiFi configuration information and configure device. Needs variables supplied.</td></tr><tr><td><a href='/close'>/close</a></td><td>Close the configuration server and configuration WiFi network.</td></tr><tr><td><a href='/i'>/i</a></td><td>This page.</td></tr><tr><td><a href='/r'>/r</a></td><td>Delete WiFi configuration and reboot. ESP device will not reconnect to a network until new WiFi configuration data is entered.</td></tr><tr><td><a href='/state'>/state</a></td><td>Current device state in JSON format. Interface for programmatic WiFi configuration.</td></tr><tr><td><a href='/status'>/status</a></td><td>Progress of the connection to the saved network in JSON format.</td></tr><tr><td><a href='/scan'>/scan</a></td><td>Run a WiFi scan and return results in JSON format. Interface for programmatic WiFi configuration.</td></tr><tr><td><a href='/metrics'>/metrics</a></td><td>Connection phase timing and scan counters in Prometheus text format.</td></tr><tr><td><a href='/link'>/link</a></td><td>Link-quality samples and percentiles in JSON format.</td></tr></table>";
 #else
 const char WM_HTTP_AVAILABLE_PAGES[] PROGMEM = "";
 #endif
@@ -379,6 +1123,57 @@ class ESP_WMParameter
 
 ////////////////////////////////////////////////////
 
+// Request arguments of /wifisave, copied once into one buffer and indexed by name hash. The buffer starts at
+// WM_ARG_STORE_SIZE and grows to what is submitted, up to 64KB. Arguments past WM_ARG_STORE_MAX_ARGS are left out
+#ifndef WM_ARG_STORE_SIZE
+  #define WM_ARG_STORE_SIZE           1024
+#endif
+
+#ifndef WM_ARG_STORE_MAX_ARGS
+  #define WM_ARG_STORE_MAX_ARGS       48
+#endif
+
+// Open addressing table, power of 2 and > WM_ARG_STORE_MAX_ARGS
+#define WM_ARG_STORE_SLOTS            128
+
+static_assert(WM_ARG_STORE_MAX_ARGS < WM_ARG_STORE_SLOTS, "WM_ARG_STORE_MAX_ARGS must be < WM_ARG_STORE_SLOTS");
+
+class ESP_WMArgStore
+{
+  public:
+    template<typename TServer>
+    void          load(TServer& server);
+    
+    // "" if absent. Views stay valid until the next load()
+    const char*   value(const char* name, size_t* len = NULL) const;
+    bool          has(const char* name) const;
+    
+    // Like String::toCharArray(), at most size - 1 chars plus NUL. An absent arg gives ""
+    size_t        copy(const char* name, char* dst, const size_t& size) const;
+    
+  private:
+    typedef struct
+    {
+      uint16_t  name;
+      uint16_t  value;
+      uint16_t  valueLen;
+    } ArgEntry;
+    
+    bool          add(const char* name, const size_t& nameLen, const char* value, const size_t& valueLen);
+    bool          reserve(const size_t& size);
+    int           find(const char* name) const;
+    
+    std::unique_ptr<char[]> _buf;
+    size_t        _size         = 0;
+    size_t        _used         = 0;
+    ArgEntry      _entries[WM_ARG_STORE_MAX_ARGS];
+    uint8_t       _count        = 0;
+    // entry index + 1, 0 if empty
+    uint8_t       _slots[WM_ARG_STORE_SLOTS];
+};
+
+////////////////////////////////////////////////////
+
 #define USE_DYNAMIC_PARAMS				true
 #define DEFAULT_PORTAL_TIMEOUT  	60000L
 
@@ -393,6 +1188,9 @@ class ESP_WMParameter
 
 class ESP_WiFiManager
 {
+    // Print into the page being sent
+    friend class WM_PagePrint;
+
   public:
 
     ESP_WiFiManager(const char *iHostname = "");
@@ -407,6 +1205,61 @@ class ESP_WiFiManager
     bool          startConfigPortal();
     bool          startConfigPortal(char const *apName, char const *apPassword = NULL);
 
+    // Non-blocking Config Portal. Call process() from loop() until it returns a status >= WM_PORTAL_CONNECTED
+    bool          startConfigPortalAsync();
+    bool          startConfigPortalAsync(char const *apName, char const *apPassword = NULL);
+    WM_PortalStatus process();
+    // Closed by the next process() call, so it's also safe from inside callbacks
+    void          stopConfigPortal();
+
+    WM_PortalStatus getConfigPortalStatus()
+    {
+      return _portalStatus;
+    }
+
+    // Channel-targeted reconnection scans, and the time they saved
+    const WM_ConnectStats& getConnectStats()
+    {
+      return _connectStats;
+    }
+
+    // WiFi mode switches since boot, over all the instances, and the time they took
+    const WM_ModeStats& getModeStats();
+
+    // Non-blocking, call from loop(). Keeps the station connected to the saved networks, best first, retrying with
+    // jittered exponential backoff. Does nothing while the Config Portal runs. Returns true while connected
+    bool          supervise();
+
+    WM_SupervisorState getSupervisorState()
+    {
+      return _supState;
+    }
+
+    // While supervise() keeps the connection, reassociates to another AP of the same SSID when the average RSSI drops
+    // below threshold (dBm) and that AP is stronger by hysteresis (dB) or more. Off by default
+    void          setRoaming(const bool& enable, const int8_t& threshold = WM_ROAM_RSSI_THRESHOLD,
+                             const uint8_t& hysteresis = WM_ROAM_HYSTERESIS);
+
+    // Average RSSI in dBm of the current connection while roaming, 0 if not sampled yet
+    int           getRoamingRSSI()
+    {
+      return _roamRssi / 16;
+    }
+
+    // Samples RSSI, connections lost and gateway RTT every interval ms into a ring of WM_LINK_HISTORY, also served as
+    // JSON by /link. Off by default, the ring allocated when enabled and freed when disabled
+    void          setLinkMonitor(const bool& enable, const unsigned long& interval = WM_LINK_SAMPLE_INTERVAL);
+    // Non-blocking, call from loop(). Already done by supervise()
+    void          monitorLink();
+    WM_LinkStats  getLinkStats();
+    // Copies up to size samples, oldest first. Returns how many
+    uint8_t       getLinkHistory(WM_LinkSample* samples, const uint8_t& size);
+
+    // Per phase timing of the last WM_CONNECT_HISTORY connection attempts
+    WM_ConnectTiming getConnectTiming();
+    // Same with the scan stats, in the Prometheus text format also served by /metrics
+    void          printConnectMetrics(Print& out);
+
     // get the AP name of the config portal, so it can be used in the callback
     String        getConfigPortalSSID();
     
@@ -424,6 +1277,9 @@ class ESP_WiFiManager
     //sets timeout for which to attempt connecting, usefull if you get a lot of failed connects
     void          setConnectTimeout(const unsigned long& seconds);
 
+    //sets the age in seconds after which the Config Portal rescans in the background
+    void          setScanCacheTTL(const unsigned long& seconds);
+
     void          setDebugOutput(bool debug);
     //defaults to not showing anything under 8% signal quality if called
     void          setMinimumSignalQuality(const int& quality = 8);
@@ -466,16 +1322,20 @@ class ESP_WiFiManager
     //if this is set, it will exit after config, even if connection is unsucessful.
     void          setBreakAfterConfig(bool shouldBreak);
     
-    //if this is set, try WPS setup when starting (this will delay config portal for up to 2 mins)
-    //TODO
+    //if this is set, try WPS when the credentials saved without password fail. Up to WM_WPS_TIMEOUT, the
+    //non-blocking portal running meanwhile
+    void          setTryWPS(const bool& tryWPS);
+
     //if this is set, customise style
     void          setCustomHeadElement(const char* element);
     
     //if this is true, remove duplicated Access Points - defaut true
     void          setRemoveDuplicateAPs(bool removeDuplicates);
     
-    //Scan for WiFiNetworks in range and sort by signal strength
-    //space for indices array allocated on the heap and should be freed when no longer required
+    //Scan for WiFiNetworks in range and sort by signal strength, without duplicates or low quality APs
+    //space for results array allocated on the heap and should be freed when no longer required
+    int           scanWifiNetworks(WM_ScanResult **resultsptr);
+    // Same, as driver scan indices
     int           scanWifiNetworks(int **indicesptr);
 
 ////////////////////////////////////////////////////
@@ -483,18 +1343,23 @@ class ESP_WiFiManager
     // KH add to display SSIDs and PWDs in CP   
     void				  setCredentials(const char* ssid, const char* pwd, const char* ssid1, const char* pwd1)
     {
-      _ssid   = String(ssid);
-      _pass   = String(pwd);
-      _ssid1  = String(ssid1);
-      _pass1  = String(pwd1);
+      setCredential(0, String(ssid), String(pwd));
+      setCredential(1, String(ssid1), String(pwd1));
     }
     
     inline void	  setCredentials(String & ssid, String & pwd, String & ssid1, String & pwd1)
     {
-      _ssid   = ssid;
-      _pass   = pwd;
-      _ssid1  = ssid1;
-      _pass1  = pwd1;
+      setCredential(0, ssid, pwd);
+      setCredential(1, ssid1, pwd1);
+    }
+
+    // Saved network index < MAX_WIFI_CREDENTIALS. Its connection history is reset if the SSID changes
+    void          setCredential(const uint8_t& index, const String& ssid, const String& pwd);
+
+    // Saved network with its connection history. NULL if index >= MAX_WIFI_CREDENTIALS
+    const WM_Credential* getCredential(const uint8_t& index)
+    {
+      return (index < MAX_WIFI_CREDENTIALS) ? &_credentials[index] : NULL;
     }
 
 ////////////////////////////////////////////////////
@@ -502,46 +1367,40 @@ class ESP_WiFiManager
     // return SSID of router in STA mode got from config portal. NULL if no user's input //KH
     inline String	getSSID() 
     {
-      return _ssid;
+      return _credentials[0].ssid;
     }
 
     // return password of router in STA mode got from config portal. NULL if no user's input //KH
     inline String	getPW() 
     {
-      return _pass;
+      return _credentials[0].pass;
     }
     
     // New from v1.1.0
     // return SSID of router in STA mode got from config portal. NULL if no user's input //KH
     inline String	getSSID1() 
     {
-      return _ssid1;
+      return _credentials[1].ssid;
     }
 
     // return password of router in STA mode got from config portal. NULL if no user's input //KH
     inline String	getPW1() 
     {
-      return _pass1;
+      return _credentials[1].pass;
     }
     
-    #define MAX_WIFI_CREDENTIALS        2
-    
     String				getSSID(const uint8_t& index) 
     {
-      if (index == 0)
-        return _ssid;
-      else if (index == 1)
-        return _ssid1;
+      if (index < MAX_WIFI_CREDENTIALS)
+        return _credentials[index].ssid;
       else     
         return String("");
     }
     
     String				getPW(const uint8_t& index) 
     {
-      if (index == 0)
-        return _pass;
-      else if (index == 1)
-        return _pass1;
+      if (index < MAX_WIFI_CREDENTIALS)
+        return _credentials[index].pass;
       else     
         return String("");
     }
@@ -681,6 +1540,8 @@ class ESP_WiFiManager
     std::unique_ptr<WebServer>        server;
 #endif
 
+    std::unique_ptr<ESP_WMArgStore>   _args;
+
 #define RFC952_HOSTNAME_MAXLEN      24
     char RFC952_hostname[RFC952_HOSTNAME_MAXLEN + 1];
 
@@ -688,16 +1549,17 @@ class ESP_WiFiManager
 
     void          setupConfigPortal();
     void          startWPS();
+    // Non-blocking WPS of process()
+    bool          beginWPS();
+    int8_t        wpsResult();
+    void          endWPS();
     //const char*   getStatus(const int& status);
 
     const char*   _apName = "no-net";
     const char*   _apPassword = NULL;
     
-    String        _ssid   = "";
-    String        _pass   = "";
-    
-    String        _ssid1  = "";
-    String        _pass1  = "";
+    // Saved networks, the first two edited by the Config Portal
+    WM_Credential _credentials[MAX_WIFI_CREDENTIALS] = {};
 
     ////////////////////////////////////////////////////
     
@@ -713,8 +1575,118 @@ class ESP_WiFiManager
     unsigned long _connectTimeout       = 0;
     unsigned long _configPortalStart    = 0;
 
-    int           numberOfNetworks;
-    int           *networkIndices;
+    WM_PortalStatus _portalStatus       = WM_PORTAL_IDLE;
+    // Start of the WM_PORTAL_CONNECTING delay, then of WiFi.begin()
+    unsigned long _portalConnectStart   = 0;
+    bool          _portalConnectBegun   = false;
+    // WPS, tried once per connection, running since _portalConnectStart
+    bool          _portalWPS            = false;
+    bool          _portalWPSTried       = false;
+    // Outcome for /status, WL_IDLE_STATUS until known. Portal ended with _portalOutcome after WM_PORTAL_RESULT_LINGER
+    uint8_t       _portalConnectResult  = WL_IDLE_STATUS;
+    bool          _portalLingering      = false;
+    WM_PortalStatus _portalOutcome      = WM_PORTAL_CONNECTED;
+
+    // Config Portal scan, done in the background and served from here
+    std::unique_ptr<WM_ScanArena>     _scanArena;
+    WM_ScanResult *_scanResults         = NULL;
+    int           _scanCount            = 0;
+    unsigned long _scanTime             = 0;
+    unsigned long _scanCacheTTL         = WM_SCAN_CACHE_TTL;
+    bool          _scanRunning          = false;
+    bool          _scanWanted           = false;
+    bool          _scanDone             = false;
+
+    // Bumped by each scan that adds, removes or changes an AP. Deltas can be served from _scanFloorVersion on
+    uint32_t      _scanVersion          = 0;
+    uint32_t      _scanFloorVersion     = 0;
+    uint16_t      _scanRemovedNext      = 0;
+    uint16_t      _scanRemovedCount     = 0;
+
+    WM_ConnectStats _connectStats       = { 0, 0, 0, WM_FULL_SCAN_TIME, 0, 0, 0 };
+
+    // From the WiFi callbacks, for the attempt at the SSID hashed in _connectSsidHash, 0 for any
+    WM_SPSCQueue<WM_ConnectEvent, WM_CONNECT_EVENT_QUEUE_SIZE> _connectEvents;
+    uint32_t        _connectSsidHash    = 0;
+
+    // Attempt in progress, timed from _attemptStart, WiFi.begin() and link up
+    WM_ConnectAttempt _attempt;
+    bool              _attemptOpen      = false;
+    unsigned long     _attemptStart     = 0;
+    unsigned long     _attemptBegin     = 0;
+    unsigned long     _attemptLinkUp    = 0;
+    // Scan done by reconnectWifi(), counted in its next attempt
+    unsigned long     _attemptScanTime  = 0;
+
+    // Allocated by the first attempt to end
+    std::unique_ptr<WM_ConnectAttempt[]>  _attempts;
+    uint8_t           _attemptNext      = 0;
+    uint8_t           _attemptCount     = 0;
+
+    // supervise(): credentials to try in _supOrder, _supNext being tried since _supStart
+    WM_SupervisorState  _supState       = WM_SUPERVISOR_BACKOFF;
+    unsigned long       _supNextTry     = 0;
+    unsigned long       _supBackoff     = 0;
+    unsigned long       _supStart       = 0;
+    uint8_t             _supOrder[MAX_WIFI_CREDENTIALS];
+    uint8_t             _supCount       = 0;
+    uint8_t             _supNext        = 0;
+
+    // Roaming: RSSI average in 1/16 dBm, 0 until sampled. _roamChannels, bit per channel the SSID was seen on, left
+    // to scan in _roamPending. Best other AP so far in _roamAP, at _roamBest
+    bool                _roamEnabled    = false;
+    int8_t              _roamThreshold  = WM_ROAM_RSSI_THRESHOLD;
+    uint8_t             _roamHysteresis = WM_ROAM_HYSTERESIS;
+    int32_t             _roamRssi       = 0;
+    unsigned long       _roamNextSample = 0;
+    unsigned long       _roamNextScan   = 0;
+    uint16_t            _roamChannels   = 0;
+    uint16_t            _roamPending    = 0;
+    uint8_t             _roamScans      = 0;
+    int8_t              _roamBest       = 0;
+    WM_KnownAP          _roamAP;
+    // Reassociating to _roamAP
+    bool                _roamConnecting = false;
+
+    // Link-quality monitor. _linkRtt and _linkDrops are written by the WiFi and ping callbacks.
+    // The WM_LINK_HISTORY samples are allocated by setLinkMonitor(), not to weigh on a manager on the stack
+    bool              _linkEnabled      = false;
+    unsigned long     _linkInterval     = WM_LINK_SAMPLE_INTERVAL;
+    unsigned long     _linkNextSample   = 0;
+    std::unique_ptr<WM_LinkSample[]>  _linkSamples;
+    uint8_t           _linkNext         = 0;
+    uint8_t           _linkCount        = 0;
+    std::atomic<uint16_t> _linkRtt      { WM_LINK_RTT_NONE };
+    std::atomic<uint16_t> _linkDrops    { 0 };
+    bool              _linkUp           = false;
+
+#if USE_WM_LINK_PING
+  #ifdef ESP8266
+    struct raw_pcb*   _linkPcb          = NULL;
+    uint16_t          _linkSeq          = 0;
+    unsigned long     _linkPingSent     = 0;
+  #else
+    // One session, made again only if the gateway changes
+    esp_ping_handle_t _linkPing         = NULL;
+    uint32_t          _linkPingAddr     = 0;
+  #endif
+#endif
+
+#ifdef ESP8266
+    WiFiEventHandler  _connectedHandler;
+    WiFiEventHandler  _gotIPHandler;
+    WiFiEventHandler  _disconnectedHandler;
+#else
+    wifi_event_id_t   _connectEventId   = 0;
+    // Given by the WiFi callback after each event, so that the wait sleeps until then
+    SemaphoreHandle_t _connectEventSem  = NULL;
+#endif
+
+#if USE_WM_RTC_CACHE
+    // Loaded by connectWifi(), its lease applied by setWifiStaticIP() while _rtcLeaseWanted
+    WM_RTCCache     _rtcCache;
+    bool            _rtcLeaseWanted     = false;
+#endif
     
     // KH, To enable dynamic/random channel
     // default to channel 1
@@ -747,9 +1719,49 @@ class ESP_WiFiManager
 
     void          setWifiStaticIP();   
     int           reconnectWifi();
-    int           connectWifi(const String& ssid = "", const String& pass = "");
+    int           connectWifi(const String& ssid = "", const String& pass = "", const uint8_t& channel = 0,
+                              const uint8_t* bssid = NULL);
+    bool          beginConnectWifi(const String& ssid, const String& pass, const uint8_t& channel = 0,
+                                   const uint8_t* bssid = NULL);
+    int           scanKnownNetworks();
+    uint8_t       rankCredentials(uint8_t* order);
+    int           credentialScore(const uint8_t& index);
+    int           matchKnownNetworks(const int& n);
+    void          updateKnownAPs(const WM_ScanResult* results, const int& n);
+    void          rememberConnectedAP(const uint8_t& index);
+
+#if USE_WM_RTC_CACHE
+    bool          loadRTCCache(const String& ssid);
+    void          saveRTCCache(const uint8_t& leaseUses = 0);
+    void          clearRTCCache();
+#endif
+    void          processPortalConnect();
+    void          lingerPortal(const uint8_t& connRes, const WM_PortalStatus& portalStatus);
+    void          endConfigPortal(const WM_PortalStatus& portalStatus);
    
     uint8_t       waitForConnectResult();
+    uint8_t       waitForConnectResult(const unsigned long& timeout);
+    void          startConnect(const String& ssid, const String& pass, const uint8_t& channel, const uint8_t* bssid);
+    void          superviseNext();
+    void          superviseRetry();
+    void          superviseRoaming();
+    bool          startRoamingScan();
+    void          collectRoamingAPs(const int& n);
+#if USE_WM_LINK_PING
+    bool          sendLinkPing(const IPAddress& gateway);
+  #ifdef ESP8266
+    uint8_t       linkPingReply(struct pbuf* p);
+  #endif
+#endif
+    void          endRoamingScan();
+    bool          setWiFiMode(const WiFiMode_t& mode);
+    void          beginConnectEvents();
+    void          pushConnectEvent(const uint8_t& type, const uint8_t& reason = 0, const uint8_t* ssid = NULL,
+                                   const size_t& ssidLen = 0);
+    uint8_t       connectEventResult();
+    void          beginConnectAttempt();
+    void          setConnectPhase(const uint8_t& phase, const unsigned long& ms);
+    void          endConnectAttempt(const uint8_t& result);
 
     void          handleRoot();
     void          handleWifi();
@@ -757,12 +1769,68 @@ class ESP_WiFiManager
     void          handleServerClose();
     void          handleInfo();
     void          handleState();
+    void          handleStatus();
     void          handleScan();
+    void          handleMetrics();
+    void          handleLink();
+    void          linkRttJson(char* buffer, const size_t& size, const uint16_t& rtt);
     void          handleReset();
     void          handleNotFound();
+    void          handleStyle();
+    void          handleScript();
+    void          sendAsset(PGM_P contentType, const uint8_t* gz, const size_t& gzLen, PGM_P etag);
     bool          captivePortal();
     
-    void          reportStatus(String& page);
+    void          reportStatus();
+
+    ////////////////////////////////////////////////////
+
+    // Page writer, to send the Config Portal pages by chunk
+    void          pageBegin(const char* contentType = "text/html", const int& code = 200);
+    void          pageAdd(const char* content, const size_t& len);
+    void          pageAdd(const char* content);
+    void          pageAdd(const String& content);
+    void          pageAdd(const __FlashStringHelper* content);
+    void          pageAdd_P(PGM_P content, size_t len);
+    void          pageAddTemplate(PGM_P tpl, const WM_TemplateSeg* segs, const uint8_t& segCount,
+                                  const char* const tokens[WM_TOKEN_COUNT]);
+    void          pageAddIPItem(const char* id, const char* placeholder, const IPAddress& ip);
+    void          pageHead(const char* title);
+    void          pageFlush();
+    void          pageEnd();
+
+    // WM_PAGE_CHUNK_SIZE + 1, allocated with the portal
+    std::unique_ptr<char[]>           _pageBuf;
+    size_t        _pageLen                = 0;
+
+#if !USE_CHUNKED_CP_PAGES
+    String        _page;
+    const char*   _pageContentType        = NULL;
+    int           _pageCode               = 200;
+#endif
+
+    ////////////////////////////////////////////////////
+
+    // Content version, sent as ETag by the pages and JSON endpoints a client can revalidate
+    void          sendNoStoreHeaders();
+    void          bumpContentVersion();
+    bool          notModified();
+    bool          updateScanDelta(WM_ScanResult* results, const int& n);
+    void          addScanRemoved(const uint8_t* bssid, const uint32_t& version);
+    bool          scanDeltaValid(const uint32_t& since);
+
+    void          removeDuplicateAPs(WM_ScanResult* results, const int& n, uint8_t* table, const uint16_t& tableSize);
+    int           collectScanResults(int n, WM_ScanResult* results, char* ssids, const int& capacity,
+                                     uint8_t* table, const uint16_t& tableSize);
+    void          requestScan(const bool& force);
+    void          processScan();
+
+
+    uint32_t      _contentVersion         = 0;
+    uint8_t       _contentWiFiStatus      = WL_IDLE_STATUS;
+    uint32_t      _contentLocalIP         = 0;
+
+    ////////////////////////////////////////////////////
 
     // DNS server
     const byte    DNS_PORT = 53;
@@ -773,7 +1841,7 @@ class ESP_WiFiManager
     String        toStringIp(const IPAddress& ip);
 
     bool          connect;
-    bool          stopConfigPortal = false;
+    bool          _stopConfigPortalFlag = false;
     
     bool          _debug = false;     //true;
 
@@ -0,0 +1,231 @@
+// autogenerated from utils/wm_assets by utils/gen_wm_assets.py, do not edit
+
+#ifndef WM_ASSETS_H
+#define WM_ASSETS_H
+
+// wm.css : 1472 bytes, 837 gzipped
+#define WM_ASSET_CSS_VER "095e8393"
+const char WM_ASSET_CSS_ETAG[] PROGMEM = "\"" WM_ASSET_CSS_VER "\"";
+const size_t WM_ASSET_CSS_GZ_LEN = 837;
+const uint8_t WM_ASSET_CSS_GZ[] PROGMEM =
+{
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x95, 0x54, 0x5d, 0x6f, 0xa3, 0x38,
+  0x14, 0x7d, 0xdf, 0x5f, 0x81, 0x54, 0xad, 0xda, 0x8e, 0x42, 0x02, 0xf9, 0x6a, 0x09, 0xea, 0x68,
+  0x93, 0x0c, 0xcd, 0xb4, 0x93, 0x26, 0x6d, 0x33, 0xc9, 0x64, 0xb2, 0xda, 0x07, 0x83, 0x8d, 0x71,
+  0x01, 0x9b, 0x82, 0x09, 0x24, 0x88, 0xff, 0xbe, 0x76, 0x52, 0xd2, 0xa4, 0x33, 0xd2, 0x6a, 0x79,
+  0xc1, 0xbe, 0xbe, 0x1f, 0xe7, 0xde, 0x73, 0x6c, 0x48, 0xd6, 0x45, 0x04, 0x20, 0x24, 0x14, 0xf7,
+  0x9a, 0x51, 0x6e, 0xba, 0x8c, 0x72, 0x35, 0x21, 0x5b, 0xd4, 0xd3, 0x51, 0x68, 0x96, 0x36, 0x83,
+  0x9b, 0x1a, 0x47, 0x39, 0x07, 0x31, 0x02, 0x35, 0x42, 0xa3, 0x94, 0xd7, 0x12, 0x14, 0x20, 0x87,
+  0x17, 0x36, 0x70, 0x7c, 0x1c, 0xb3, 0x94, 0xc2, 0x9e, 0xa2, 0x99, 0x36, 0x8b, 0x21, 0x8a, 0xd5,
+  0x18, 0x40, 0x92, 0x26, 0xd2, 0x20, 0x13, 0xf5, 0x14, 0xbd, 0x1b, 0xe5, 0x4a, 0x02, 0x68, 0xa2,
+  0x26, 0x28, 0x26, 0xae, 0x19, 0x82, 0x18, 0x13, 0x2a, 0xce, 0xcb, 0xdf, 0x27, 0x65, 0x29, 0x0f,
+  0x08, 0x45, 0x55, 0x82, 0x3d, 0x12, 0x45, 0x6f, 0x0b, 0x64, 0xfb, 0x0a, 0x62, 0x23, 0x33, 0xb2,
+  0x80, 0x40, 0xe5, 0xcc, 0x71, 0x1c, 0xb3, 0x02, 0xaf, 0x5c, 0x0b, 0x9f, 0x8c, 0x40, 0xee, 0xf5,
+  0x14, 0x43, 0xfb, 0xb3, 0xac, 0xdb, 0x9c, 0x2a, 0xa0, 0x90, 0x65, 0x54, 0x88, 0x1c, 0x16, 0x03,
+  0x4e, 0x98, 0xa8, 0x4c, 0x19, 0x45, 0x65, 0xdd, 0x11, 0xc9, 0x81, 0x28, 0x14, 0x17, 0x15, 0x22,
+  0x90, 0x72, 0x76, 0x1c, 0xff, 0x57, 0x88, 0x20, 0x01, 0x17, 0x21, 0xa1, 0xea, 0xde, 0xaa, 0x37,
+  0x35, 0x2d, 0xca, 0x2f, 0x8b, 0xff, 0x88, 0x6d, 0x89, 0xd8, 0x5f, 0x83, 0xaf, 0xba, 0x02, 0xde,
+  0xa5, 0x02, 0x28, 0x54, 0x2e, 0x42, 0x90, 0xff, 0xbf, 0x94, 0x1d, 0x99, 0x52, 0xf6, 0x53, 0xf3,
+  0x9a, 0xc5, 0xd1, 0x58, 0x9a, 0x28, 0x2c, 0x3d, 0xfd, 0xd8, 0xd2, 0x12, 0x16, 0xe9, 0x78, 0x42,
+  0xce, 0x99, 0x06, 0xd0, 0x47, 0x7e, 0x8e, 0x07, 0xaa, 0x99, 0x0e, 0x0b, 0x98, 0x58, 0x9c, 0xb9,
+  0xae, 0x6b, 0x3a, 0x69, 0x9c, 0xc8, 0x4d, 0xc4, 0x08, 0xe5, 0x28, 0x36, 0x21, 0x49, 0xa2, 0x00,
+  0x6c, 0x7a, 0x0a, 0xa1, 0x92, 0x19, 0xd5, 0x0e, 0x98, 0xe3, 0x1f, 0x78, 0x14, 0x92, 0x11, 0xf1,
+  0x07, 0x0e, 0x74, 0xd1, 0xce, 0x8e, 0x2d, 0x45, 0xd7, 0xdf, 0xe9, 0xd0, 0xb5, 0x37, 0x3e, 0x7a,
+  0x1e, 0x5b, 0x8b, 0x1e, 0x4f, 0xc1, 0x19, 0x70, 0x7f, 0x06, 0x1c, 0x4e, 0xd6, 0xa8, 0xb6, 0x5b,
+  0xbb, 0xcc, 0x49, 0x93, 0x0f, 0x7e, 0xd7, 0x76, 0x19, 0x00, 0x1b, 0x05, 0x9f, 0x3f, 0x15, 0x1f,
+  0x30, 0x95, 0x2e, 0x8b, 0xc3, 0x63, 0xf3, 0x31, 0x46, 0xd5, 0x66, 0x9c, 0xb3, 0x70, 0x8f, 0xed,
+  0xa0, 0xba, 0x7d, 0x85, 0xbd, 0xf6, 0xde, 0xd6, 0x7b, 0x05, 0x56, 0xa5, 0xf7, 0xe3, 0xaa, 0x06,
+  0xd3, 0x01, 0x76, 0x59, 0x0f, 0x13, 0x7c, 0x0a, 0x09, 0x22, 0xb7, 0x9a, 0x6b, 0x80, 0x5c, 0xa1,
+  0xf6, 0xce, 0xbb, 0x34, 0x3b, 0x06, 0x3c, 0x1a, 0x4b, 0xbd, 0x23, 0x89, 0x79, 0x2d, 0xdc, 0x80,
+  0x01, 0xe1, 0x17, 0x13, 0xec, 0xf1, 0x6a, 0x3a, 0x5d, 0xc9, 0xc5, 0x4e, 0xa6, 0x20, 0x20, 0x98,
+  0xbe, 0x9d, 0x96, 0xf5, 0xe0, 0xa4, 0x58, 0x1a, 0x07, 0x17, 0xe7, 0x10, 0x70, 0xd0, 0x23, 0x21,
+  0xc0, 0xa8, 0x11, 0x51, 0x6c, 0xda, 0x20, 0x41, 0xdd, 0x76, 0x8d, 0x2c, 0x06, 0xd3, 0xe7, 0x4c,
+  0xfb, 0x36, 0xc2, 0xac, 0x2f, 0xbe, 0xc9, 0x6c, 0xee, 0x59, 0x73, 0x2c, 0x56, 0x43, 0xb9, 0xed,
+  0xe3, 0x61, 0xff, 0x41, 0xfc, 0x06, 0x56, 0x74, 0x17, 0x8f, 0xa4, 0x61, 0xbc, 0x18, 0x3c, 0x2c,
+  0xac, 0x65, 0xa3, 0xd1, 0xb8, 0xb6, 0x06, 0x99, 0x3b, 0xc8, 0x92, 0x71, 0x76, 0xfd, 0xd8, 0xdf,
+  0x4e, 0x5e, 0xc0, 0x10, 0xb7, 0x27, 0xdf, 0x17, 0x8b, 0xf9, 0xcb, 0x3d, 0x59, 0x7d, 0x79, 0x9e,
+  0xcf, 0xe7, 0xb7, 0x39, 0x24, 0xab, 0xd1, 0xcc, 0x63, 0xdd, 0xe9, 0xcc, 0xef, 0x3c, 0xe2, 0x36,
+  0xba, 0xdd, 0xc0, 0xaf, 0xdf, 0x87, 0x2f, 0xc0, 0x6d, 0xc9, 0x5c, 0x2b, 0x2b, 0xb0, 0x9e, 0x16,
+  0x4f, 0xed, 0x17, 0xd4, 0x9c, 0xcc, 0xb2, 0xab, 0xfe, 0x5d, 0xdf, 0xb3, 0x06, 0x20, 0xfc, 0x46,
+  0x8d, 0xab, 0x46, 0xfa, 0xb0, 0xb4, 0x46, 0x83, 0x35, 0xdb, 0xfa, 0x3f, 0x6c, 0x63, 0xd8, 0x5c,
+  0xe5, 0xed, 0x7c, 0xfb, 0x63, 0xe3, 0x0f, 0xbc, 0xdb, 0x3e, 0xfa, 0x19, 0x19, 0xd8, 0x1f, 0x6f,
+  0x56, 0x96, 0xb6, 0xbd, 0x7b, 0xa0, 0xcc, 0xa0, 0x6d, 0xac, 0x1b, 0x5e, 0x08, 0x7f, 0xb6, 0x8c,
+  0xc4, 0xc9, 0x5e, 0x17, 0xfe, 0x74, 0x09, 0xf2, 0xc8, 0xd3, 0x56, 0xc3, 0xe5, 0x93, 0xf3, 0x9a,
+  0xcf, 0x22, 0xfc, 0x14, 0x4d, 0x27, 0xa0, 0x63, 0x64, 0xfe, 0xf3, 0x97, 0xe9, 0xd8, 0x68, 0xa1,
+  0xfe, 0x72, 0x4d, 0xc2, 0x2c, 0xb0, 0x1f, 0xed, 0x2c, 0x5b, 0xf4, 0x11, 0x1e, 0xcf, 0xf4, 0xaf,
+  0x23, 0x77, 0xb5, 0x6b, 0x79, 0x70, 0xff, 0x3c, 0xef, 0x58, 0xb1, 0x7f, 0x8f, 0x31, 0xbe, 0xb9,
+  0x39, 0xbf, 0x14, 0x97, 0x5e, 0x8d, 0x51, 0x84, 0x00, 0x57, 0x24, 0x51, 0x8a, 0x83, 0x76, 0xd2,
+  0x7e, 0x9f, 0x6f, 0xf5, 0xce, 0x08, 0x96, 0x76, 0x92, 0xf8, 0x9b, 0x6f, 0x22, 0x74, 0x73, 0xee,
+  0x78, 0xc8, 0xf1, 0x6d, 0x96, 0x9f, 0xff, 0x53, 0x31, 0x27, 0xc3, 0x2b, 0xe2, 0x9a, 0x52, 0x50,
+  0x75, 0x0e, 0xec, 0x00, 0x29, 0x1c, 0x1e, 0x5e, 0x51, 0xc9, 0xf5, 0x31, 0x9f, 0x32, 0xe4, 0xe0,
+  0x26, 0xdf, 0xd3, 0xcf, 0x3d, 0xca, 0x3d, 0xd5, 0xf1, 0x48, 0x00, 0x2f, 0x9a, 0x54, 0xd5, 0x2f,
+  0x8f, 0x89, 0x3e, 0x83, 0x10, 0x96, 0x2e, 0x41, 0x01, 0x4c, 0x10, 0x2f, 0x4e, 0x6f, 0xad, 0x56,
+  0xef, 0xc4, 0x22, 0xf7, 0xdb, 0xdd, 0x13, 0xd5, 0xcd, 0xf2, 0x8f, 0x7f, 0x01, 0x6f, 0xfa, 0x51,
+  0xca, 0xc0, 0x05, 0x00, 0x00,
+};
+
+// wm.js : 635 bytes, 316 gzipped
+#define WM_ASSET_JS_VER "e3455b5a"
+const char WM_ASSET_JS_ETAG[] PROGMEM = "\"" WM_ASSET_JS_VER "\"";
+const size_t WM_ASSET_JS_GZ_LEN = 316;
+const uint8_t WM_ASSET_JS_GZ[] PROGMEM =
+{
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xa5, 0x50, 0xd1, 0x4e, 0x02, 0x31,
+  0x10, 0x7c, 0xf7, 0x2b, 0xee, 0xad, 0xbd, 0x40, 0x2a, 0xf8, 0x08, 0x69, 0x4c, 0x34, 0x28, 0x18,
+  0x50, 0x03, 0x97, 0xe8, 0x6b, 0x73, 0xb7, 0x47, 0x9a, 0x94, 0xed, 0xd9, 0x6e, 0xf1, 0x94, 0xf3,
+  0xdf, 0xed, 0x21, 0x08, 0xc6, 0x90, 0x98, 0xf8, 0xd4, 0xcd, 0xce, 0xec, 0x4c, 0x67, 0xca, 0x80,
+  0x39, 0x69, 0x8b, 0x49, 0xce, 0x4d, 0xba, 0x29, 0x6c, 0x1e, 0x56, 0x80, 0x24, 0x96, 0x40, 0x23,
+  0x03, 0xed, 0x78, 0xf5, 0x36, 0x29, 0x38, 0xf3, 0x2c, 0x15, 0x6b, 0x65, 0x02, 0x48, 0x23, 0x34,
+  0x22, 0xb8, 0x0c, 0x6a, 0x6a, 0x1a, 0x23, 0x28, 0xbe, 0xd7, 0x16, 0x29, 0x32, 0x87, 0x27, 0xaf,
+  0xab, 0x78, 0x5d, 0x46, 0xd0, 0xf3, 0xf4, 0x34, 0xc9, 0xf7, 0xff, 0xe7, 0xd1, 0xff, 0x8b, 0x09,
+  0xe9, 0x15, 0xbc, 0x5b, 0x84, 0x6f, 0xab, 0xfd, 0x42, 0xa0, 0x5a, 0x41, 0xbc, 0xfc, 0x38, 0x2b,
+  0xf7, 0x8d, 0x78, 0xe2, 0xe9, 0x66, 0xad, 0x5c, 0x52, 0x4b, 0x84, 0xd7, 0xe4, 0x79, 0x36, 0x1d,
+  0x13, 0x55, 0x73, 0x78, 0x09, 0xd0, 0x42, 0x5d, 0x90, 0xa7, 0xb3, 0x10, 0x4b, 0x87, 0xb5, 0xb0,
+  0x68, 0xac, 0x2a, 0xe4, 0x5e, 0x71, 0x27, 0xe7, 0xe4, 0xdd, 0xe2, 0xe1, 0x5e, 0x54, 0xca, 0x79,
+  0xe0, 0xb5, 0x70, 0xe0, 0x2b, 0x8b, 0x1e, 0xda, 0xb4, 0xe9, 0x10, 0xbe, 0xa2, 0x8f, 0xb3, 0xd9,
+  0x54, 0x3a, 0xb1, 0x20, 0x45, 0xd0, 0xe1, 0xbb, 0x41, 0x4a, 0x16, 0x6b, 0x40, 0xc8, 0x09, 0x0a,
+  0x76, 0xc9, 0x92, 0x41, 0xc2, 0x3a, 0x4e, 0x4c, 0x1e, 0x07, 0x07, 0xfc, 0x46, 0x69, 0x73, 0x0c,
+  0xce, 0xc1, 0x07, 0x43, 0x03, 0x16, 0xbf, 0xa3, 0xcb, 0x23, 0x9d, 0x27, 0xa5, 0x49, 0xe3, 0x92,
+  0x35, 0xcd, 0x2f, 0xed, 0x76, 0x9d, 0x7a, 0xa0, 0x2c, 0x36, 0x63, 0x03, 0x71, 0x4f, 0xdd, 0x7e,
+  0xaf, 0xd7, 0x8b, 0xd5, 0x6c, 0x13, 0x81, 0x73, 0xd6, 0x1d, 0x47, 0xfa, 0x49, 0xbd, 0x38, 0x50,
+  0x2b, 0x40, 0xce, 0x6e, 0x47, 0x19, 0xeb, 0xb2, 0x73, 0x1f, 0x3d, 0x82, 0xdf, 0x96, 0xe2, 0x01,
+  0x8b, 0x6d, 0xd1, 0x9f, 0xd5, 0x8e, 0x08, 0xd3, 0x7b, 0x02, 0x00, 0x00,
+};
+
+// wm.js + jstz.js : 6024 bytes, 2041 gzipped
+#define WM_ASSET_JS_NTP_VER "f62066ac"
+const char WM_ASSET_JS_NTP_ETAG[] PROGMEM = "\"" WM_ASSET_JS_NTP_VER "\"";
+const size_t WM_ASSET_JS_NTP_GZ_LEN = 2041;
+const uint8_t WM_ASSET_JS_NTP_GZ[] PROGMEM =
+{
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xa5, 0x58, 0x5b, 0x6f, 0xdb, 0x38,
+  0x16, 0x7e, 0x9f, 0x5f, 0xe1, 0x79, 0xa9, 0x64, 0x44, 0x76, 0x64, 0x3b, 0xb6, 0x53, 0x67, 0x34,
+  0x41, 0x6e, 0x4d, 0xd2, 0x26, 0x6d, 0xd0, 0x78, 0x67, 0x36, 0x6b, 0x18, 0x06, 0x63, 0xd1, 0x36,
+  0xc7, 0x32, 0xe9, 0x25, 0xa9, 0x5c, 0x9a, 0xfa, 0xbf, 0xef, 0xa1, 0x24, 0x4a, 0x94, 0xc4, 0x00,
+  0x05, 0x16, 0x05, 0x52, 0xe9, 0xdc, 0x78, 0x6e, 0xfc, 0xce, 0x91, 0x17, 0x31, 0x9d, 0x4b, 0xc2,
+  0x68, 0x63, 0xee, 0x46, 0xcd, 0xb7, 0x90, 0xcd, 0xe3, 0x0d, 0xa6, 0xb2, 0xbd, 0xc4, 0xf2, 0x22,
+  0xc2, 0xea, 0xf1, 0xf4, 0xf5, 0x3a, 0x74, 0x1d, 0xe1, 0x34, 0xdb, 0x4f, 0x28, 0x8a, 0x71, 0x10,
+  0xb5, 0x09, 0xa5, 0x98, 0x8f, 0xf1, 0x8b, 0xfc, 0xf9, 0x33, 0x6a, 0x4b, 0xf8, 0xff, 0x8c, 0x51,
+  0x09, 0x92, 0x47, 0xef, 0x6a, 0x6f, 0x41, 0x7b, 0x01, 0x4c, 0xe1, 0x36, 0xdf, 0x17, 0x12, 0x9d,
+  0xff, 0xef, 0x8c, 0xce, 0xaf, 0x1c, 0x22, 0xc9, 0x06, 0xff, 0x60, 0x14, 0xe7, 0x47, 0x69, 0x42,
+  0x9b, 0xa2, 0x0d, 0x06, 0xcd, 0xdd, 0x6f, 0x0b, 0x9d, 0x11, 0x21, 0xdd, 0xe6, 0xdb, 0x13, 0xe2,
+  0x8d, 0x97, 0x80, 0xe2, 0xe7, 0xc6, 0xbf, 0x6f, 0x6f, 0xae, 0xa4, 0xdc, 0x7e, 0xc7, 0xff, 0x8d,
+  0xb1, 0x62, 0x79, 0x38, 0x78, 0x3f, 0x16, 0xe9, 0x34, 0x8f, 0x5e, 0xda, 0x8c, 0x46, 0x0c, 0x85,
+  0x81, 0xb6, 0x98, 0x99, 0xe3, 0xc1, 0xe7, 0xfb, 0x6f, 0x5f, 0xdb, 0x5b, 0xc4, 0x05, 0x76, 0x5f,
+  0xda, 0x1c, 0x8b, 0x2d, 0xa3, 0x02, 0xab, 0x68, 0x9b, 0x47, 0x38, 0x0d, 0xfd, 0x6a, 0x7c, 0x7b,
+  0x13, 0xf0, 0xf6, 0xbd, 0x44, 0x12, 0xef, 0xb9, 0xd9, 0x43, 0x10, 0x38, 0x90, 0x06, 0x8a, 0xe7,
+  0x12, 0x87, 0xce, 0xb1, 0xd3, 0x18, 0x35, 0x9c, 0x3d, 0xde, 0xbe, 0xbe, 0x1b, 0x15, 0xfc, 0x4f,
+  0x88, 0x44, 0x26, 0xf3, 0x3b, 0x16, 0x71, 0x24, 0x47, 0x0e, 0xb8, 0x43, 0x16, 0x86, 0x9d, 0xbf,
+  0x11, 0x91, 0x84, 0x2e, 0x9d, 0x9f, 0x3f, 0x6b, 0xb6, 0x15, 0xb9, 0x29, 0xb0, 0x1c, 0x43, 0x66,
+  0x58, 0x2c, 0x5d, 0x21, 0xbd, 0x8e, 0xef, 0xfb, 0x90, 0x9a, 0x24, 0x22, 0xcc, 0x39, 0xe3, 0x66,
+  0x48, 0x65, 0xd1, 0x6e, 0x21, 0xba, 0xc5, 0xd4, 0x75, 0x2e, 0x2f, 0xc6, 0x8e, 0xe7, 0xec, 0x0b,
+  0x38, 0x23, 0x16, 0x49, 0x52, 0x04, 0xa6, 0x61, 0x92, 0x68, 0x37, 0x37, 0x82, 0xd3, 0xc4, 0x48,
+  0xd3, 0xac, 0x13, 0x0b, 0x0c, 0x25, 0xe0, 0x64, 0x2e, 0x9d, 0x23, 0xc5, 0xc5, 0x01, 0x74, 0xa1,
+  0x47, 0x83, 0xba, 0x56, 0x0b, 0xab, 0x02, 0x8c, 0xb3, 0x4a, 0x7e, 0x5b, 0x2c, 0xc0, 0x25, 0x38,
+  0x81, 0x63, 0x19, 0x73, 0xda, 0x90, 0xbf, 0x07, 0x01, 0x8d, 0xa3, 0xe8, 0x58, 0x8e, 0xfc, 0x9d,
+  0x67, 0xb8, 0x8e, 0x3d, 0xe9, 0x51, 0x5d, 0x12, 0x55, 0xe1, 0x73, 0xc8, 0x83, 0xd6, 0xc2, 0xa0,
+  0x15, 0xd3, 0x10, 0x2f, 0x08, 0xc5, 0xe1, 0x87, 0x0f, 0x1c, 0xdc, 0x96, 0x9f, 0xc0, 0xca, 0x03,
+  0x46, 0x1c, 0x4e, 0xf6, 0x12, 0x82, 0x52, 0x70, 0x69, 0xf6, 0x72, 0x0b, 0x1d, 0xba, 0x72, 0x25,
+  0xbc, 0xed, 0x3c, 0x52, 0xf2, 0x32, 0x33, 0x49, 0x5d, 0xd0, 0xf4, 0x7c, 0xaf, 0xdb, 0x6c, 0xee,
+  0x3c, 0xf1, 0xbe, 0x44, 0x3f, 0x95, 0x60, 0x96, 0x48, 0x93, 0x40, 0xd3, 0x83, 0x9a, 0x7f, 0x0e,
+  0x8f, 0x85, 0x9b, 0x10, 0x72, 0xbf, 0x9a, 0xcd, 0x11, 0xa9, 0x91, 0x20, 0x64, 0x65, 0x21, 0x4f,
+  0x47, 0x8b, 0x43, 0x68, 0x90, 0x89, 0xb8, 0xda, 0x97, 0x32, 0x20, 0xd0, 0xd5, 0x34, 0x80, 0x0b,
+  0x04, 0x3a, 0xf0, 0xdc, 0x12, 0x45, 0x16, 0xf9, 0x1f, 0xfe, 0xb1, 0xdc, 0x73, 0xbc, 0x8e, 0x33,
+  0xe2, 0x7f, 0xfa, 0xc7, 0x54, 0x3d, 0x7a, 0xce, 0x1e, 0x1e, 0x29, 0xa2, 0xef, 0xec, 0x3c, 0x54,
+  0x35, 0x87, 0x83, 0xb8, 0x50, 0x57, 0xe9, 0x95, 0x6d, 0x55, 0xa2, 0xff, 0x40, 0x89, 0x5c, 0xd9,
+  0x66, 0x91, 0x60, 0xb4, 0xad, 0x6f, 0x9f, 0x98, 0xe0, 0x29, 0x84, 0xbc, 0xb0, 0x84, 0xac, 0x0b,
+  0xe3, 0x76, 0xfd, 0x8e, 0xef, 0x0d, 0xbc, 0x4e, 0x1f, 0x0e, 0xf6, 0xd5, 0x3f, 0xe5, 0xeb, 0x9b,
+  0x73, 0xb2, 0xc1, 0xd0, 0x23, 0x68, 0xff, 0x1c, 0xd3, 0x27, 0xcc, 0x9d, 0x91, 0x29, 0xdf, 0xf1,
+  0xba, 0x5e, 0xa7, 0xe7, 0xf5, 0xb4, 0x7c, 0x2e, 0x7c, 0x8b, 0x7e, 0x20, 0x19, 0x21, 0x5a, 0x15,
+  0xef, 0x79, 0x36, 0xe9, 0xb3, 0x15, 0xfc, 0x5d, 0xb2, 0x5f, 0xb5, 0x8d, 0x5f, 0xc8, 0x9c, 0xcd,
+  0xce, 0x88, 0x7c, 0xfd, 0x35, 0xf3, 0x27, 0x02, 0x82, 0x86, 0x98, 0xcb, 0xd2, 0x5d, 0xef, 0xa3,
+  0x37, 0xb4, 0x48, 0xdf, 0x23, 0x2a, 0x49, 0xcd, 0x1b, 0x25, 0x6d, 0x75, 0x1d, 0x6d, 0xb6, 0x6c,
+  0x76, 0xc9, 0x11, 0xb4, 0x72, 0x5d, 0xa3, 0xdb, 0x81, 0x66, 0xab, 0xf9, 0xaf, 0x90, 0xf6, 0x89,
+  0x84, 0xb8, 0x16, 0x30, 0x28, 0x58, 0x1d, 0x62, 0xb3, 0x3b, 0x14, 0x47, 0x16, 0xf1, 0xce, 0xc0,
+  0x62, 0xff, 0x86, 0x89, 0xd9, 0x09, 0x5d, 0xe2, 0x08, 0x0b, 0x6b, 0x46, 0x0f, 0xad, 0x21, 0xa3,
+  0xd9, 0xb5, 0x40, 0x8f, 0x38, 0xaa, 0xa7, 0xb4, 0x6f, 0xd1, 0xb8, 0x42, 0x4f, 0x88, 0xa2, 0x6a,
+  0xc0, 0x60, 0x1e, 0x6e, 0x5f, 0x4d, 0xf8, 0x2b, 0x7e, 0x9e, 0x3d, 0x30, 0xbe, 0xb6, 0x8a, 0x0f,
+  0x0b, 0x71, 0x41, 0xd0, 0xfe, 0x29, 0x26, 0x3c, 0x96, 0x75, 0xbf, 0xbb, 0xc3, 0xa2, 0x2b, 0x9d,
+  0x8b, 0x98, 0x03, 0xf8, 0xed, 0x5f, 0xe1, 0x48, 0x10, 0xba, 0x26, 0x56, 0xe9, 0x83, 0xaa, 0xf4,
+  0x35, 0x40, 0x24, 0x7d, 0x8c, 0x23, 0x8b, 0xf4, 0xa1, 0x99, 0x45, 0xe5, 0xc5, 0x39, 0xda, 0x20,
+  0x01, 0x93, 0xae, 0x9e, 0x8c, 0x8e, 0x19, 0x9f, 0x12, 0xfd, 0x8c, 0x79, 0x2c, 0x10, 0xcc, 0x26,
+  0x9b, 0xec, 0xa0, 0x2c, 0x7b, 0x09, 0xb7, 0xa2, 0x24, 0xe6, 0x7f, 0x4c, 0x8f, 0xf7, 0xbd, 0x5e,
+  0x2e, 0xb8, 0xc8, 0xfa, 0x8a, 0x70, 0x56, 0x95, 0xed, 0x79, 0xdd, 0xbe, 0x29, 0x7b, 0x87, 0xe6,
+  0x64, 0x41, 0xe6, 0xfb, 0x27, 0xf1, 0x7c, 0x0d, 0x97, 0x2d, 0xac, 0xba, 0x70, 0xe8, 0x75, 0x07,
+  0x46, 0x82, 0xb5, 0xf8, 0x27, 0xf2, 0x4f, 0x25, 0x67, 0xbe, 0xa7, 0x12, 0x01, 0xce, 0xf4, 0x2c,
+  0x95, 0x8e, 0xc8, 0x02, 0xbd, 0x58, 0x3b, 0x69, 0x50, 0x93, 0xbe, 0x64, 0x4c, 0xe0, 0xd9, 0x29,
+  0x7a, 0xb5, 0xca, 0x77, 0xd3, 0x1a, 0x9a, 0x77, 0x81, 0xc0, 0xb0, 0x8f, 0x18, 0xb5, 0x8a, 0xf7,
+  0x2d, 0xe6, 0x43, 0xb9, 0x42, 0x8f, 0xbf, 0xd6, 0x1e, 0xb7, 0x4c, 0xcc, 0xd9, 0xb3, 0x33, 0x92,
+  0x59, 0xf6, 0x1f, 0xf0, 0x1a, 0x34, 0x38, 0x81, 0x26, 0xe0, 0xcb, 0x82, 0xfc, 0x6d, 0x23, 0xd6,
+  0xc5, 0xdb, 0x17, 0x8e, 0x04, 0x65, 0xaf, 0xb0, 0x3a, 0x18, 0xc4, 0x6b, 0xbe, 0x8e, 0xa5, 0x49,
+  0x78, 0x40, 0x15, 0xc2, 0x5f, 0x11, 0x0a, 0xc9, 0x13, 0x13, 0x92, 0x99, 0xb6, 0xd0, 0x66, 0xbe,
+  0x42, 0x72, 0x8d, 0x12, 0x92, 0xf6, 0x8a, 0x50, 0xad, 0x18, 0xc3, 0xf4, 0x85, 0xec, 0xa2, 0xfd,
+  0x3b, 0xcc, 0xe5, 0xaa, 0x5c, 0xec, 0x43, 0x75, 0x37, 0x3a, 0x79, 0x50, 0xbb, 0x1c, 0xe7, 0x01,
+  0xc8, 0xf5, 0xcb, 0x5b, 0x88, 0x21, 0x9e, 0x0d, 0x0c, 0xd0, 0x11, 0xf2, 0x42, 0x50, 0x9c, 0x11,
+  0x31, 0x0b, 0x85, 0x1c, 0x31, 0x0f, 0xfe, 0xce, 0xa0, 0xdf, 0xb9, 0x9c, 0x2d, 0x18, 0x1f, 0x2d,
+  0x76, 0x3b, 0x98, 0x14, 0xc5, 0x78, 0x28, 0x4d, 0x81, 0xda, 0x1e, 0x60, 0x03, 0xfd, 0x49, 0x95,
+  0x62, 0x81, 0xfa, 0xa9, 0x05, 0xd0, 0x27, 0x35, 0x92, 0x1d, 0xc7, 0xa7, 0x36, 0xfc, 0x9d, 0xd4,
+  0x69, 0x16, 0x50, 0x7f, 0x07, 0x8b, 0xa7, 0x76, 0xc0, 0x9d, 0xd8, 0xa8, 0x36, 0xac, 0x9d, 0x56,
+  0x00, 0x69, 0x52, 0x7a, 0xad, 0x63, 0x50, 0x1d, 0x67, 0xaa, 0x58, 0x52, 0x03, 0x0c, 0x13, 0x15,
+  0xa6, 0xb6, 0xdb, 0x3c, 0xa9, 0xd3, 0x2a, 0xb7, 0x78, 0xfa, 0x0e, 0xec, 0x4f, 0xac, 0xe4, 0x77,
+  0x10, 0x7f, 0x6a, 0x83, 0xea, 0x49, 0x15, 0xeb, 0x2d, 0x42, 0x53, 0x0b, 0x4c, 0x4c, 0x2c, 0x58,
+  0x50, 0x17, 0x9b, 0x5a, 0xee, 0xf4, 0xa4, 0x8e, 0x0a, 0x75, 0x29, 0x5d, 0x96, 0xf3, 0xf8, 0x11,
+  0x11, 0xa5, 0x53, 0xbe, 0xec, 0x39, 0x7b, 0x85, 0xd4, 0xb5, 0x9b, 0xd8, 0x6e, 0xbe, 0x96, 0xf9,
+  0x0c, 0x22, 0x5c, 0x16, 0x52, 0x09, 0x10, 0x68, 0xe6, 0xfd, 0x0a, 0xd1, 0xe5, 0x2a, 0x3d, 0xa2,
+  0x06, 0x0c, 0xf5, 0xbb, 0xab, 0xd5, 0xc6, 0x6c, 0xfd, 0xca, 0x72, 0x1d, 0x8d, 0x1b, 0x53, 0x53,
+  0xe1, 0x94, 0x13, 0xf1, 0x88, 0xe0, 0x0b, 0x29, 0xf7, 0x0e, 0xe5, 0x52, 0xba, 0xb6, 0x5f, 0x19,
+  0x7c, 0xf6, 0x14, 0x9e, 0x99, 0xe8, 0x62, 0x48, 0x8d, 0x11, 0x47, 0xcf, 0x85, 0x54, 0x01, 0x37,
+  0xd3, 0x7c, 0x8c, 0x7c, 0x66, 0x10, 0x07, 0xac, 0x7f, 0x29, 0xe4, 0x4d, 0x8c, 0x86, 0xab, 0x4c,
+  0x9a, 0xbc, 0xdd, 0xd1, 0x72, 0x15, 0xa2, 0xd0, 0xcc, 0x6c, 0x02, 0x58, 0x53, 0xb5, 0xd9, 0x63,
+  0x73, 0xef, 0xd6, 0x4b, 0x28, 0x9d, 0xf0, 0x29, 0xd0, 0x71, 0x3b, 0xc2, 0x74, 0x29, 0x57, 0xb0,
+  0x78, 0xfb, 0xb0, 0x5a, 0xe3, 0x89, 0x3f, 0x3d, 0x02, 0xec, 0x71, 0x8f, 0xc4, 0x1f, 0xe4, 0x48,
+  0xec, 0x05, 0x9d, 0xe6, 0x9b, 0xa2, 0x8a, 0xa9, 0xfa, 0x4e, 0x92, 0x6d, 0x03, 0xae, 0xd4, 0x9b,
+  0x09, 0x57, 0x2e, 0x6b, 0x36, 0x61, 0x63, 0x0f, 0x58, 0x06, 0x73, 0xbb, 0x5d, 0x69, 0x9b, 0xcf,
+  0x97, 0x79, 0xf9, 0xba, 0xc5, 0x6c, 0xd1, 0x50, 0xe7, 0xff, 0x1e, 0x38, 0xf9, 0xb7, 0x84, 0x93,
+  0x63, 0x25, 0x6c, 0xd7, 0x1f, 0x3e, 0xa8, 0x95, 0xfb, 0x4d, 0x7d, 0x7b, 0x8e, 0xea, 0x16, 0xb8,
+  0x32, 0x9d, 0xad, 0xca, 0xc1, 0x5b, 0xfe, 0x58, 0x6c, 0xcd, 0x80, 0x84, 0xad, 0x61, 0x17, 0x00,
+  0xd8, 0x19, 0x39, 0x17, 0x72, 0xbe, 0x7f, 0x79, 0x3b, 0xde, 0xeb, 0x74, 0x21, 0x77, 0xad, 0xc1,
+  0x20, 0xa5, 0xea, 0x5a, 0xdc, 0x01, 0x3a, 0xcd, 0xee, 0x52, 0x88, 0x6a, 0x0d, 0x7c, 0x5f, 0xed,
+  0xf1, 0x05, 0x56, 0x85, 0x68, 0xad, 0xe9, 0xa6, 0xd2, 0x15, 0xa3, 0x2c, 0x8a, 0xa3, 0x58, 0xf1,
+  0xfa, 0xc3, 0x32, 0xef, 0x16, 0x71, 0xf5, 0x1d, 0x8c, 0x44, 0xc2, 0x3c, 0x28, 0x33, 0x2f, 0xd1,
+  0xe6, 0x91, 0x24, 0x28, 0x9c, 0xb0, 0x4a, 0x67, 0xd1, 0xf9, 0x8a, 0x71, 0xb4, 0xc4, 0x8a, 0x79,
+  0x70, 0x58, 0x66, 0x96, 0xc1, 0x20, 0x61, 0x97, 0x82, 0x20, 0x72, 0x0e, 0xdd, 0x40, 0x13, 0x5e,
+  0x16, 0xb6, 0x56, 0xbd, 0x5b, 0x31, 0x4c, 0xc9, 0x8b, 0x66, 0x99, 0x56, 0xf3, 0x91, 0xd0, 0xea,
+  0x0d, 0xca, 0x4a, 0x97, 0x31, 0x94, 0x79, 0x83, 0x22, 0xa4, 0x99, 0xa6, 0x5a, 0x31, 0x11, 0x52,
+  0x96, 0x27, 0x0c, 0x57, 0x2e, 0x90, 0x90, 0x99, 0x4d, 0xbf, 0x6c, 0xf3, 0x94, 0x2d, 0x99, 0x44,
+  0x9a, 0x63, 0x1a, 0xcc, 0x71, 0x09, 0x78, 0xdd, 0x61, 0x59, 0xeb, 0x0c, 0xee, 0xca, 0x3c, 0x4d,
+  0x66, 0xb7, 0x92, 0x31, 0x8d, 0x49, 0x19, 0xcb, 0xd4, 0x52, 0x30, 0xc9, 0x66, 0xe7, 0x0c, 0x66,
+  0x6c, 0xea, 0x68, 0xa2, 0x9b, 0x38, 0x6a, 0x19, 0x4d, 0xad, 0x6e, 0xa7, 0x6c, 0xf9, 0x5e, 0xce,
+  0xe0, 0x02, 0xd2, 0xe4, 0xd4, 0x4e, 0xa5, 0x14, 0x1a, 0xd0, 0x32, 0x96, 0x79, 0xea, 0x09, 0x5f,
+  0x62, 0x30, 0x4a, 0x21, 0xd6, 0x18, 0x53, 0x55, 0x32, 0xc2, 0x71, 0x61, 0xa4, 0x74, 0x7c, 0x69,
+  0x8a, 0xb5, 0x3a, 0x95, 0x5e, 0xed, 0x6a, 0x62, 0xa7, 0x4a, 0xd4, 0xb5, 0x50, 0x93, 0x5b, 0xaa,
+  0x01, 0xf3, 0x83, 0x65, 0x67, 0xe8, 0x12, 0x6a, 0xce, 0x19, 0xda, 0xe2, 0xd9, 0x5f, 0x98, 0x87,
+  0xaa, 0xa3, 0x0a, 0xf3, 0xff, 0x1a, 0x9f, 0x25, 0xef, 0x89, 0xe5, 0x14, 0x29, 0x6e, 0x18, 0x0d,
+  0x13, 0xd0, 0x1e, 0x94, 0xc8, 0xa7, 0x98, 0x47, 0x24, 0x23, 0x27, 0x96, 0x53, 0xdc, 0xb9, 0x81,
+  0xa4, 0x89, 0x4c, 0x38, 0x0d, 0x29, 0xa5, 0xff, 0x4d, 0x68, 0x08, 0xbd, 0xa6, 0xaa, 0xa8, 0x3d,
+  0x2f, 0x4f, 0x5e, 0x1d, 0xa4, 0x0d, 0xe2, 0x80, 0xab, 0x93, 0x69, 0xa2, 0x59, 0x4a, 0x36, 0x7c,
+  0xca, 0xc6, 0x85, 0xe7, 0xe4, 0x25, 0x4b, 0xd0, 0x1b, 0xaf, 0x60, 0x79, 0x50, 0xd4, 0x03, 0xc3,
+  0x48, 0x3a, 0x6a, 0x52, 0x62, 0xe1, 0x0d, 0x80, 0xb6, 0xa2, 0x0d, 0x0d, 0xc1, 0x2f, 0x28, 0x1d,
+  0xfb, 0x79, 0x5f, 0xd6, 0x67, 0x4f, 0xca, 0x34, 0x34, 0xa0, 0x2b, 0x57, 0xca, 0x78, 0xaf, 0x67,
+  0x92, 0x59, 0x04, 0x4a, 0xaa, 0xc7, 0x7b, 0x07, 0x7d, 0x53, 0x5a, 0xae, 0x36, 0xb0, 0x04, 0xa8,
+  0x83, 0xf3, 0x9b, 0x56, 0x4c, 0xbb, 0x94, 0x98, 0x1f, 0x9c, 0x8c, 0x33, 0xa0, 0x7d, 0x34, 0x04,
+  0xbf, 0xc3, 0x50, 0x63, 0x49, 0x89, 0x0e, 0xcc, 0xd4, 0x96, 0x67, 0x5b, 0x7e, 0xf3, 0xcd, 0x21,
+  0x09, 0x64, 0x33, 0xb1, 0xf9, 0x78, 0x4c, 0xe9, 0xb9, 0x25, 0x3d, 0xf1, 0x3c, 0xa7, 0xdf, 0xcd,
+  0x3c, 0xcf, 0x07, 0xdf, 0x45, 0x3c, 0x4f, 0x80, 0x40, 0x71, 0xb2, 0x8a, 0xd7, 0x79, 0x66, 0x8e,
+  0xf5, 0x60, 0x4c, 0xc9, 0xf9, 0xd9, 0xe9, 0x8c, 0x05, 0xa2, 0xce, 0x7d, 0x6e, 0xe5, 0x1c, 0xf1,
+  0xe7, 0xa4, 0xd3, 0x14, 0xab, 0x7a, 0xc4, 0x49, 0x88, 0x23, 0x44, 0x92, 0x2e, 0xd6, 0x38, 0x6c,
+  0x19, 0xca, 0x29, 0x33, 0x77, 0xc1, 0x9c, 0xbc, 0x19, 0xab, 0x62, 0xf6, 0xfe, 0x35, 0xa4, 0x58,
+  0xad, 0x38, 0x83, 0x5e, 0x9d, 0x79, 0xc3, 0x78, 0x38, 0xbb, 0x62, 0xcf, 0x89, 0x5d, 0xb3, 0x38,
+  0xc5, 0xac, 0x4e, 0x19, 0x26, 0x0a, 0x67, 0xc3, 0x1f, 0x18, 0x1f, 0xab, 0x0c, 0xbe, 0x80, 0xce,
+  0x00, 0x8e, 0x9a, 0x49, 0x65, 0xbc, 0x34, 0x16, 0x44, 0x3d, 0xb0, 0x2a, 0x6b, 0x02, 0x30, 0x06,
+  0xfd, 0x8a, 0xd6, 0x19, 0xf8, 0xb0, 0x42, 0x6a, 0x13, 0x1d, 0x56, 0x46, 0xc1, 0x98, 0xd1, 0x25,
+  0xb4, 0xe0, 0x36, 0xce, 0x78, 0x95, 0xd3, 0xb6, 0x44, 0x19, 0x3c, 0xac, 0x8c, 0xa5, 0x2f, 0x84,
+  0x13, 0x98, 0x9d, 0x48, 0x12, 0x07, 0x86, 0x69, 0x3a, 0x9e, 0xf1, 0xcb, 0x96, 0x71, 0x29, 0x4a,
+  0x13, 0xfa, 0x38, 0x23, 0xb6, 0xff, 0x11, 0xf2, 0x47, 0x20, 0x47, 0x38, 0x7b, 0xd8, 0x35, 0x5d,
+  0xb9, 0x22, 0xa2, 0x79, 0xf4, 0x5b, 0xf2, 0xd3, 0x54, 0x36, 0x85, 0x03, 0xc5, 0x6c, 0xe7, 0xdf,
+  0x3a, 0xf0, 0x25, 0x33, 0x67, 0x54, 0xb0, 0x08, 0x36, 0x0e, 0xb6, 0x74, 0x9d, 0x07, 0x16, 0xf3,
+  0x86, 0xfe, 0x6d, 0xb2, 0x41, 0xc4, 0xc8, 0x69, 0xec, 0x35, 0x2a, 0xbf, 0x3a, 0x83, 0xc5, 0xff,
+  0x01, 0x66, 0xe5, 0x30, 0x5a, 0x88, 0x17, 0x00, 0x00,
+};
+
+#endif    // WM_ASSETS_H
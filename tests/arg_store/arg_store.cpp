@@ -0,0 +1,256 @@
+/****************************************************************************************************************************
+  arg_store.cpp
+  Host benchmark of the argument reads of handleWifiSave(), ESP_WMArgStore vs a server->arg(name) per field
+
+  A /wifisave of PARAMS custom parameters plus s, p, s1, p1, timezone, ip, gw, sn, dns1 and dns2. Old: the reads as
+  before the store, kept here as oldSave(), a String per field looked up by name. New: ESP_WMArgStore::load() and
+  the lookups handleWifiSave() makes, a new store each save, so its buffer allocated each time. Each against a server
+  returning the args by reference, as ESP8266WebServer and the patched ESP32 WebServer do, and one returning copies,
+  as the ESP32 core's does. Reports the heap allocations per save.
+
+  Also checks the store allocates its buffer once when a save has args past WM_ARG_STORE_MAX_ARGS, however long
+
+  The String of the stand-ins is a std::string, strings of up to 15 chars aren't allocated, as up to 10 or 11 aren't
+  with the Arduino String
+ *****************************************************************************************************************************/
+
+#define _WIFIMGR_LOGLEVEL_    0
+
+#include <ESP_WiFiManager.h>
+
+#include <iostream>
+#include <iomanip>
+#include <new>
+
+#define PARAMS                30
+#define SAVES                 200
+
+// As long as a MQTT server name or a token, past the String's inline buffer
+#define VALUE_LENGTH          24
+
+static unsigned long allocations = 0;
+
+// Not inlined, else g++ sees free() on what operator new returned
+__attribute__((noinline)) void* operator new(size_t size)
+{
+  allocations++;
+
+  void* p = malloc(size ? size : 1);
+
+  if (!p)
+    throw std::bad_alloc();
+
+  return p;
+}
+
+__attribute__((noinline)) void* operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+__attribute__((noinline)) void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+  allocations++;
+
+  return malloc(size ? size : 1);
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+  free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept
+{
+  free(p);
+}
+
+__attribute__((noinline)) void operator delete[](void* p) noexcept
+{
+  free(p);
+}
+
+__attribute__((noinline)) void operator delete[](void* p, size_t) noexcept
+{
+  free(p);
+}
+
+static ESP8266WebServer server(80);
+
+// The args as copies, as the ESP32 core's WebServer returns them
+class CopyingServer
+{
+  public:
+    int     args()                    { return server.args(); }
+    String  arg(int i)                { return server.arg(i); }
+    String  argName(int i)            { return server.argName(i); }
+    String  arg(const String& name)   { return server.arg(name); }
+};
+
+static char values[PARAMS][VALUE_LENGTH + 1];
+
+static const char* fields[] = { "s", "p", "s1", "p1", "timezone", "ip", "gw", "sn", "dns1", "dns2" };
+
+static String paramID(const int& i)
+{
+  return String("param") + String(i);
+}
+
+// The reads of handleWifiSave() before the store
+template<typename TServer>
+static void oldSave(TServer& srv)
+{
+  String    ssid, pass, ssid1, pass1, timezone;
+  IPAddress ip;
+
+  ssid  = srv.arg("s").c_str();
+  pass  = srv.arg("p").c_str();
+  ssid1 = srv.arg("s1").c_str();
+  pass1 = srv.arg("p1").c_str();
+
+  if (srv.arg("timezone") != "")
+    timezone = srv.arg("timezone");
+
+  for (int i = 0; i < PARAMS; i++)
+  {
+    String value = srv.arg(paramID(i)).c_str();
+
+    value.toCharArray(values[i], VALUE_LENGTH + 1);
+  }
+
+  for (const char* name : { "ip", "gw", "sn", "dns1", "dns2" })
+  {
+    if (srv.arg(name) != "")
+    {
+      String value = srv.arg(name);
+      ip.fromString(value.c_str());
+    }
+  }
+}
+
+// The reads of handleWifiSave() now. The param IDs are the sketch's, made once in main()
+template<typename TServer>
+static void newSave(TServer& srv, const String* ids)
+{
+  ESP_WMArgStore  store;
+  String          ssid, pass, ssid1, pass1, timezone;
+  IPAddress       ip;
+
+  store.load(srv);
+
+  ssid  = store.value("s");
+  pass  = store.value("p");
+  ssid1 = store.value("s1");
+  pass1 = store.value("p1");
+
+  if (*store.value("timezone"))
+    timezone = store.value("timezone");
+
+  for (int i = 0; i < PARAMS; i++)
+  {
+    store.copy(ids[i].c_str(), values[i], VALUE_LENGTH + 1);
+  }
+
+  for (const char* name : { "ip", "gw", "sn", "dns1", "dns2" })
+  {
+    if (*store.value(name))
+      ip.fromString(store.value(name));
+  }
+}
+
+static double perSave(std::function<void(void)> save)
+{
+  unsigned long calls = allocations;
+
+  for (int i = 0; i < SAVES; i++)
+  {
+    save();
+  }
+
+  return (double) (allocations - calls) / SAVES;
+}
+
+static std::string value(const char* prefix, const int& i)
+{
+  std::string v = std::string(prefix) + std::to_string(i);
+
+  return v + std::string(VALUE_LENGTH - v.size(), 'x');
+}
+
+int main()
+{
+  std::string args = "s=HomeNetwork-5GHz-Upstairs&p=" + value("secret", 0) + "&s1=GuestNetwork-2.4GHz-Floor&p1=" +
+                     value("secret", 1) + "&timezone=Europe/Amsterdam&ip=192.168.100.120&gw=192.168.100.1"
+                     "&sn=255.255.255.0&dns1=192.168.100.1&dns2=8.8.8.8";
+
+  String ids[PARAMS];
+
+  for (int i = 0; i < PARAMS; i++)
+  {
+    ids[i] = paramID(i);
+    args  += "&" + std::string(ids[i].c_str()) + "=" + value("value", i);
+  }
+
+  double oldRef, oldCopy, newRef, newCopy;
+
+  server.on("/wifisave", [&]()
+  {
+    CopyingServer copying;
+
+    oldRef  = perSave([]() { oldSave(server); });
+    oldCopy = perSave([&copying]() { oldSave(copying); });
+    newRef  = perSave([&ids]() { newSave(server, ids); });
+    newCopy = perSave([&copying, &ids]() { newSave(copying, ids); });
+  });
+
+  server.request("/wifisave", args, HTTP_POST);
+  server.handleClient();
+
+  bool pass = (strcmp(values[PARAMS - 1], value("value", PARAMS - 1).c_str()) == 0);
+
+  std::cout << PARAMS << " parameters + " << sizeof(fields) / sizeof(fields[0]) << " fields, " << SAVES
+            << " saves each, allocations per save" << std::fixed << std::setprecision(1)
+            << "\n                 by reference  copies"
+            << "\nold  arg(name)   " << std::setw(12) << oldRef << std::setw(8) << oldCopy
+            << "\nnew  ArgStore    " << std::setw(12) << newRef << std::setw(8) << newCopy << "\n";
+
+  // Past WM_ARG_STORE_MAX_ARGS, the args left out are 2KB each
+  std::string many;
+
+  for (int i = 0; i < WM_ARG_STORE_MAX_ARGS + 12; i++)
+  {
+    many += "&a" + std::to_string(i) + "=" + ((i < WM_ARG_STORE_MAX_ARGS) ? "1" : std::string(2048, 'x'));
+  }
+
+  unsigned long overflow = 0;
+
+  server.on("/many", [&overflow]()
+  {
+    ESP_WMArgStore store;
+
+    unsigned long calls = allocations;
+
+    store.load(server);
+    overflow = allocations - calls;
+  });
+
+  server.request("/many", many.substr(1), HTTP_POST);
+  server.handleClient();
+
+  std::cout << WM_ARG_STORE_MAX_ARGS + 12 << " args, 12 of 2KB left out: " << overflow << " allocation(s)\n";
+
+  if (!pass)
+    std::cout << "FAIL: the parameters weren't read\n";
+
+  if (newRef >= oldRef)
+    std::cout << "FAIL: the store allocates as much as the reads by name\n";
+
+  if (overflow != 1)
+    std::cout << "FAIL: the store grew for args it leaves out\n";
+
+  pass = pass && (newRef < oldRef) && (overflow == 1);
+
+  std::cout << (pass ? "PASS\n" : "FAIL\n");
+
+  return pass ? 0 : 1;
+}
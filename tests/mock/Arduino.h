@@ -0,0 +1,264 @@
+/****************************************************************************************************************************
+  Arduino.h
+  Host stand-in of the Arduino core, just what ESP_WiFiManager and the patched ESP32 WebServer use, to build the tests/
+  programs with g++
+
+  millis() is a virtual clock, moved on by delay() and mockAdvance() only. Time spent blocking in the library is
+  then seen, the same on any host, as the clock moving during a call. mockOnYield lets a test step into a blocking
+  loop at its yield() calls
+ *****************************************************************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cctype>
+#include <strings.h>
+#include <functional>
+
+#define PROGMEM
+#define PGM_P                 const char*
+#define PSTR(x)               (x)
+
+class __FlashStringHelper;
+
+#define F(x)                  (reinterpret_cast<const __FlashStringHelper*>(x))
+#define FPSTR(x)              (reinterpret_cast<const __FlashStringHelper*>(x))
+
+#define strlen_P              strlen
+#define memcpy_P              memcpy
+#define strncpy_P             strncpy
+#define strcmp_P              strcmp
+#define strncmp_P             strncmp
+#define snprintf_P            snprintf
+#define memccpy_P             memccpy
+#define PGM_VOID_P            const void*
+#define pgm_read_byte(p)      (*(const uint8_t*)(p))
+
+#define HEX                   16
+#define DEC                   10
+
+#define RANDOM_REG32          (0x12345678u)
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+unsigned long millis();
+unsigned long micros();
+void          delay(unsigned long ms);
+void          yield();
+long          random(long max);
+long          random(long min, long max);
+
+// Virtual clock
+void          mockAdvance(unsigned long ms);
+
+// Called by yield(), for a test to act from inside a blocking loop of the library
+extern std::function<void(void)> mockOnYield;
+
+#ifdef ESP32
+inline uint32_t esp_random()
+{
+  return (uint32_t) random(0x7FFFFFFF);
+}
+#endif
+
+class String
+{
+  public:
+
+    String() {}
+    String(const char* c)                     { if (c) s = c; }
+    String(const __FlashStringHelper* c)      { if (c) s = (const char*) c; }
+    String(const std::string& x) : s(x)       {}
+    String(char c)                            { s = c; }
+    String(int v, int base = 10)              { format(base == 16 ? "%x" : "%d", v); }
+    String(unsigned v, int base = 10)         { format(base == 16 ? "%x" : "%u", v); }
+    String(long v, int base = 10)             { format(base == 16 ? "%lx" : "%ld", v); }
+    String(unsigned long v, int base = 10)    { format(base == 16 ? "%lx" : "%lu", v); }
+    String(float v, unsigned d = 2)           { format("%.*f", d, (double) v); }
+    String(double v, unsigned d = 2)          { format("%.*f", d, v); }
+
+    const char* c_str() const                 { return s.c_str(); }
+    unsigned    length() const                { return s.size(); }
+    bool        reserve(unsigned n)           { s.reserve(n); return true; }
+    bool        isEmpty() const               { return s.empty(); }
+
+    String& operator+=(const String& o)       { s += o.s; return *this; }
+    String& operator+=(const char* o)         { s += o; return *this; }
+    String& operator+=(const __FlashStringHelper* o) { s += (const char*) o; return *this; }
+    String& operator+=(char c)                { s += c; return *this; }
+    String& operator+=(int v)                 { s += std::to_string(v); return *this; }
+    String& operator+=(unsigned v)            { s += std::to_string(v); return *this; }
+    String& operator+=(long v)                { s += std::to_string(v); return *this; }
+    String& operator+=(unsigned long v)       { s += std::to_string(v); return *this; }
+    String& operator+=(float v)               { s += std::to_string(v); return *this; }
+
+    bool concat(const char* c, unsigned n)    { s.append(c, n); return true; }
+    bool concat(const String& c)              { s += c.s; return true; }
+    bool concat(const char* c)                { s += c; return true; }
+    bool concat(char c)                       { s += c; return true; }
+    bool concat(int v)                        { s += std::to_string(v); return true; }
+
+    bool operator==(const String& o) const    { return s == o.s; }
+    bool operator==(const char* o) const      { return s == o; }
+    bool operator!=(const String& o) const    { return s != o.s; }
+    bool operator!=(const char* o) const      { return s != o; }
+
+    char operator[](unsigned i) const         { return s[i]; }
+    char charAt(unsigned i) const             { return s[i]; }
+
+    void replace(const String& a, const String& b)
+    {
+      size_t p = 0;
+
+      while ( (p = s.find(a.s, p)) != std::string::npos )
+      {
+        s.replace(p, a.s.size(), b.s);
+        p += b.s.size();
+      }
+    }
+
+    void toUpperCase()                        { for (auto& c : s) c = toupper(c); }
+    void toLowerCase()                        { for (auto& c : s) c = tolower(c); }
+
+    void trim()
+    {
+      size_t first = s.find_first_not_of(" \t\r\n");
+      size_t last  = s.find_last_not_of(" \t\r\n");
+
+      s = (first == std::string::npos) ? std::string() : s.substr(first, last - first + 1);
+    }
+
+    int  toInt() const                        { return atoi(s.c_str()); }
+
+    void toCharArray(char* b, unsigned n) const
+    {
+      strncpy(b, s.c_str(), n);
+
+      if (n)
+        b[n - 1] = 0;
+    }
+
+    int indexOf(char c, unsigned from = 0) const
+    {
+      size_t p = s.find(c, from);
+
+      return (p == std::string::npos) ? -1 : (int) p;
+    }
+
+    int indexOf(const String& c, unsigned from = 0) const
+    {
+      size_t p = s.find(c.s, from);
+
+      return (p == std::string::npos) ? -1 : (int) p;
+    }
+
+    // Empty past the end, as in the core
+    String substring(unsigned a) const                { return (a < s.size()) ? String(s.substr(a)) : String(); }
+    String substring(unsigned a, unsigned b) const    { return (a < s.size() && a < b) ? String(s.substr(a, b - a)) : String(); }
+    bool   startsWith(const String& p) const          { return s.rfind(p.s, 0) == 0; }
+    bool   endsWith(const String& p) const            { return (s.size() >= p.s.size()) &&
+                                                               (s.compare(s.size() - p.s.size(), p.s.size(), p.s) == 0); }
+    bool   equalsConstantTime(const String& o) const  { return s == o.s; }
+    bool   equalsIgnoreCase(const String& o) const    { return strcasecmp(s.c_str(), o.c_str()) == 0; }
+
+    std::string s;
+
+  private:
+
+    template<typename... Args> void format(const char* fmt, Args... args)
+    {
+      char buf[32];
+
+      snprintf(buf, sizeof(buf), fmt, args...);
+      s = buf;
+    }
+};
+
+// As in the core, a sum is an lvalue, which can be passed as String&
+class StringSumHelper : public String
+{
+  public:
+
+    StringSumHelper(const String& s) : String(s) {}
+    StringSumHelper(const char* p) : String(p) {}
+};
+
+inline StringSumHelper& operator+(const StringSumHelper& a, const String& b)
+{
+  StringSumHelper& sum = const_cast<StringSumHelper&>(a);
+
+  sum.s += b.s;
+
+  return sum;
+}
+
+inline StringSumHelper& operator+(const StringSumHelper& a, const char* b)                 { return a + String(b); }
+inline StringSumHelper& operator+(const StringSumHelper& a, char b)                        { return a + String(b); }
+inline StringSumHelper& operator+(const StringSumHelper& a, const __FlashStringHelper* b)  { return a + String(b); }
+
+class Print
+{
+  public:
+
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c)                     { (void) c; return 1; }
+    virtual size_t write(const uint8_t* b, size_t n)    { (void) b; return n; }
+    size_t         write(const char* b, size_t n)       { return write((const uint8_t*) b, n); }
+
+    template<class T> size_t print(const T&)            { return 0; }
+    template<class T> size_t print(const T&, int)       { return 0; }
+    template<class T> size_t println(const T&)          { return 0; }
+    size_t                   println()                  { return 0; }
+    size_t                   printf(const char*, ...)   { return 0; }
+};
+
+class Stream : public Print
+{
+  public:
+
+    virtual int available()   { return 0; }
+    virtual int read()        { return -1; }
+};
+
+class HardwareSerial : public Stream
+{
+  public:
+
+    void begin(int) {}
+};
+
+extern HardwareSerial Serial;
+
+class IPAddress
+{
+  public:
+
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : addr(a | (b << 8) | (c << 16) | ((uint32_t) d << 24)) {}
+    IPAddress(uint32_t v) : addr(v) {}
+
+    operator uint32_t() const               { return addr; }
+    uint8_t operator[](int i) const         { return (addr >> (8 * i)) & 0xff; }
+
+    bool    fromString(const char*)         { return true; }
+    bool    isSet() const                   { return addr != 0; }
+
+    String  toString() const
+    {
+      char buf[16];
+
+      snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+
+      return String(buf);
+    }
+
+    uint32_t addr = 0;
+};
+
+#define INADDR_NONE           IPAddress(0, 0, 0, 0)
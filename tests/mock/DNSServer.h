@@ -0,0 +1,25 @@
+/****************************************************************************************************************************
+  DNSServer.h
+  Host stand-in of the captive portal DNS server
+ *****************************************************************************************************************************/
+
+#pragma once
+
+#include "Arduino.h"
+
+enum class DNSReplyCode
+{
+  NoError           = 0,
+  ServerFailure     = 2,
+  NonExistentDomain = 3
+};
+
+class DNSServer
+{
+  public:
+
+    void setErrorReplyCode(DNSReplyCode) {}
+    bool start(uint16_t, const String&, IPAddress) { return true; }
+    void stop() {}
+    void processNextRequest() {}
+};
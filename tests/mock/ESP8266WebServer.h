@@ -0,0 +1,176 @@
+/****************************************************************************************************************************
+  ESP8266WebServer.h
+  Host stand-in of the ESP8266 web server. Requests queued by request() are served by handleClient(), one per call as
+  the real server does, the responses appended to out
+ *****************************************************************************************************************************/
+
+#pragma once
+
+#include "ESP8266WiFi.h"
+#include <deque>
+#include <map>
+#include <utility>
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t) -1)
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+
+class ESP8266WebServer
+{
+  public:
+
+    typedef std::function<void(void)> THandlerFunction;
+    typedef std::vector<std::pair<String, String>> Args;
+
+    ESP8266WebServer(int port)
+    {
+      (void) port;
+
+      instance = this;
+    }
+
+    ~ESP8266WebServer()
+    {
+      if (instance == this)
+        instance = nullptr;
+    }
+
+    // The last one created, for the tests to send requests to the portal
+    static inline ESP8266WebServer* instance = nullptr;
+
+    void on(const String& uri, THandlerFunction fn)               { _handlers[uri.s] = fn; }
+    void on(const String& uri, HTTPMethod, THandlerFunction fn)   { _handlers[uri.s] = fn; }
+    void onNotFound(THandlerFunction fn)                          { _notFound = fn; }
+
+    void begin()    {}
+    void stop()     {}
+    void close()    {}
+
+    // args as "name=value&name=value", not URL encoded
+    void request(const std::string& uri, const std::string& args = "", HTTPMethod method = HTTP_GET)
+    {
+      _queue.push_back({ uri, parseArgs(args), method });
+    }
+
+    void handleClient()
+    {
+      if (_queue.empty())
+        return;
+
+      _current = _queue.front();
+      _queue.pop_front();
+
+      auto it = _handlers.find(_current.uri);
+
+      if (it != _handlers.end())
+        it->second();
+      else if (_notFound)
+        _notFound();
+
+      served++;
+    }
+
+    void collectHeaders(const char**, size_t) {}
+    String header(const String&)        { return String(); }
+    bool   hasHeader(const String&)     { return false; }
+    String hostHeader()                 { return String("192.168.4.1"); }
+    String uri()                        { return String(_current.uri); }
+    HTTPMethod method()                 { return _current.method; }
+
+    int    args()                       { return _current.args.size(); }
+    // By reference, as the core does
+    const String& arg(int i)            { return (i < args()) ? _current.args[i].second : emptyArg(); }
+    const String& argName(int i)        { return (i < args()) ? _current.args[i].first : emptyArg(); }
+
+    const String& arg(const String& name)
+    {
+      for (auto& a : _current.args)
+      {
+        if (a.first == name)
+          return a.second;
+      }
+
+      return emptyArg();
+    }
+
+    bool hasArg(const String& name)
+    {
+      for (auto& a : _current.args)
+      {
+        if (a.first == name)
+          return true;
+      }
+
+      return false;
+    }
+
+    void sendHeader(const String& name, const String& value, bool = false)
+    {
+      out += name.s + ": " + value.s + "\r\n";
+    }
+
+    void setContentLength(size_t) {}
+
+    void send(int code, const char* type = nullptr, const String& body = String())
+    {
+      out += "HTTP " + std::to_string(code) + " " + (type ? type : "") + "\r\n\r\n" + body.s;
+    }
+
+    void send(int code, const String& type, const String& body)   { send(code, type.c_str(), body); }
+    void send_P(int code, PGM_P type, PGM_P body)                   { send(code, type, String(body)); }
+    void send_P(int code, PGM_P type, PGM_P body, size_t len)       { send(code, type, String(std::string(body, len))); }
+
+    void sendContent(const String& content)                         { out += content.s; }
+    void sendContent(const char* content, size_t len)               { out.append(content, len); }
+    void sendContent_P(PGM_P content)                               { out += content; }
+    void sendContent_P(PGM_P content, size_t len)                   { out.append(content, len); }
+
+    WiFiClient& client()                { static WiFiClient c; return c; }
+
+    std::string out;
+    int         served = 0;
+
+  private:
+
+    struct Request
+    {
+      std::string uri;
+      Args        args;
+      HTTPMethod  method;
+    };
+
+    static const String& emptyArg()
+    {
+      static const String empty;
+
+      return empty;
+    }
+
+    static Args parseArgs(const std::string& s)
+    {
+      Args    args;
+      size_t  p = 0;
+
+      while (p < s.size())
+      {
+        size_t q = s.find('&', p);
+
+        if (q == std::string::npos)
+          q = s.size();
+
+        std::string item  = s.substr(p, q - p);
+        size_t      eq    = item.find('=');
+
+        args.push_back({ String(item.substr(0, eq)), String((eq == std::string::npos) ? "" : item.substr(eq + 1)) });
+
+        p = q + 1;
+      }
+
+      return args;
+    }
+
+    std::map<std::string, THandlerFunction>   _handlers;
+    THandlerFunction                          _notFound;
+    std::deque<Request>                       _queue;
+    Request                                   _current = { "", {}, HTTP_GET };
+};
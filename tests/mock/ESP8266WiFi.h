@@ -0,0 +1,261 @@
+/****************************************************************************************************************************
+  ESP8266WiFi.h
+  Host stand-in of the ESP8266 WiFi class. The APs seen by scans are mockAPs, the connection is driven by the test
+  with mockGotIP() and mockDisconnected(), which fire the event handlers as the SDK would
+ *****************************************************************************************************************************/
+
+#pragma once
+
+#include "Arduino.h"
+#include <memory>
+#include <vector>
+
+typedef enum
+{
+  WL_NO_SHIELD        = 255,
+  WL_IDLE_STATUS      = 0,
+  WL_NO_SSID_AVAIL    = 1,
+  WL_SCAN_COMPLETED   = 2,
+  WL_CONNECTED        = 3,
+  WL_CONNECT_FAILED   = 4,
+  WL_CONNECTION_LOST  = 5,
+  WL_WRONG_PASSWORD   = 6,
+  WL_DISCONNECTED     = 7
+} wl_status_t;
+
+typedef enum
+{
+  WIFI_OFF    = 0,
+  WIFI_STA    = 1,
+  WIFI_AP     = 2,
+  WIFI_AP_STA = 3
+} WiFiMode_t;
+
+enum
+{
+  ENC_TYPE_WEP  = 5,
+  ENC_TYPE_TKIP = 2,
+  ENC_TYPE_CCMP = 4,
+  ENC_TYPE_NONE = 7,
+  ENC_TYPE_AUTO = 8
+};
+
+enum
+{
+  WIFI_DISCONNECT_REASON_AUTH_EXPIRE              = 2,
+  WIFI_DISCONNECT_REASON_4WAY_HANDSHAKE_TIMEOUT   = 15,
+  WIFI_DISCONNECT_REASON_NO_AP_FOUND              = 201,
+  WIFI_DISCONNECT_REASON_AUTH_FAIL                = 202,
+  WIFI_DISCONNECT_REASON_ASSOC_FAIL               = 203,
+  WIFI_DISCONNECT_REASON_HANDSHAKE_TIMEOUT        = 204
+};
+
+#define WIFI_SCAN_RUNNING     (-1)
+#define WIFI_SCAN_FAILED      (-2)
+
+struct WiFiEventStationModeConnected
+{
+  String  ssid;
+  uint8_t bssid[6];
+  uint8_t channel;
+};
+
+struct WiFiEventStationModeGotIP
+{
+  IPAddress ip;
+  IPAddress mask;
+  IPAddress gw;
+};
+
+struct WiFiEventStationModeDisconnected
+{
+  String  ssid;
+  uint8_t bssid[6];
+  uint8_t reason;
+};
+
+class WiFiEventHandlerOpaque {};
+typedef std::shared_ptr<WiFiEventHandlerOpaque> WiFiEventHandler;
+
+struct MockAP
+{
+  std::string ssid;
+  int32_t     rssi;
+  uint8_t     encryption;
+  int32_t     channel;
+  uint8_t     bssid[6];
+};
+
+// Seen by the scans
+extern std::vector<MockAP> mockAPs;
+
+// count APs of varied SSIDs, RSSI, channels and encryptions, some SSIDs on several APs
+void mockMakeAPs(const int& count);
+
+// Fire the event handlers
+void mockGotIP();
+void mockDisconnected(const uint8_t& reason);
+
+class WiFiClient : public Stream
+{
+  public:
+
+    uint8_t   connected()                   { return 1; }
+    void      stop()                        {}
+    void      flush()                       {}
+    void      setNoDelay(bool)              {}
+    size_t    availableForWrite()           { return 1460; }
+    IPAddress localIP()                     { return IPAddress(); }
+    IPAddress remoteIP()                    { return IPAddress(); }
+    size_t    write_P(PGM_P, size_t n)      { return n; }
+
+    operator bool()                         { return true; }
+
+    using Print::write;
+};
+
+class ESP8266WiFiClass
+{
+  public:
+
+    bool        mode(WiFiMode_t m)            { _mode = m; return true; }
+    WiFiMode_t  getMode()                     { return _mode; }
+    bool        enableSTA(bool)               { return true; }
+
+    wl_status_t begin(const char* ssid, const char* pass = nullptr, int32_t channel = 0, const uint8_t* bssid = nullptr,
+                      bool connect = true)
+    {
+      (void) pass; (void) channel; (void) bssid; (void) connect;
+
+      _ssid   = ssid ? ssid : "";
+      status_ = WL_DISCONNECTED;
+
+      return status_;
+    }
+
+    wl_status_t begin()                       { status_ = WL_DISCONNECTED; return status_; }
+    wl_status_t status()                      { return status_; }
+    int8_t      waitForConnectResult(unsigned long = 60000) { return status_; }
+
+    bool config(IPAddress, IPAddress, IPAddress, IPAddress = IPAddress(), IPAddress = IPAddress()) { return true; }
+
+    bool disconnect(bool = false)             { status_ = WL_DISCONNECTED; return true; }
+    bool reconnect()                          { return true; }
+    bool hostname(const char*)                { return true; }
+    bool getAutoConnect()                     { return true; }
+    bool setAutoConnect(bool)                 { return true; }
+    bool setAutoReconnect(bool)               { return true; }
+
+    bool      softAP(const char*, const char* = nullptr, int = 1, int = 0, int = 4) { return true; }
+    bool      softAPConfig(IPAddress, IPAddress, IPAddress)   { return true; }
+    bool      softAPdisconnect(bool = false)                  { return true; }
+    IPAddress softAPIP()                                      { return IPAddress(192, 168, 4, 1); }
+    String    softAPmacAddress()                              { return String("00:00:00:00:00:01"); }
+
+    IPAddress localIP()                       { return IPAddress(192, 168, 1, 10); }
+    IPAddress gatewayIP()                     { return IPAddress(192, 168, 1, 1); }
+    IPAddress subnetMask()                    { return IPAddress(255, 255, 255, 0); }
+    IPAddress dnsIP(uint8_t = 0)              { return IPAddress(192, 168, 1, 1); }
+    String    macAddress()                    { return String("00:00:00:00:00:02"); }
+
+    String    SSID()                          { return String(_ssid); }
+    String    psk()                           { return String(); }
+    int32_t   RSSI()                          { return -50; }
+    int32_t   channel()                       { return 1; }
+    uint8_t*  BSSID()                         { static uint8_t bssid[6]; return bssid; }
+    String    BSSIDstr()                      { return String(); }
+
+    // int16_t as on ESP32, the ESP8266 core's int8_t can't count the 200 AP scans of the benchmarks
+    int16_t scanNetworks(bool async = false, bool showHidden = false, uint8_t channel = 0, uint8_t* ssid = nullptr)
+    {
+      (void) showHidden; (void) channel; (void) ssid;
+
+      scans++;
+
+      return async ? WIFI_SCAN_RUNNING : (int16_t) mockAPs.size();
+    }
+
+    void      scanNetworksAsync(std::function<void(int)>, bool = false) {}
+    int16_t   scanComplete()                  { return (int16_t) mockAPs.size(); }
+    void      scanDelete()                    {}
+
+    // Each counted in driverCalls
+    String    SSID(uint8_t i)                 { driverCalls++; return (i < mockAPs.size()) ? String(mockAPs[i].ssid) : String(); }
+    int32_t   RSSI(uint8_t i)                 { driverCalls++; return (i < mockAPs.size()) ? mockAPs[i].rssi : 0; }
+    uint8_t   encryptionType(uint8_t i)       { driverCalls++; return (i < mockAPs.size()) ? mockAPs[i].encryption : 0; }
+    int32_t   channel(uint8_t i)              { driverCalls++; return (i < mockAPs.size()) ? mockAPs[i].channel : 0; }
+    bool      isHidden(uint8_t)               { return false; }
+    String    BSSIDstr(uint8_t)               { return String(); }
+
+    uint8_t*  BSSID(uint8_t i)
+    {
+      static uint8_t none[6];
+
+      driverCalls++;
+
+      return (i < mockAPs.size()) ? mockAPs[i].bssid : none;
+    }
+
+    // The core waits for the whole WPS walk time
+    bool beginWPSConfig()
+    {
+      delay(120000);
+
+      return false;
+    }
+
+    WiFiEventHandler onStationModeConnected(std::function<void(const WiFiEventStationModeConnected&)> f)
+    {
+      onConnected = f;
+
+      return std::make_shared<WiFiEventHandlerOpaque>();
+    }
+
+    WiFiEventHandler onStationModeGotIP(std::function<void(const WiFiEventStationModeGotIP&)> f)
+    {
+      onGotIP = f;
+
+      return std::make_shared<WiFiEventHandlerOpaque>();
+    }
+
+    WiFiEventHandler onStationModeDisconnected(std::function<void(const WiFiEventStationModeDisconnected&)> f)
+    {
+      onDisconnected = f;
+
+      return std::make_shared<WiFiEventHandlerOpaque>();
+    }
+
+    std::function<void(const WiFiEventStationModeConnected&)>     onConnected;
+    std::function<void(const WiFiEventStationModeGotIP&)>         onGotIP;
+    std::function<void(const WiFiEventStationModeDisconnected&)>  onDisconnected;
+
+    wl_status_t   status_     = WL_IDLE_STATUS;
+    int           scans       = 0;
+    unsigned long driverCalls = 0;
+
+  private:
+
+    WiFiMode_t    _mode       = WIFI_STA;
+    std::string   _ssid;
+};
+
+extern ESP8266WiFiClass WiFi;
+
+class EspClass
+{
+  public:
+
+    uint32_t getChipId()              { return 0x123456; }
+    uint32_t getFlashChipId()         { return 0; }
+    uint32_t getFlashChipSize()       { return 4194304; }
+    uint32_t getFlashChipRealSize()   { return 4194304; }
+    uint32_t getFreeHeap()            { return 40000; }
+    uint32_t random()                 { return 0; }
+    void     reset()                  {}
+    void     restart()                {}
+
+    bool rtcUserMemoryRead(uint32_t, uint32_t*, size_t)   { return false; }
+    bool rtcUserMemoryWrite(uint32_t, uint32_t*, size_t)  { return true; }
+};
+
+extern EspClass ESP;
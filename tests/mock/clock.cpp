@@ -0,0 +1,48 @@
+/****************************************************************************************************************************
+  clock.cpp
+  Virtual clock of the host stand-ins, and the rest of the Arduino core runtime
+ *****************************************************************************************************************************/
+
+#include "Arduino.h"
+
+HardwareSerial Serial;
+
+static unsigned long mockMillis = 0;
+
+std::function<void(void)> mockOnYield;
+
+unsigned long millis()
+{
+  return mockMillis;
+}
+
+unsigned long micros()
+{
+  return mockMillis * 1000;
+}
+
+void delay(unsigned long ms)
+{
+  mockMillis += ms;
+}
+
+void yield()
+{
+  if (mockOnYield)
+    mockOnYield();
+}
+
+void mockAdvance(unsigned long ms)
+{
+  mockMillis += ms;
+}
+
+long random(long max)
+{
+  return max ? (long) (mockMillis % max) : 0;
+}
+
+long random(long min, long max)
+{
+  return min + random(max - min);
+}
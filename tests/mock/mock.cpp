@@ -0,0 +1,128 @@
+/****************************************************************************************************************************
+  mock.cpp
+  State of the ESP8266 stand-ins: scanned APs, WiFi events and SDK WPS
+ *****************************************************************************************************************************/
+
+#include "Arduino.h"
+#include "ESP8266WiFi.h"
+
+extern "C"
+{
+  #include "user_interface.h"
+}
+
+ESP8266WiFiClass  WiFi;
+EspClass          ESP;
+
+std::vector<MockAP> mockAPs;
+
+static wps_st_cb_t    mockWPSCallback = nullptr;
+static bool           mockWPSStarted  = false;
+
+void mockMakeAPs(const int& count)
+{
+  mockAPs.clear();
+
+  for (int i = 0; i < count; i++)
+  {
+    MockAP ap;
+
+    // About a third of the SSIDs are on more than one AP
+    ap.ssid       = "net" + std::to_string( (i * 7) % ((count + 2) / 3 + 1) );
+    ap.rssi       = -40 - ((i * 37) % 56);
+    ap.encryption = (i % 4) ? ENC_TYPE_CCMP : ENC_TYPE_NONE;
+    ap.channel    = 1 + i % 11;
+
+    for (int k = 0; k < 6; k++)
+      ap.bssid[k] = (uint8_t) (i + k * 31);
+
+    mockAPs.push_back(ap);
+  }
+}
+
+void mockGotIP()
+{
+  WiFi.status_ = WL_CONNECTED;
+
+  if (WiFi.onConnected)
+  {
+    WiFiEventStationModeConnected event;
+
+    event.ssid    = WiFi.SSID();
+    event.channel = 1;
+
+    memset(event.bssid, 0, sizeof(event.bssid));
+    WiFi.onConnected(event);
+  }
+
+  if (WiFi.onGotIP)
+  {
+    WiFiEventStationModeGotIP event;
+
+    event.ip = WiFi.localIP();
+    WiFi.onGotIP(event);
+  }
+}
+
+void mockDisconnected(const uint8_t& reason)
+{
+  WiFi.status_ = (reason == WIFI_DISCONNECT_REASON_NO_AP_FOUND) ? WL_NO_SSID_AVAIL : WL_DISCONNECTED;
+
+  if (WiFi.onDisconnected)
+  {
+    WiFiEventStationModeDisconnected event;
+
+    event.ssid    = WiFi.SSID();
+    event.reason  = reason;
+
+    memset(event.bssid, 0, sizeof(event.bssid));
+    WiFi.onDisconnected(event);
+  }
+}
+
+extern "C"
+{
+  bool wifi_wps_enable(WPS_TYPE_t wps_type)
+  {
+    return (wps_type == WPS_TYPE_PBC);
+  }
+
+  bool wifi_wps_disable(void)
+  {
+    mockWPSStarted = false;
+
+    return true;
+  }
+
+  bool wifi_wps_start(void)
+  {
+    mockWPSStarted = (mockWPSCallback != nullptr);
+
+    return mockWPSStarted;
+  }
+
+  bool wifi_set_wps_cb(wps_st_cb_t cb)
+  {
+    mockWPSCallback = cb;
+
+    return true;
+  }
+
+  // Connects with the credentials WPS got
+  bool wifi_station_connect(void)
+  {
+    mockGotIP();
+
+    return true;
+  }
+
+  bool mockWPSDone(int status)
+  {
+    if (!mockWPSStarted)
+      return false;
+
+    mockWPSCallback(status);
+
+    return true;
+  }
+}
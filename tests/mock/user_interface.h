@@ -0,0 +1,35 @@
+/****************************************************************************************************************************
+  user_interface.h
+  Host stand-in of the ESP8266 SDK calls used by ESP_WiFiManager. WPS ends only when the test calls mockWPSDone()
+ *****************************************************************************************************************************/
+
+#pragma once
+
+typedef enum
+{
+  WPS_TYPE_DISABLE = 0,
+  WPS_TYPE_PBC,
+  WPS_TYPE_PIN,
+  WPS_TYPE_DISPLAY,
+  WPS_TYPE_MAX
+} WPS_TYPE_t;
+
+enum wps_cb_status
+{
+  WPS_CB_ST_SUCCESS = 0,
+  WPS_CB_ST_FAILED,
+  WPS_CB_ST_TIMEOUT,
+  WPS_CB_ST_WEP,
+  WPS_CB_ST_UNK
+};
+
+typedef void (*wps_st_cb_t)(int status);
+
+bool wifi_wps_enable(WPS_TYPE_t wps_type);
+bool wifi_wps_disable(void);
+bool wifi_wps_start(void);
+bool wifi_set_wps_cb(wps_st_cb_t cb);
+bool wifi_station_connect(void);
+
+// Calls the WPS callback. False if WPS isn't started
+bool mockWPSDone(int status);
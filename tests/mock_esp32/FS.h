@@ -0,0 +1,15 @@
+/****************************************************************************************************************************
+  FS.h
+  Host stand-in of the ESP32 file systems, not served by the benches
+ *****************************************************************************************************************************/
+
+#pragma once
+
+namespace fs
+{
+class FS {};
+class File {};
+}
+
+using fs::FS;
+using fs::File;
@@ -0,0 +1,18 @@
+/****************************************************************************************************************************
+  HTTP_Method.h
+  Host stand-in of the ESP32 core HTTP methods
+ *****************************************************************************************************************************/
+
+#pragma once
+
+typedef enum
+{
+  HTTP_ANY,
+  HTTP_GET,
+  HTTP_HEAD,
+  HTTP_POST,
+  HTTP_PUT,
+  HTTP_PATCH,
+  HTTP_DELETE,
+  HTTP_OPTIONS
+} HTTPMethod;
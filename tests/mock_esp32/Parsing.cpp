@@ -0,0 +1,91 @@
+/****************************************************************************************************************************
+  Parsing.cpp
+  Host stand-in of the ESP32 core WebServer request parsing: request line and headers only, as the benches send them.
+  Query strings and bodies are ignored
+ *****************************************************************************************************************************/
+
+#include "WebServer.h"
+
+bool WebServer::_parseRequest(WiFiClient& client)
+{
+  String req = client.readStringUntil('\r');
+  client.readStringUntil('\n');
+
+  for (int i = 0; i < _headerKeysCount; ++i)
+  {
+    _currentHeaders[i].value = String();
+  }
+
+  int addrStart = req.indexOf(' ');
+  int addrEnd   = req.indexOf(' ', addrStart + 1);
+
+  if ( (addrStart == -1) || (addrEnd == -1) )
+    return false;
+
+  String methodStr  = req.substring(0, addrStart);
+  String url        = req.substring(addrStart + 1, addrEnd);
+  int    search     = url.indexOf('?');
+
+  if (search != -1)
+    url = url.substring(0, search);
+
+  _currentVersion   = atoi(req.substring(addrEnd + 8).c_str());
+  _currentUri       = url;
+  _currentArgCount  = 0;
+  _chunked          = false;
+
+  if (methodStr == "POST")
+    _currentMethod = HTTP_POST;
+  else if (methodStr == "HEAD")
+    _currentMethod = HTTP_HEAD;
+  else
+    _currentMethod = HTTP_GET;
+
+  RequestHandler* handler;
+
+  for (handler = _firstHandler; handler; handler = handler->next())
+  {
+    if (handler->canHandle(_currentMethod, _currentUri))
+      break;
+  }
+
+  _currentHandler = handler;
+
+  while (true)
+  {
+    req = client.readStringUntil('\r');
+    client.readStringUntil('\n');
+
+    int headerDiv = req.indexOf(':');
+
+    if ( (req.length() == 0) || (headerDiv == -1) )
+      break;
+
+    String headerName   = req.substring(0, headerDiv);
+    String headerValue  = req.substring(headerDiv + 1);
+
+    headerValue.trim();
+
+    _collectHeader(headerName.c_str(), headerValue.c_str());
+
+    if (headerName.equalsIgnoreCase("Host"))
+      _hostHeader = headerValue;
+  }
+
+  return true;
+}
+
+bool WebServer::_collectHeader(const char* headerName, const char* headerValue)
+{
+  for (int i = 0; i < _headerKeysCount; i++)
+  {
+    if (_currentHeaders[i].key.equalsIgnoreCase(headerName))
+    {
+      _currentHeaders[i].value = headerValue;
+
+      return true;
+    }
+  }
+
+  return false;
+}
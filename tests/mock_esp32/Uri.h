@@ -0,0 +1,24 @@
+/****************************************************************************************************************************
+  Uri.h
+  Host stand-in of the ESP32 core Uri, exact match only
+ *****************************************************************************************************************************/
+
+#pragma once
+
+#include "Arduino.h"
+
+class Uri
+{
+  public:
+
+    Uri(const char* uri) : _uri(uri) {}
+    Uri(const String& uri) : _uri(uri) {}
+    virtual ~Uri() {}
+
+    virtual Uri* clone() const                                { return new Uri(_uri); }
+    virtual bool canHandle(const String& requestUri) const    { return _uri == requestUri; }
+
+  protected:
+
+    const String _uri;
+};
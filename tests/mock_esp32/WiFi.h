@@ -0,0 +1,10 @@
+/****************************************************************************************************************************
+  WiFi.h
+  Host stand-in of the ESP32 WiFi library, the sockets only
+ *****************************************************************************************************************************/
+
+#pragma once
+
+#include "Arduino.h"
+#include "WiFiClient.h"
+#include "WiFiServer.h"
@@ -0,0 +1,191 @@
+/****************************************************************************************************************************
+  WiFiClient.cpp
+  Host socket and backlog stand-ins for the patched ESP32 WebServer
+ *****************************************************************************************************************************/
+
+#include "WiFiClient.h"
+#include "WiFiServer.h"
+
+#include <algorithm>
+#include <deque>
+
+static std::deque<std::shared_ptr<MockSocket>> backlog;
+
+void MockSocket::send(const std::string& request, const unsigned long& delayMs, const unsigned long& intervalMs)
+{
+  rx.erase(0, rxPos);
+  rxPos = 0;
+
+  rx         += request;
+  rxAt        = millis() + delayMs;
+  rxInterval  = intervalMs;
+}
+
+size_t MockSocket::readable() const
+{
+  if (millis() < rxAt)
+    return 0;
+
+  if (!rxInterval)
+    return rx.size();
+
+  return std::min(rx.size(), (size_t) ((millis() - rxAt) / rxInterval + 1));
+}
+
+size_t MockSocket::responses() const
+{
+  size_t count = 0;
+
+  for (size_t p = tx.find("HTTP/1."); p != std::string::npos; p = tx.find("HTTP/1.", p + 1))
+  {
+    count++;
+  }
+
+  return count;
+}
+
+uint8_t WiFiClient::connected()
+{
+  MockSocket* s = socket();
+
+  return s && s->serverOpen && (s->clientOpen || available());
+}
+
+int WiFiClient::available()
+{
+  MockSocket* s = socket();
+
+  if (!s || !s->serverOpen)
+    return 0;
+
+  return s->readable() - std::min(s->rxPos, s->readable());
+}
+
+int WiFiClient::read()
+{
+  if (!available())
+    return -1;
+
+  MockSocket* s = socket();
+
+  return (uint8_t) s->rx[s->rxPos++];
+}
+
+int WiFiClient::read(uint8_t* buf, size_t size)
+{
+  int count = 0;
+  int c;
+
+  while ( ((size_t) count < size) && ((c = read()) >= 0) )
+  {
+    buf[count++] = (uint8_t) c;
+  }
+
+  return count;
+}
+
+int WiFiClient::peek()
+{
+  if (!available())
+    return -1;
+
+  return (uint8_t) socket()->rx[socket()->rxPos];
+}
+
+// Up to the terminator, which is dropped. As Stream in the core, waits up to the timeout for each byte
+String WiFiClient::readStringUntil(char terminator)
+{
+  String line;
+
+  while (true)
+  {
+    int c = read();
+
+    for (unsigned long start = millis(); (c < 0) && connected() && (millis() - start < _timeoutMs); c = read())
+    {
+      delay(1);
+    }
+
+    if ( (c < 0) || (c == terminator) )
+      break;
+
+    line += (char) c;
+  }
+
+  return line;
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size)
+{
+  MockSocket* s = socket();
+
+  if (!s || !s->serverOpen)
+    return 0;
+
+  if (s->keepTx)
+    s->tx.append((const char*) buf, size);
+
+  s->txBytes    += size;
+  s->txWrites   += 1;
+  s->txSegments += (size + MOCK_TCP_MSS - 1) / MOCK_TCP_MSS;
+
+  return size;
+}
+
+void WiFiClient::stop()
+{
+  if (socket())
+    socket()->serverOpen = false;
+}
+
+std::shared_ptr<MockSocket> mockConnect(const std::string& request, const unsigned long& handshakeMs,
+                                        const unsigned long& delayMs, const unsigned long& intervalMs)
+{
+  std::shared_ptr<MockSocket> socket = std::make_shared<MockSocket>();
+
+  socket->connectAt   = millis() + handshakeMs;
+  socket->rx          = request;
+  socket->rxAt        = socket->connectAt + delayMs;
+  socket->rxInterval  = intervalMs;
+
+  backlog.push_back(socket);
+
+  return socket;
+}
+
+size_t mockBacklog()
+{
+  return backlog.size();
+}
+
+bool WiFiServer::hasClient()
+{
+  if (!_listening)
+    return false;
+
+  for (auto& socket : backlog)
+  {
+    if (socket->connectAt <= millis())
+      return true;
+  }
+
+  return false;
+}
+
+// The first connection with its handshake done
+WiFiClient WiFiServer::available()
+{
+  for (auto it = backlog.begin(); _listening && (it != backlog.end()); ++it)
+  {
+    if ((*it)->connectAt <= millis())
+    {
+      WiFiClient client(*it);
+
+      backlog.erase(it);
+
+      return client;
+    }
+  }
+
+  return WiFiClient();
+}
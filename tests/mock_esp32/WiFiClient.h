@@ -0,0 +1,94 @@
+/****************************************************************************************************************************
+  WiFiClient.h
+  Host socket stand-in for the patched ESP32 WebServer. A MockSocket is one TCP connection: the bench writes the
+  client's bytes into rx and reads the server's from tx, and counts the writes the server makes. As in the core, the
+  server side is closed by stop() or when the last WiFiClient of the connection goes
+ *****************************************************************************************************************************/
+
+#pragma once
+
+#include "Arduino.h"
+#include <memory>
+
+// MSS of the TCP segments the writes are cut into
+#define MOCK_TCP_MSS          1436
+
+struct MockSocket
+{
+  // From the client, readable from rxAt on, or a byte every rxInterval ms from rxAt on if not 0
+  std::string   rx;
+  size_t        rxPos       = 0;
+  unsigned long rxAt        = 0;
+  unsigned long rxInterval  = 0;
+
+  // Accepted by the server from connectAt on, the handshake done
+  unsigned long connectAt   = 0;
+
+  // To the client. Only counted if keepTx is false
+  std::string   tx;
+  bool          keepTx      = true;
+  size_t        txBytes     = 0;
+  size_t        txWrites    = 0;
+  size_t        txSegments  = 0;
+
+  bool          clientOpen  = true;
+  bool          serverOpen  = true;
+
+  // The next request on the same connection, readable delayMs from now, or byte by byte every intervalMs
+  void send(const std::string& request, const unsigned long& delayMs = 0, const unsigned long& intervalMs = 0);
+
+  // Bytes of rx the server can read by now
+  size_t readable() const;
+
+  // Complete responses in tx, by their status lines, which the bodies must not contain
+  size_t responses() const;
+};
+
+class WiFiClient : public Stream
+{
+  public:
+
+    WiFiClient() {}
+    WiFiClient(const std::shared_ptr<MockSocket>& socket) : _handle(std::make_shared<Handle>(socket)) {}
+
+    operator bool() const                   { return (bool) _handle; }
+
+    WiFiClient(const WiFiClient&) = default;
+    WiFiClient& operator=(const WiFiClient&) = default;
+    virtual ~WiFiClient() {}
+
+    // Virtual as in the core's Client
+    virtual uint8_t connected();
+    int     available() override;
+    int     read() override;
+    virtual int read(uint8_t* buf, size_t size);
+    virtual int peek();
+    String  readStringUntil(char terminator);
+
+    size_t  write(uint8_t c) override       { return write(&c, 1); }
+    size_t  write(const uint8_t* buf, size_t size) override;
+    size_t  write(const char* buf, size_t size)   { return write((const uint8_t*) buf, size); }
+    size_t  write_P(PGM_P buf, size_t size)       { return write((const uint8_t*) buf, size); }
+
+    void    setTimeout(int seconds)         { _timeoutMs = seconds * 1000UL; }
+    void    setNoDelay(bool noDelay)        { (void) noDelay; }
+    void    flush()                         {}
+    void    stop();
+
+  private:
+
+    struct Handle
+    {
+      Handle(const std::shared_ptr<MockSocket>& s) : socket(s) {}
+      ~Handle()                               { socket->serverOpen = false; }
+
+      std::shared_ptr<MockSocket> socket;
+    };
+
+    MockSocket* socket() const              { return _handle ? _handle->socket.get() : nullptr; }
+
+    std::shared_ptr<Handle> _handle;
+
+    // Of Stream, 1 s by default
+    unsigned long           _timeoutMs = 1000;
+};
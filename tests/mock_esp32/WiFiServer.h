@@ -0,0 +1,36 @@
+/****************************************************************************************************************************
+  WiFiServer.h
+  Host stand-in of the listening socket. mockConnect() puts a connection into the backlog, accepted by the server once
+  its handshake is done
+ *****************************************************************************************************************************/
+
+#pragma once
+
+#include "WiFiClient.h"
+
+// A new connection, accepted from handshakeMs from now on, its first request readable delayMs after that, or
+// byte by byte every intervalMs
+std::shared_ptr<MockSocket> mockConnect(const std::string& request, const unsigned long& handshakeMs = 0,
+                                        const unsigned long& delayMs = 0, const unsigned long& intervalMs = 0);
+
+// Connections not accepted yet
+size_t mockBacklog();
+
+class WiFiServer
+{
+  public:
+
+    WiFiServer(int port = 80)                   { (void) port; }
+    WiFiServer(IPAddress addr, int port = 80)   { (void) addr; (void) port; }
+
+    void begin(uint16_t port = 0)               { (void) port; _listening = true; }
+    void setNoDelay(bool noDelay)               { (void) noDelay; }
+    void close()                                { _listening = false; }
+
+    bool        hasClient();
+    WiFiClient  available();
+
+  private:
+
+    bool _listening = false;
+};
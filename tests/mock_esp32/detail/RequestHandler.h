@@ -0,0 +1,53 @@
+/****************************************************************************************************************************
+  RequestHandler.h
+  Host stand-in of the ESP32 core request handler interface
+ *****************************************************************************************************************************/
+
+#pragma once
+
+class RequestHandler
+{
+  public:
+
+    virtual ~RequestHandler() {}
+
+    virtual bool canHandle(HTTPMethod method, String uri)
+    {
+      (void) method;
+      (void) uri;
+
+      return false;
+    }
+
+    virtual bool canUpload(String uri)
+    {
+      (void) uri;
+
+      return false;
+    }
+
+    virtual bool handle(WebServer& server, HTTPMethod requestMethod, String requestUri)
+    {
+      (void) server;
+      (void) requestMethod;
+      (void) requestUri;
+
+      return false;
+    }
+
+    virtual void upload(WebServer& server, String requestUri, HTTPUpload& upload)
+    {
+      (void) server;
+      (void) requestUri;
+      (void) upload;
+    }
+
+    RequestHandler* next()                  { return _next; }
+    void            next(RequestHandler* r) { _next = r; }
+
+    String          pathArg(unsigned int i) { (void) i; return String(); }
+
+  private:
+
+    RequestHandler* _next = nullptr;
+};
@@ -0,0 +1,88 @@
+/****************************************************************************************************************************
+  RequestHandlersImpl.h
+  Host stand-in of the ESP32 core request handlers and MIME table. Static files aren't served
+ *****************************************************************************************************************************/
+
+#pragma once
+
+#include "RequestHandler.h"
+#include "FS.h"
+
+namespace mime
+{
+enum type
+{
+  html,
+  txt,
+  json,
+  gz,
+  none,
+  maxType
+};
+
+struct Entry
+{
+  const char endsWith[16];
+  const char mimeType[32];
+};
+
+const Entry mimeTable[maxType] =
+{
+  { ".html",  "text/html" },
+  { ".txt",   "text/plain" },
+  { ".json",  "application/json" },
+  { ".gz",    "application/x-gzip" },
+  { "",       "application/octet-stream" }
+};
+}
+
+class FunctionRequestHandler : public RequestHandler
+{
+  public:
+
+    FunctionRequestHandler(WebServer::THandlerFunction fn, WebServer::THandlerFunction ufn, const Uri& uri,
+                           HTTPMethod method)
+      : _fn(fn), _ufn(ufn), _uri(uri.clone()), _method(method)
+    {
+    }
+
+    bool canHandle(HTTPMethod requestMethod, String requestUri) override
+    {
+      if ( (_method != HTTP_ANY) && (_method != requestMethod) )
+        return false;
+
+      return _uri->canHandle(requestUri);
+    }
+
+    bool handle(WebServer& server, HTTPMethod requestMethod, String requestUri) override
+    {
+      (void) server;
+
+      if (!canHandle(requestMethod, requestUri))
+        return false;
+
+      _fn();
+
+      return true;
+    }
+
+  private:
+
+    WebServer::THandlerFunction _fn;
+    WebServer::THandlerFunction _ufn;
+    std::unique_ptr<Uri>        _uri;
+    HTTPMethod                  _method;
+};
+
+class StaticRequestHandler : public RequestHandler
+{
+  public:
+
+    StaticRequestHandler(FS& fs, const char* path, const char* uri, const char* cacheHeader)
+    {
+      (void) fs;
+      (void) path;
+      (void) uri;
+      (void) cacheHeader;
+    }
+};
@@ -0,0 +1,12 @@
+/****************************************************************************************************************************
+  esp32-hal-log.h
+  Host stand-in of the ESP32 core logging, silent
+ *****************************************************************************************************************************/
+
+#pragma once
+
+#define log_v(...)    do {} while (0)
+#define log_d(...)    do {} while (0)
+#define log_i(...)    do {} while (0)
+#define log_w(...)    do {} while (0)
+#define log_e(...)    do {} while (0)
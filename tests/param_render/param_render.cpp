@@ -0,0 +1,192 @@
+/****************************************************************************************************************************
+  param_render.cpp
+  Host benchmark of the rendering of 50 custom parameters in the /wifi page, token tables vs String::replace()
+
+  New: the /wifi page served with the 50 parameters, less the same page without them, so the cost of the parameter
+  rows through pageAddTemplate(). The pages are served from inside startConfigPortal(), at its yield(), then /close
+  ends it. Old: the rows built as before the token tables, kept here as oldRender(), a String per row and six
+  String::replace() calls, appended to the page. Reports the host CPU time and the heap allocations per page, and
+  checks the page has the rows oldRender() makes, with {l} not truncated.
+
+  The String of the stand-ins is a std::string, the figures are of the host, not of the Arduino String
+ *****************************************************************************************************************************/
+
+#define _WIFIMGR_LOGLEVEL_    0
+
+#include <ESP_WiFiManager.h>
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <new>
+
+#define PARAMS                50
+#define RENDERS               2000
+
+static unsigned long allocations = 0;
+
+// Not inlined, else g++ sees free() on what operator new returned
+__attribute__((noinline)) void* operator new(size_t size)
+{
+  allocations++;
+
+  void* p = malloc(size ? size : 1);
+
+  if (!p)
+    throw std::bad_alloc();
+
+  return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+  free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept
+{
+  free(p);
+}
+
+static ESP_WMParameter* params[PARAMS];
+
+// The parameter rows of handleWifi() before the token tables. parLength[2] truncated {l} to one digit
+static void oldRender(String& page, const size_t& parLengthSize)
+{
+  char parLength[5];
+
+  for (int i = 0; i < PARAMS; i++)
+  {
+    String pitem;
+
+    switch (params[i]->getLabelPlacement())
+    {
+      case WFM_LABEL_BEFORE:
+        pitem = FPSTR(WM_HTTP_FORM_LABEL_BEFORE);
+        break;
+
+      case WFM_LABEL_AFTER:
+        pitem = FPSTR(WM_HTTP_FORM_LABEL_AFTER);
+        break;
+
+      default:
+        // WFM_NO_LABEL
+        pitem = FPSTR(WM_HTTP_FORM_PARAM);
+        break;
+    }
+
+    pitem.replace("{i}", params[i]->getID());
+    pitem.replace("{n}", params[i]->getID());
+    pitem.replace("{p}", params[i]->getPlaceholder());
+    snprintf(parLength, parLengthSize, "%d", params[i]->getValueLength());
+    pitem.replace("{l}", parLength);
+    pitem.replace("{v}", params[i]->getValue());
+    pitem.replace("{c}", params[i]->getCustomHTML());
+
+    page += pitem;
+  }
+}
+
+// The last /wifi page served
+static std::string page;
+
+// Host us and allocations per /wifi page, served by the portal of startConfigPortal()
+static std::pair<double, double> renderWifi(ESP_WiFiManager& wm)
+{
+  unsigned long calls   = 0;
+  double        us      = 0;
+  bool          served  = false;
+
+  mockOnYield = [&calls, &us, &served]()
+  {
+    ESP8266WebServer* server = ESP8266WebServer::instance;
+
+    // Once, with the portal up
+    if (served || !server)
+      return;
+
+    served  = true;
+    calls   = allocations;
+
+    for (int i = 0; i < RENDERS; i++)
+    {
+      server->out.clear();
+      server->request("/wifi");
+
+      auto start = std::chrono::steady_clock::now();
+
+      server->handleClient();
+
+      us += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() /
+            1000.0;
+    }
+
+    calls = allocations - calls;
+    page  = server->out;
+
+    server->request("/close");
+  };
+
+  wm.startConfigPortal("ParamRender");
+
+  mockOnYield = nullptr;
+
+  return std::make_pair(us / RENDERS, (double) calls / RENDERS);
+}
+
+int main()
+{
+  ESP_WiFiManager wm("ParamRender");
+
+  // No AP, the page is mostly the parameters
+  mockMakeAPs(0);
+
+  for (int i = 0; i < PARAMS; i++)
+  {
+    std::string id          = "param" + std::to_string(i);
+    std::string placeholder = "Parameter " + std::to_string(i);
+    std::string value       = "value " + std::to_string(i);
+
+    params[i] = new ESP_WMParameter(strdup(id.c_str()), strdup(placeholder.c_str()), value.c_str(), 40, "",
+                                    i % 3);
+  }
+
+  auto without = renderWifi(wm);
+
+  for (int i = 0; i < PARAMS; i++)
+  {
+    wm.addParameter(params[i]);
+  }
+
+  auto with = renderWifi(wm);
+
+  unsigned long calls = allocations;
+  auto          start = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < RENDERS; i++)
+  {
+    String page;
+
+    oldRender(page, 2);
+  }
+
+  double oldUs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() /
+                 1000.0 / RENDERS;
+  double oldAllocations = (double) (allocations - calls) / RENDERS;
+
+  std::cout << PARAMS << " parameters, " << RENDERS << " renders each" << std::fixed << std::setprecision(1)
+            << "\nold  " << std::setw(8) << oldUs << " us " << std::setw(7) << oldAllocations << " allocations"
+            << "\nnew  " << std::setw(8) << with.first - without.first << " us "
+            << std::setw(7) << std::max(0.0, with.second - without.second) << " allocations\n";
+
+  // Same rows, but for {l}
+  String expected;
+
+  oldRender(expected, 5);
+
+  bool pass = (page.find(expected.c_str()) != std::string::npos);
+
+  std::cout << (pass ? "PASS\n" : "FAIL: the page doesn't have the rows as oldRender() makes them\n");
+
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+/****************************************************************************************************************************
+  process_time.cpp
+  Host test of the non-blocking Config Portal: no process() call may take more than MAX_PROCESS_MS
+
+  Goes through a whole portal session on the virtual clock of the stand-ins: pages, background scans, credentials saved
+  without a password, a connection that times out, WPS, then the connection WPS gets. Any delay() or wait inside
+  process() shows as the clock moving during the call
+ *****************************************************************************************************************************/
+
+#define _WIFIMGR_LOGLEVEL_    0
+
+#include <ESP_WiFiManager.h>
+
+#include <chrono>
+#include <iostream>
+
+// Budget of one process() call, in ms of virtual time
+#ifndef MAX_PROCESS_MS
+  #define MAX_PROCESS_MS      10
+#endif
+
+// Session length limit, in ms of virtual time
+#define SESSION_MS            300000UL
+
+// WPS ends that long after it started
+#define WPS_MS                5000UL
+
+int main()
+{
+  ESP_WiFiManager wm("ProcessTime");
+
+  mockMakeAPs(40);
+
+  wm.setTryWPS(true);
+
+  if (!wm.startConfigPortalAsync("ProcessTime"))
+  {
+    std::cout << "FAIL: portal not started\n";
+
+    return 1;
+  }
+
+  ESP8266WebServer* server = ESP8266WebServer::instance;
+
+  unsigned long   start     = millis();
+  unsigned long   savedAt   = 0;
+  unsigned long   wpsAt     = 0;
+  unsigned long   maxMs     = 0;
+  long long       maxUs     = 0;
+  unsigned long   calls     = 0;
+  WM_PortalStatus status    = WM_PORTAL_RUNNING;
+
+  while ( (status == WM_PORTAL_RUNNING) || (status == WM_PORTAL_CONNECTING) )
+  {
+    unsigned long now = millis() - start;
+
+    if (now > SESSION_MS)
+      break;
+
+    // A browser going through the portal, then polling /status for the outcome
+    if (now == 100)
+      server->request("/");
+    else if (now == 200)
+      server->request("/wifi");
+    else if (now == 300)
+      server->request("/scan");
+    else if (now == 1000)
+      server->request("/wifisave", "s=net1&p=", HTTP_POST);
+    else if ( (now > 1000) && (now % 1000 == 0) )
+      server->request("/status");
+
+    if ( (status == WM_PORTAL_CONNECTING) && !savedAt )
+      savedAt = now;
+
+    // Pressing the WPS button of the router once the portal has started WPS
+    if ( savedAt && !wpsAt && (now > savedAt + WPS_MS) && mockWPSDone(WPS_CB_ST_SUCCESS) )
+      wpsAt = now;
+
+    unsigned long before    = millis();
+    auto          realStart = std::chrono::steady_clock::now();
+
+    status = wm.process();
+
+    long long us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                   realStart).count();
+
+    maxMs = std::max(maxMs, millis() - before);
+    maxUs = std::max(maxUs, us);
+    calls++;
+
+    mockAdvance(1);
+  }
+
+  std::cout << "process() calls " << calls << ", max " << maxMs << " ms (virtual), " << maxUs << " us (host)"
+            << ", status " << status << ", WPS at " << wpsAt << " ms\n";
+
+  bool pass = true;
+
+  if (maxMs > MAX_PROCESS_MS)
+  {
+    std::cout << "FAIL: a process() call took " << maxMs << " ms, more than " << MAX_PROCESS_MS << " ms\n";
+    pass = false;
+  }
+
+  if (!wpsAt)
+  {
+    std::cout << "FAIL: WPS not started by process()\n";
+    pass = false;
+  }
+
+  if (status != WM_PORTAL_CONNECTED)
+  {
+    std::cout << "FAIL: portal ended with " << status << ", not WM_PORTAL_CONNECTED\n";
+    pass = false;
+  }
+
+  std::cout << (pass ? "PASS\n" : "FAIL\n");
+
+  return pass ? 0 : 1;
+}
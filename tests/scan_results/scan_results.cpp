@@ -0,0 +1,180 @@
+/****************************************************************************************************************************
+  scan_results.cpp
+  Host benchmark of scanWifiNetworks() / collectScanResults() on synthetic scans of up to 200 APs
+
+  Compares the snapshot and std::sort with the exchange sort it replaced, kept here as oldScanWifiNetworks(): RSSI
+  read from the driver in the inner loop, SSIDs compared as Strings for the duplicates. Reports the host CPU time
+  and the WiFi.SSID() / RSSI() / ... driver calls per scan, and checks both keep the same APs
+ *****************************************************************************************************************************/
+
+#define _WIFIMGR_LOGLEVEL_    0
+
+#include <ESP_WiFiManager.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <utility>
+#include <vector>
+
+#define SCANS                 200
+
+typedef std::vector<std::pair<std::string, int>> APList;
+
+// The sort and filters of scanWifiNetworks(int**) before the snapshot, duplicates removed, no minimum quality
+static int oldScanWifiNetworks(int **indicesptr)
+{
+  int n = WiFi.scanNetworks(false, true);
+
+  if (n <= 0)
+    return (0);
+
+  int* indices = (int *) malloc(n * sizeof(int));
+
+  if (indices == NULL)
+    return (0);
+
+  *indicesptr = indices;
+
+  for (int i = 0; i < n; i++)
+  {
+    indices[i] = i;
+  }
+
+  // RSSI SORT
+  for (int i = 0; i < n; i++)
+  {
+    for (int j = i + 1; j < n; j++)
+    {
+      if (WiFi.RSSI(indices[j]) > WiFi.RSSI(indices[i]))
+      {
+        std::swap(indices[i], indices[j]);
+      }
+    }
+  }
+
+  // remove duplicates ( must be RSSI sorted )
+  String cssid;
+
+  for (int i = 0; i < n; i++)
+  {
+    if (indices[i] == -1)
+      continue;
+
+    cssid = WiFi.SSID(indices[i]);
+
+    for (int j = i + 1; j < n; j++)
+    {
+      if (cssid == WiFi.SSID(indices[j]))
+      {
+        indices[j] = -1;
+      }
+    }
+  }
+
+  return (n);
+}
+
+// The APs kept, as (SSID, RSSI), in an order independent of how equal RSSIs were sorted
+static APList oldAPs()
+{
+  int*    indices = NULL;
+  int     n       = oldScanWifiNetworks(&indices);
+  APList  aps;
+
+  for (int i = 0; i < n; i++)
+  {
+    if (indices[i] != -1)
+      aps.emplace_back(WiFi.SSID(indices[i]).c_str(), WiFi.RSSI(indices[i]));
+  }
+
+  free(indices);
+  std::sort(aps.begin(), aps.end());
+
+  return aps;
+}
+
+static APList newAPs(ESP_WiFiManager& wm)
+{
+  WM_ScanResult*  results = NULL;
+  int             n       = wm.scanWifiNetworks(&results);
+  APList          aps;
+
+  for (int i = 0; i < n; i++)
+  {
+    aps.emplace_back(results[i].ssid, results[i].rssi);
+  }
+
+  free(results);
+  std::sort(aps.begin(), aps.end());
+
+  return aps;
+}
+
+// Host us and driver calls per scan
+template<typename Scan>
+static std::pair<double, double> measure(Scan scan)
+{
+  unsigned long calls = WiFi.driverCalls;
+  auto          start = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < SCANS; i++)
+  {
+    scan();
+  }
+
+  double us = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() /
+              1000.0;
+
+  return std::make_pair(us / SCANS, (double) (WiFi.driverCalls - calls) / SCANS);
+}
+
+int main()
+{
+  ESP_WiFiManager wm("ScanResults");
+
+  bool pass = true;
+
+  std::cout << SCANS << " scans each\n";
+
+  for (int count : { 20, 50, 120, 200 })
+  {
+    mockMakeAPs(count);
+
+    APList expected = oldAPs();
+    APList actual   = newAPs(wm);
+
+    auto oldCost = measure([]()
+    {
+      int* indices = NULL;
+
+      oldScanWifiNetworks(&indices);
+      free(indices);
+    });
+
+    auto newCost = measure([&wm]()
+    {
+      WM_ScanResult* results = NULL;
+
+      wm.scanWifiNetworks(&results);
+      free(results);
+    });
+
+    std::cout << std::setw(4) << count << " APs, " << std::setw(3) << actual.size() << " kept" << std::fixed
+              << std::setprecision(1)
+              << "   old " << std::setw(8) << oldCost.first << " us " << std::setw(7) << oldCost.second << " calls"
+              << "   new " << std::setw(8) << newCost.first << " us " << std::setw(7) << newCost.second << " calls\n";
+
+    if (actual != expected)
+    {
+      std::cout << "FAIL: " << count << " APs, " << actual.size() << " kept instead of the same "
+                << expected.size() << " as before\n";
+      pass = false;
+    }
+  }
+
+  std::cout << (pass ? "PASS\n" : "FAIL\n");
+
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+/****************************************************************************************************************************
+  keep_alive.cpp
+  Host load test of the persistent connections of the patched ESP32 WebServer
+
+  One client loads what the Config Portal serves, the chunked page and then /state polls, one request after the
+  other, over a softAP with RTT_MS of round trip. With keep-alive the next request goes on the same connection, one
+  round trip after the response. Without, the client asks for Connection: close, as the server always answered
+  before, and each request pays the TCP handshake on a new connection first.
+
+  Reports the requests per second on that (virtual) clock, the connections it took and the host CPU time per
+  request spent in handleClient()
+ *****************************************************************************************************************************/
+
+#include "WebServer.h"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+#define REQUESTS          1000
+
+// A /state poll per page load, as the portal does while connecting
+#define POLLS_PER_PAGE    4
+
+static const char PAGE_FRAGMENT[] PROGMEM = "<div><input type='checkbox' name='x' value='1'>";
+
+static WebServer server(80);
+
+static void handlePage()
+{
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/html", "");
+
+  for (int i = 0; i < 30; i++)
+  {
+    server.sendContent_P(PAGE_FRAGMENT, sizeof(PAGE_FRAGMENT) - 1);
+    server.sendContent(String("net") + String(i));
+  }
+}
+
+static void handleState()
+{
+  server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
+  server.send(200, "application/json", "{\"Result\":3}");
+}
+
+static void run(const bool& keepAlive, const unsigned long& rttMs)
+{
+  std::shared_ptr<MockSocket> socket;
+
+  int     connections = 0;
+  double  cpuUs       = 0;
+
+  unsigned long start = millis();
+
+  for (int i = 0; i < REQUESTS; i++)
+  {
+    std::string request = std::string("GET ") + ((i % (POLLS_PER_PAGE + 1)) ? "/state" : "/") +
+                          " HTTP/1.1\r\nHost: 192.168.4.1\r\n" + (keepAlive ? "" : "Connection: close\r\n") + "\r\n";
+
+    if (socket && socket->serverOpen)
+    {
+      // The response took half a round trip to the client, the next request another half back
+      socket->send(request, rttMs);
+    }
+    else
+    {
+      // Then SYN, SYN-ACK, and the ACK with the request: one and a half round trips more
+      socket = mockConnect(request, 2 * rttMs);
+      connections++;
+    }
+
+    while (!socket->responses())
+    {
+      auto t = std::chrono::steady_clock::now();
+
+      server.handleClient();
+
+      cpuUs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t).count() /
+               1000.0;
+
+      if (!socket->responses())
+        delay(1);
+    }
+
+    socket->tx.clear();
+  }
+
+  // And the last response back to the client
+  double seconds = (millis() - start + rttMs / 2) / 1000.0;
+
+  std::cout << std::left << std::setw(14) << (keepAlive ? "keep-alive" : "close") << std::right << std::fixed
+            << std::setprecision(1)
+            << "RTT " << std::setw(3) << rttMs << " ms"
+            << std::setw(10) << REQUESTS / seconds << " requests/s"
+            << std::setw(6)  << connections << " connections"
+            << std::setw(8)  << cpuUs / REQUESTS << " us CPU/request\n";
+}
+
+int main()
+{
+  server.on("/", handlePage);
+  server.on("/state", handleState);
+  server.begin();
+
+  std::cout << REQUESTS << " requests, a page then " << POLLS_PER_PAGE << " /state polls, one after the other, "
+            << "HTTP_KEEPALIVE_MAX " << HTTP_KEEPALIVE_MAX << "\n";
+
+  for (unsigned long rttMs : { 2, 10, 30 })
+  {
+    run(false, rttMs);
+    run(true, rttMs);
+  }
+
+  return 0;
+}
@@ -0,0 +1,152 @@
+/****************************************************************************************************************************
+  send_allocs.cpp
+  Host benchmark of the heap allocations of a response of the patched ESP32 WebServer, _prepareHeader() / send()
+
+  A 600-byte page with the four headers of the Config Portal: the no-store trio and the CORS header. Sent once with
+  four sendHeader() calls, once with the trio as the pre-serialized set of sendHeaders_P() and sendHeader() for the
+  CORS one only. Reports the operator new calls per response, from the handler on, so request parsing left out, and
+  the socket writes per response.
+
+  Fails if the header set doesn't save allocations, or a response takes more than one write
+ *****************************************************************************************************************************/
+
+#include "WebServer.h"
+
+#include <iostream>
+#include <iomanip>
+#include <new>
+
+#define RESPONSES         1000
+
+#define PAGE_SIZE         600
+
+// As WM_HTTP_HEADERS_NO_STORE of ESP_WiFiManager.hpp
+static const char HEADERS_NO_STORE[] PROGMEM =
+  "Cache-Control: no-cache, no-store, must-revalidate\r\nPragma: no-cache\r\nExpires: -1\r\n";
+
+static unsigned long  allocations = 0;
+static bool           counting    = false;
+
+// Not inlined, else g++ sees free() on what operator new returned
+__attribute__((noinline)) void* operator new(size_t size)
+{
+  if (counting)
+    allocations++;
+
+  void* p = malloc(size ? size : 1);
+
+  if (!p)
+    throw std::bad_alloc();
+
+  return p;
+}
+
+__attribute__((noinline)) void* operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+  free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept
+{
+  free(p);
+}
+
+__attribute__((noinline)) void operator delete[](void* p) noexcept
+{
+  free(p);
+}
+
+__attribute__((noinline)) void operator delete[](void* p, size_t) noexcept
+{
+  free(p);
+}
+
+static WebServer  server(80);
+static String     page;
+
+static void handleHeaders()
+{
+  counting = true;
+
+  server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
+  server.sendHeader("Pragma", "no-cache");
+  server.sendHeader("Expires", "-1");
+  server.sendHeader("Access-Control-Allow-Origin", "*");
+  server.send(200, "text/html", page);
+}
+
+static void handleHeaderSet()
+{
+  counting = true;
+
+  server.sendHeaders_P(HEADERS_NO_STORE);
+  server.sendHeader("Access-Control-Allow-Origin", "*");
+  server.send(200, "text/html", page);
+}
+
+// Allocations and socket writes per response
+static std::pair<double, double> run(const char* uri)
+{
+  std::shared_ptr<MockSocket> socket = mockConnect("");
+
+  socket->keepTx = false;
+
+  // Let the server accept it
+  server.handleClient();
+
+  std::string   request = std::string("GET ") + uri + " HTTP/1.1\r\nHost: 192.168.4.1\r\n\r\n";
+  unsigned long calls   = allocations;
+  size_t        writes  = 0;
+
+  for (int i = 0; i < RESPONSES; i++)
+  {
+    socket->send(request);
+
+    server.handleClient();
+    counting = false;
+
+    // Past the keep-alive limit, the server closes. Next connection
+    if (!socket->serverOpen)
+    {
+      writes += socket->txWrites;
+      socket  = mockConnect("");
+
+      socket->keepTx = false;
+      server.handleClient();
+    }
+  }
+
+  writes += socket->txWrites;
+
+  return std::make_pair((double) (allocations - calls) / RESPONSES, (double) writes / RESPONSES);
+}
+
+int main()
+{
+  page = String(std::string(PAGE_SIZE, 'x'));
+
+  server.on("/headers", handleHeaders);
+  server.on("/set", handleHeaderSet);
+  server.begin();
+
+  auto headers    = run("/headers");
+  auto headerSet  = run("/set");
+
+  std::cout << PAGE_SIZE << "-byte page, 4 headers, " << RESPONSES << " responses each" << std::fixed
+            << std::setprecision(1)
+            << "\n4 sendHeader()                " << std::setw(6) << headers.first << " allocations "
+            << std::setw(5) << headers.second << " writes"
+            << "\nsendHeaders_P() + sendHeader() " << std::setw(5) << headerSet.first << " allocations "
+            << std::setw(5) << headerSet.second << " writes\n";
+
+  bool pass = (headerSet.first < headers.first) && (headers.second == 1) && (headerSet.second == 1);
+
+  std::cout << (pass ? "PASS\n" : "FAIL\n");
+
+  return pass ? 0 : 1;
+}
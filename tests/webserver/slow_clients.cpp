@@ -0,0 +1,141 @@
+/****************************************************************************************************************************
+  slow_clients.cpp
+  Host benchmark of the client slots of the patched ESP32 WebServer, _acceptClients() / _freeSlot()
+
+  N slow clients, as a phone's captive-portal probe, each open a connection and send their request only SLOW_MS later,
+  then do it again. T trickling clients send theirs a byte every TRICKLE_MS. Next to them a fast client polls /state
+  on a new connection every FAST_INTERVAL_MS. Reports the p50, p99 and max latency of the fast client, from its
+  connection to the response, on the (virtual) clock.
+
+  Fails if the p99 is over P99_MAX_MS while the trickling clients leave a slot free: silent clients must give way to
+  the fast one, and a partial header must not hold up the other slots.
+
+  Built a second time with HTTP_MAX_CLIENTS 1
+ *****************************************************************************************************************************/
+
+#include "WebServer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+#define DURATION_MS       120000L
+#define SLOW_MS           3000
+#define TRICKLE_MS        40
+#define FAST_INTERVAL_MS  100
+#define P99_MAX_MS        20
+
+static WebServer server(80);
+
+static void handleState()
+{
+  server.send(200, "application/json", "{\"Result\":3}");
+}
+
+static const std::string request = "GET /state HTTP/1.1\r\nHost: 192.168.4.1\r\nConnection: close\r\n\r\n";
+
+// True if the p99 is within P99_MAX_MS, or not bound to be
+static bool run(const int& slowClients, const int& tricklingClients)
+{
+  int clients = slowClients + tricklingClients;
+
+  std::vector<std::shared_ptr<MockSocket>> slow(clients);
+  std::vector<unsigned long>               latencies;
+
+  std::shared_ptr<MockSocket> fast;
+
+  unsigned long start     = millis();
+  unsigned long fastStart = start;
+  unsigned long fastNext  = start;
+
+  while (millis() - start < DURATION_MS)
+  {
+    for (int i = 0; i < clients; i++)
+    {
+      // Staggered over SLOW_MS, each again as soon as served or dropped
+      if ( (!slow[i] && (millis() - start >= (unsigned long) i * SLOW_MS / clients)) ||
+           (slow[i] && (slow[i]->responses() || !slow[i]->serverOpen)) )
+      {
+        if (i < slowClients)
+          slow[i] = mockConnect(request, 0, SLOW_MS);
+        else
+          slow[i] = mockConnect(request, 0, 0, TRICKLE_MS);
+      }
+    }
+
+    if (fast && (fast->responses() || !fast->serverOpen))
+    {
+      latencies.push_back(millis() - fastStart);
+      fast.reset();
+      fastNext = millis() + FAST_INTERVAL_MS;
+    }
+
+    if (!fast && (millis() >= fastNext))
+    {
+      fast      = mockConnect(request);
+      fastStart = millis();
+    }
+
+    server.handleClient();
+    delay(1);
+  }
+
+  // Still waiting at the end
+  if (fast)
+    latencies.push_back(millis() - fastStart);
+
+  std::sort(latencies.begin(), latencies.end());
+
+  auto percentile = [&latencies](const double & p)
+  {
+    return latencies[std::min(latencies.size() - 1, (size_t) (p * latencies.size()))];
+  };
+
+  bool bound = (tricklingClients < HTTP_MAX_CLIENTS);
+  bool pass  = !bound || (percentile(0.99) <= P99_MAX_MS);
+
+  std::cout << std::setw(3) << slowClients << " slow" << std::setw(3) << tricklingClients << " trickling"
+            << std::setw(6) << latencies.size() << " fast requests"
+            << "   p50 " << std::setw(5) << percentile(0.50) << " ms"
+            << "   p99 " << std::setw(5) << percentile(0.99) << " ms"
+            << "   max " << std::setw(5) << latencies.back() << " ms"
+            << (bound ? (pass ? "" : "   FAIL") : "   (no free slot)") << "\n";
+
+  // Let the slow ones go before the next run
+  for (auto& socket : slow)
+    socket->clientOpen = false;
+
+  for (int i = 0; i <= SLOW_MS; i++)
+  {
+    server.handleClient();
+    delay(1);
+  }
+
+  return pass;
+}
+
+int main()
+{
+  server.on("/state", handleState);
+  server.enableDelay(false);
+  server.begin();
+
+  std::cout << "HTTP_MAX_CLIENTS " << HTTP_MAX_CLIENTS << ", slow clients send " << SLOW_MS << " ms after connecting, "
+            << "trickling ones a byte every " << TRICKLE_MS << " ms, fast client every " << FAST_INTERVAL_MS << " ms, "
+            << DURATION_MS / 1000 << " s each\n";
+
+  bool pass = true;
+
+  for (int slowClients : { 0, 1, 4, 8 })
+  {
+    for (int tricklingClients : { 0, 1, 3 })
+    {
+      pass = run(slowClients, tricklingClients) && pass;
+    }
+  }
+
+  std::cout << (pass ? "PASS\n" : "FAIL\n");
+
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+/****************************************************************************************************************************
+  tx_throughput.cpp
+  Host benchmark of the response path of the patched ESP32 WebServer, _txWrite() / _txFlush()
+
+  Serves three kinds of responses over the socket stand-in: a small one with a few headers, a chunked page sent as
+  many small fragments as the Config Portal does, and an 8 KB body. Reports the socket writes and TCP segments per
+  response, the host CPU time per response, and the throughput on a link model where each segment costs SEGMENT_US
+  of airtime on top of its bytes at LINK_MBPS.
+
+  Built a second time with HTTP_TX_BUF_SIZE 1, which writes each piece as it comes, as before the send buffer
+ *****************************************************************************************************************************/
+
+#include "WebServer.h"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+#define RESPONSES         2000
+
+// Link model
+#ifndef SEGMENT_US
+  #define SEGMENT_US      200
+#endif
+
+#ifndef LINK_MBPS
+  #define LINK_MBPS       20
+#endif
+
+static const char PAGE_FRAGMENT[] PROGMEM = "<div><input type='checkbox' name='x' value='1'>";
+static const char LARGE_BODY_CHAR = 'x';
+
+static WebServer server(80);
+static std::string largeBody(8192, LARGE_BODY_CHAR);
+
+static void handleSmall()
+{
+  server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
+  server.sendHeader("Pragma", "no-cache");
+  server.sendHeader("Expires", "-1");
+  server.send(200, "application/json", "{\"Result\":3}");
+}
+
+// 60 fragments of 6 to 48 bytes, template text and substituted values alternating
+static void handleChunked()
+{
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/html", "");
+
+  for (int i = 0; i < 30; i++)
+  {
+    server.sendContent_P(PAGE_FRAGMENT, sizeof(PAGE_FRAGMENT) - 1);
+    server.sendContent(String("net") + String(i));
+  }
+}
+
+static void handleLarge()
+{
+  server.send_P(200, "text/plain", largeBody.c_str(), largeBody.size());
+}
+
+static void run(const char* name, const char* uri)
+{
+  std::shared_ptr<MockSocket> socket = mockConnect("");
+
+  socket->keepTx = false;
+
+  // Let the server accept it
+  server.handleClient();
+
+  std::string request = std::string("GET ") + uri + " HTTP/1.1\r\nHost: 192.168.4.1\r\n\r\n";
+
+  double cpuUs = 0;
+
+  for (int i = 0; i < RESPONSES; i++)
+  {
+    socket->send(request);
+
+    auto start = std::chrono::steady_clock::now();
+
+    server.handleClient();
+
+    cpuUs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() /
+             1000.0;
+
+    // Past the keep-alive limit, the server closes. Next connection
+    if (!socket->serverOpen)
+    {
+      std::shared_ptr<MockSocket> next = mockConnect("");
+
+      next->keepTx      = false;
+      next->txBytes     = socket->txBytes;
+      next->txWrites    = socket->txWrites;
+      next->txSegments  = socket->txSegments;
+      socket            = next;
+
+      server.handleClient();
+    }
+  }
+
+  double linkUs     = socket->txSegments * (double) SEGMENT_US + socket->txBytes * 8.0 / LINK_MBPS;
+
+  std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(8)  << (double) socket->txBytes / RESPONSES << " B"
+            << std::setw(8)  << (double) socket->txWrites / RESPONSES << " writes"
+            << std::setw(8)  << (double) socket->txSegments / RESPONSES << " segments"
+            << std::setw(8)  << cpuUs / RESPONSES << " us CPU"
+            << std::setw(10) << socket->txBytes / linkUs * 1000 << " KB/s on the link model\n";
+}
+
+int main()
+{
+  server.on("/small", handleSmall);
+  server.on("/chunked", handleChunked);
+  server.on("/large", handleLarge);
+  server.begin();
+
+  std::cout << "HTTP_TX_BUF_SIZE " << HTTP_TX_BUF_SIZE << ", " << RESPONSES << " responses each, link model "
+            << SEGMENT_US << " us/segment + " << LINK_MBPS << " Mbit/s\n";
+
+  run("small", "/small");
+  run("chunked", "/chunked");
+  run("large", "/large");
+
+  return 0;
+}
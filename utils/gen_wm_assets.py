@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+#
+# Regenerates src/utils/WM_Assets.h from the sources in utils/wm_assets
+#
+# Run from the library root after editing any of the asset sources:
+#   python3 utils/gen_wm_assets.py
+#
+# The gzip header carries mtime = 0 so the output, and therefore the ETag, only changes with the content.
+
+import gzip
+import os
+
+ROOT    = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SRC_DIR = os.path.join(ROOT, "utils", "wm_assets")
+OUT     = os.path.join(ROOT, "src", "utils", "WM_Assets.h")
+
+# (C name, source files concatenated in order)
+ASSETS = [
+  ("WM_ASSET_CSS",      ["wm.css"]),
+  ("WM_ASSET_JS",       ["wm.js"]),
+  ("WM_ASSET_JS_NTP",   ["wm.js", "jstz.js"]),
+]
+
+
+def fnv1a32(data):
+  h = 0x811c9dc5
+
+  for b in data:
+    h = ((h ^ b) * 0x01000193) & 0xffffffff
+
+  return h
+
+
+def emit(name, files):
+  raw = b"".join(open(os.path.join(SRC_DIR, f), "rb").read() for f in files)
+  gz  = gzip.compress(raw, compresslevel=9, mtime=0)
+
+  lines = []
+  lines.append("// %s : %d bytes, %d gzipped" % (" + ".join(files), len(raw), len(gz)))
+  lines.append("#define %s_VER \"%08x\"" % (name, fnv1a32(gz)))
+  lines.append("const char %s_ETAG[] PROGMEM = \"\\\"\" %s_VER \"\\\"\";" % (name, name))
+  lines.append("const size_t %s_GZ_LEN = %d;" % (name, len(gz)))
+  lines.append("const uint8_t %s_GZ[] PROGMEM =" % name)
+  lines.append("{")
+
+  for i in range(0, len(gz), 16):
+    lines.append("  " + ", ".join("0x%02x" % b for b in gz[i:i + 16]) + ",")
+
+  lines.append("};")
+
+  return "\n".join(lines)
+
+
+def main():
+  body = "\n\n".join(emit(name, files) for name, files in ASSETS)
+
+  with open(OUT, "w") as f:
+    f.write("// autogenerated from utils/wm_assets by utils/gen_wm_assets.py, do not edit\n\n")
+    f.write("#ifndef WM_ASSETS_H\n#define WM_ASSETS_H\n\n")
+    f.write(body)
+    f.write("\n\n#endif    // WM_ASSETS_H\n")
+
+
+if __name__ == "__main__":
+  main()
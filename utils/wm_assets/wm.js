@@ -0,0 +1,2 @@
+function c(l){document.getElementById('s').value=l.innerText||l.textContent;document.getElementById('p').focus();document.getElementById('s1').value=l.innerText||l.textContent;document.getElementById('p1').focus();document.getElementById('timezone').value=timezone.name();}
+function st(){var x=new XMLHttpRequest(),e=document.getElementById('st');x.onload=function(){var r=JSON.parse(x.responseText);e.innerHTML=r.State+(r.State=='Connected'?' : '+r.IP:r.State=='Failed'?' : '+r.Result:'');if(r.State=='Waiting'||r.State=='Connecting')setTimeout(st,1000);};x.onerror=function(){setTimeout(st,2000);};x.open('GET','/status');x.send();}